@@ -0,0 +1,947 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendEvdev.h"
+
+#if PLATFORM_LINUX
+
+#include "JoystickFunctionLibrary.h"
+#include "JoystickLogManager.h"
+#include "Data/JoystickLatencyHistogram.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+
+THIRD_PARTY_INCLUDES_START
+
+#include "SDL_joystick.h"
+#include "SDL_version.h"
+
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	constexpr int ReadBatchSize = 64;
+	constexpr int MaxEpollEvents = 16;
+	constexpr int MaxHats = 4;
+	constexpr int MaxGuidNameLength = 11;
+
+	const char* InputDirectory = "/dev/input";
+
+	bool TestBit(const uint8* Bits, const int Bit)
+	{
+		return (Bits[Bit / 8] & (1 << (Bit % 8))) != 0;
+	}
+
+	bool IsHatCode(const int Code)
+	{
+		return Code >= ABS_HAT0X && Code <= ABS_HAT3Y;
+	}
+
+	/* SDL_crc16, which SDL folds the device name into the GUID with */
+	uint16 Crc16(uint16 Crc, const uint8* Data, const int Length)
+	{
+		for (int i = 0; i < Length; i++)
+		{
+			uint8 Byte = static_cast<uint8>(Crc) ^ Data[i];
+			uint16 ByteCrc = 0;
+			for (int Bit = 0; Bit < 8; Bit++)
+			{
+				ByteCrc = (((ByteCrc ^ Byte) & 1) != 0 ? 0xA001 : 0) ^ ByteCrc >> 1;
+				Byte >>= 1;
+			}
+
+			Crc = ByteCrc ^ Crc >> 8;
+		}
+
+		return Crc;
+	}
+}
+
+FJoystickBackendEvdev::FJoystickBackendEvdev()
+	: Listener(nullptr)
+	  , EpollFd(-1)
+	  , InotifyFd(-1)
+	  , NextInstanceId(0)
+	  , EventSourceTimestamp(0.0)
+	  , LastBoundDeviceId(-1)
+{
+	ReadBuffer.SetNumUninitialized(ReadBatchSize * sizeof(input_event));
+}
+
+FJoystickBackendEvdev::~FJoystickBackendEvdev()
+{
+	for (FEvdevDevice& Device : Devices)
+	{
+		CloseDescriptor(Device);
+	}
+
+	if (InotifyFd >= 0)
+	{
+		close(InotifyFd);
+	}
+
+	if (EpollFd >= 0)
+	{
+		close(EpollFd);
+	}
+}
+
+int FJoystickBackendEvdev::AttachDescriptor(const int Fd, const FJoystickEvdevDeviceDescription& Description)
+{
+	if (Listener == nullptr)
+	{
+		close(Fd);
+		return -1;
+	}
+
+	const int Flags = fcntl(Fd, F_GETFL);
+	if (Flags < 0 || fcntl(Fd, F_SETFL, Flags | O_NONBLOCK) < 0)
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Unable to make descriptor %d non-blocking: %s"), Fd, UTF8_TO_TCHAR(strerror(errno)));
+		close(Fd);
+		return -1;
+	}
+
+	FEvdevDevice Device;
+	Device.Fd = Fd;
+	Device.Path = FString::Printf(TEXT("fd:%d"), Fd);
+	Device.Description = Description;
+
+	LastBoundDeviceId = -1;
+	Listener->OnDeviceAttached(*this, AddDevice(MoveTemp(Device)));
+	return LastBoundDeviceId;
+}
+
+FGuid FJoystickBackendEvdev::CreateGuid(const FJoystickEvdevDeviceDescription& Description)
+{
+	// Same layout as SDL_CreateJoystickGUID: little-endian words of bus, name CRC, vendor, product and version
+	uint8 Data[16] = {};
+	const auto WriteWord = [&Data](const int Word, const uint16 Value)
+	{
+		Data[Word * 2] = static_cast<uint8>(Value & 0xFF);
+		Data[Word * 2 + 1] = static_cast<uint8>(Value >> 8);
+	};
+
+	const FTCHARToUTF8 Name(*Description.Name.TrimStartAndEnd());
+
+	WriteWord(0, Description.BusType);
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+	WriteWord(1, Crc16(0, reinterpret_cast<const uint8*>(Name.Get()), Name.Length()));
+#endif
+
+	if (Description.Vendor != 0 && Description.Product != 0)
+	{
+		WriteWord(2, Description.Vendor);
+		WriteWord(4, Description.Product);
+		WriteWord(6, Description.Version);
+	}
+	else
+	{
+		// Without ids SDL stores as much of the name as fits
+		FMemory::Memcpy(Data + 4, Name.Get(), FMath::Min(Name.Length(), MaxGuidNameLength));
+	}
+
+	FGuid Guid;
+	FMemory::Memcpy(&Guid, Data, sizeof(FGuid));
+	return Guid;
+}
+
+FName FJoystickBackendEvdev::GetName() const
+{
+	return TEXT("Evdev");
+}
+
+bool FJoystickBackendEvdev::Initialise(IJoystickBackendListener& InListener)
+{
+	Listener = &InListener;
+
+	EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (EpollFd < 0)
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Unable to create the evdev epoll set: %s"), UTF8_TO_TCHAR(strerror(errno)));
+		return false;
+	}
+
+	return true;
+}
+
+void FJoystickBackendEvdev::Shutdown()
+{
+	TArray<int> DeviceIds;
+	{
+		FScopeLock Lock(&DevicesLock);
+		for (FEvdevDevice& Device : Devices)
+		{
+			// Closing a device that has ended removes it rather than keeping it around for re-binding
+			Device.IsEndOfStream = true;
+			if (Device.DeviceId != -1)
+			{
+				DeviceIds.Add(Device.DeviceId);
+			}
+		}
+	}
+
+	for (const int DeviceId : DeviceIds)
+	{
+		Listener->OnDeviceDetached(*this, DeviceId);
+	}
+
+	FScopeLock Lock(&DevicesLock);
+	for (FEvdevDevice& Device : Devices)
+	{
+		CloseDescriptor(Device);
+	}
+
+	Devices.Empty();
+
+	if (InotifyFd >= 0)
+	{
+		close(InotifyFd);
+		InotifyFd = -1;
+	}
+
+	if (EpollFd >= 0)
+	{
+		close(EpollFd);
+		EpollFd = -1;
+	}
+
+	Listener = nullptr;
+}
+
+void FJoystickBackendEvdev::EnumerateDevices()
+{
+	DIR* Directory = opendir(InputDirectory);
+	if (Directory == nullptr)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Unable to open %s: %s"), UTF8_TO_TCHAR(InputDirectory), UTF8_TO_TCHAR(strerror(errno)));
+		return;
+	}
+
+	TArray<FString> Paths;
+	while (const dirent* Entry = readdir(Directory))
+	{
+		if (FCStringAnsi::Strncmp(Entry->d_name, "event", 5) == 0)
+		{
+			Paths.Add(FString::Printf(TEXT("%s/%s"), UTF8_TO_TCHAR(InputDirectory), UTF8_TO_TCHAR(Entry->d_name)));
+		}
+	}
+
+	closedir(Directory);
+
+	// Keep the kernel's order so device ids are stable between runs
+	Paths.Sort([](const FString& A, const FString& B)
+	{
+		return A.Len() != B.Len() ? A.Len() < B.Len() : A < B;
+	});
+
+	for (const FString& Path : Paths)
+	{
+		FEvdevDevice Device;
+		if (!IsOpen(Path) && ProbeDevice(Path, Device))
+		{
+			Listener->OnDeviceAttached(*this, AddDevice(MoveTemp(Device)));
+		}
+	}
+
+	// Only start watching now, the devices that were already attached have been added above
+	if (InotifyFd < 0)
+	{
+		InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (InotifyFd >= 0 && inotify_add_watch(InotifyFd, InputDirectory, IN_CREATE | IN_ATTRIB | IN_DELETE) < 0)
+		{
+			FJoystickLogManager::Get()->LogWarning(TEXT("Unable to watch %s, devices will not be hot-plugged: %s"), UTF8_TO_TCHAR(InputDirectory), UTF8_TO_TCHAR(strerror(errno)));
+		}
+	}
+}
+
+int FJoystickBackendEvdev::GetDeviceCount() const
+{
+	FScopeLock Lock(&DevicesLock);
+	return Devices.Num();
+}
+
+bool FJoystickBackendEvdev::IsGamepad(const int DeviceIndex) const
+{
+	FScopeLock Lock(&DevicesLock);
+	return Devices.IsValidIndex(DeviceIndex) && Devices[DeviceIndex].Description.IsGamepad;
+}
+
+bool FJoystickBackendEvdev::OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device)
+{
+	FScopeLock Lock(&DevicesLock);
+	if (!Devices.IsValidIndex(DeviceIndex))
+	{
+		return false;
+	}
+
+	const FEvdevDevice& EvdevDevice = Devices[DeviceIndex];
+	if (EvdevDevice.IsEndOfStream)
+	{
+		return false;
+	}
+
+	Device.DeviceIndex = DeviceIndex;
+	Device.InstanceId = EvdevDevice.InstanceId;
+	Device.IsGamepad = EvdevDevice.Description.IsGamepad;
+	Device.HasRumble = false;
+	Device.DeviceName = EvdevDevice.Description.Name;
+	Device.ProductId = EvdevDevice.Guid;
+	Device.AxisCount = EvdevDevice.Description.Axes.Num();
+	Device.ButtonCount = EvdevDevice.Description.Buttons.Num();
+	Device.HatCount = EvdevDevice.Description.HatCount;
+	Device.BallCount = EvdevDevice.Description.BallCount;
+
+	FJoystickLogManager::Get()->LogDebug(TEXT("%s:"), *Device.DeviceName);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tPath: %s"), *EvdevDevice.Path);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Axis %i"), Device.AxisCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Balls %i"), Device.BallCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Buttons %i"), Device.ButtonCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Hats %i"), Device.HatCount);
+	return true;
+}
+
+void FJoystickBackendEvdev::BindDevice(const FDeviceInfoSDL& Device)
+{
+	FScopeLock Lock(&DevicesLock);
+
+	const int DeviceIndex = FindDeviceIndexByInstanceId(Device.InstanceId);
+	if (DeviceIndex == -1)
+	{
+		return;
+	}
+
+	FEvdevDevice& EvdevDevice = Devices[DeviceIndex];
+	EvdevDevice.DeviceId = Device.DeviceId;
+	LastBoundDeviceId = Device.DeviceId;
+
+	epoll_event Event = {};
+	Event.events = EPOLLIN;
+	Event.data.fd = EvdevDevice.Fd;
+	if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, EvdevDevice.Fd, &Event) < 0)
+	{
+		if (errno != EPERM)
+		{
+			FJoystickLogManager::Get()->LogWarning(TEXT("Unable to add %s to the epoll set, it will be polled: %s"), *EvdevDevice.Path, UTF8_TO_TCHAR(strerror(errno)));
+		}
+
+		EvdevDevice.IsPolled = true;
+	}
+
+	// Anything queued while the device was unbound is stale
+	Resynchronise(EvdevDevice);
+}
+
+void FJoystickBackendEvdev::CloseDevice(const FDeviceInfoSDL& Device)
+{
+	FScopeLock Lock(&DevicesLock);
+
+	const int DeviceIndex = FindDeviceIndexByInstanceId(Device.InstanceId);
+	if (DeviceIndex == -1)
+	{
+		return;
+	}
+
+	FEvdevDevice& EvdevDevice = Devices[DeviceIndex];
+	if (!EvdevDevice.IsPolled)
+	{
+		epoll_ctl(EpollFd, EPOLL_CTL_DEL, EvdevDevice.Fd, nullptr);
+	}
+
+	EvdevDevice.DeviceId = -1;
+	EvdevDevice.IsPolled = false;
+
+	// Devices that are still attached stay open so they can be bound again, e.g. when game controllers stop being ignored
+	if (EvdevDevice.IsEndOfStream)
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("Closing %s for %d"), *EvdevDevice.Path, Device.DeviceId);
+		CloseDescriptor(EvdevDevice);
+		Devices.RemoveAt(DeviceIndex);
+	}
+}
+
+void FJoystickBackendEvdev::Update(const bool PollInput)
+{
+	ProcessHotplug();
+
+	if (PollInput)
+	{
+		FJoystickBackendEvdev::PollInput();
+	}
+
+	ProcessDeviceEvents();
+}
+
+void FJoystickBackendEvdev::PollInput()
+{
+	FScopeLock Lock(&DevicesLock);
+
+	if (EpollFd >= 0)
+	{
+		// Level triggered, anything beyond this batch is picked up on the next poll
+		epoll_event Events[MaxEpollEvents];
+		const int EventCount = epoll_wait(EpollFd, Events, MaxEpollEvents, 0);
+		for (int i = 0; i < EventCount; i++)
+		{
+			if (FEvdevDevice* Device = FindDeviceByFd(Events[i].data.fd))
+			{
+				ReadDevice(*Device);
+			}
+		}
+	}
+
+	for (FEvdevDevice& Device : Devices)
+	{
+		if (Device.IsPolled && Device.DeviceId != -1)
+		{
+			ReadDevice(Device);
+		}
+	}
+}
+
+bool FJoystickBackendEvdev::WaitForInput(const double Timeout)
+{
+	if (EpollFd < 0)
+	{
+		return false;
+	}
+
+	{
+		FScopeLock Lock(&DevicesLock);
+		if (Devices.ContainsByPredicate([](const FEvdevDevice& Device) { return Device.IsPolled; }))
+		{
+			return false;
+		}
+	}
+
+	// Leaves the events pending, PollInput reads them straight after
+	epoll_event Event;
+	epoll_wait(EpollFd, &Event, 1, FMath::CeilToInt(Timeout * 1000.0));
+	return true;
+}
+
+bool FJoystickBackendEvdev::ProbeDevice(const FString& Path, FEvdevDevice& Device) const
+{
+	const int Fd = open(TCHAR_TO_UTF8(*Path), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+	if (Fd < 0)
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("Unable to open %s: %s"), *Path, UTF8_TO_TCHAR(strerror(errno)));
+		return false;
+	}
+
+	uint8 EventBits[(EV_MAX + 8) / 8] = {};
+	uint8 KeyBits[(KEY_MAX + 8) / 8] = {};
+	uint8 AbsBits[(ABS_MAX + 8) / 8] = {};
+	uint8 RelBits[(REL_MAX + 8) / 8] = {};
+	uint8 PropBits[(INPUT_PROP_MAX + 8) / 8] = {};
+	if (ioctl(Fd, EVIOCGBIT(0, sizeof(EventBits)), EventBits) < 0 ||
+		ioctl(Fd, EVIOCGBIT(EV_KEY, sizeof(KeyBits)), KeyBits) < 0 ||
+		ioctl(Fd, EVIOCGBIT(EV_ABS, sizeof(AbsBits)), AbsBits) < 0 ||
+		ioctl(Fd, EVIOCGBIT(EV_REL, sizeof(RelBits)), RelBits) < 0)
+	{
+		close(Fd);
+		return false;
+	}
+
+	ioctl(Fd, EVIOCGPROP(sizeof(PropBits)), PropBits);
+
+	// Event times default to the realtime clock, which can jump
+	int ClockId = CLOCK_MONOTONIC;
+	ioctl(Fd, EVIOCSCLOCKID, &ClockId);
+
+	// Close to SDL's device class guess: absolute axes or joystick buttons, but not a touchpad or a motion sensor
+	bool HasJoystickButtons = false;
+	for (int Code = BTN_JOYSTICK; Code < BTN_DIGI && !HasJoystickButtons; Code++)
+	{
+		HasJoystickButtons = TestBit(KeyBits, Code);
+	}
+
+	for (int Code = BTN_TRIGGER_HAPPY; Code <= BTN_TRIGGER_HAPPY40 && !HasJoystickButtons; Code++)
+	{
+		HasJoystickButtons = TestBit(KeyBits, Code);
+	}
+
+	bool HasAxes = false;
+	for (int Code = 0; Code < ABS_MISC && !HasAxes; Code++)
+	{
+		HasAxes = TestBit(AbsBits, Code);
+	}
+
+	const bool IsSensor = TestBit(PropBits, INPUT_PROP_ACCELEROMETER);
+	const bool IsPointer = TestBit(KeyBits, BTN_TOUCH) || (TestBit(KeyBits, BTN_LEFT) && !HasJoystickButtons);
+	if (IsSensor || IsPointer || !(HasJoystickButtons || (HasAxes && TestBit(EventBits, EV_ABS))))
+	{
+		close(Fd);
+		return false;
+	}
+
+	input_id Id = {};
+	ioctl(Fd, EVIOCGID, &Id);
+
+	char Name[256] = {};
+	ioctl(Fd, EVIOCGNAME(sizeof(Name) - 1), Name);
+
+	FJoystickEvdevDeviceDescription& Description = Device.Description;
+	Description.Name = UTF8_TO_TCHAR(Name);
+	Description.BusType = Id.bustype;
+	Description.Vendor = Id.vendor;
+	Description.Product = Id.product;
+	Description.Version = Id.version;
+	Description.IsGamepad = TestBit(KeyBits, BTN_GAMEPAD);
+
+	for (int Code = 0; Code <= ABS_MAX; Code++)
+	{
+		if (!TestBit(AbsBits, Code) || IsHatCode(Code))
+		{
+			continue;
+		}
+
+		input_absinfo AbsInfo = {};
+		ioctl(Fd, EVIOCGABS(Code), &AbsInfo);
+		Description.Axes.Add(FJoystickEvdevAxis(Code, AbsInfo.minimum, AbsInfo.maximum));
+	}
+
+	for (int Hat = 0; Hat < MaxHats; Hat++)
+	{
+		if (TestBit(AbsBits, ABS_HAT0X + Hat * 2) || TestBit(AbsBits, ABS_HAT0Y + Hat * 2))
+		{
+			Description.HatCount = Hat + 1;
+		}
+	}
+
+	// SDL numbers joystick buttons first, then anything below BTN_JOYSTICK
+	for (int Code = BTN_JOYSTICK; Code <= KEY_MAX; Code++)
+	{
+		if (TestBit(KeyBits, Code))
+		{
+			Description.Buttons.Add(Code);
+		}
+	}
+
+	for (int Code = 0; Code < BTN_JOYSTICK; Code++)
+	{
+		if (TestBit(KeyBits, Code))
+		{
+			Description.Buttons.Add(Code);
+		}
+	}
+
+	for (int Code = 0; Code < REL_MAX; Code += 2)
+	{
+		if (TestBit(RelBits, Code) || TestBit(RelBits, Code + 1))
+		{
+			Description.BallCount = Code / 2 + 1;
+		}
+	}
+
+	Device.Fd = Fd;
+	Device.Path = Path;
+	Device.IsProbed = true;
+	return true;
+}
+
+int FJoystickBackendEvdev::AddDevice(FEvdevDevice&& Device)
+{
+	Device.InstanceId = NextInstanceId++;
+	Device.Guid = CreateGuid(Device.Description);
+
+	Device.AxisIndices.Init(-1, ABS_CNT);
+	for (int i = 0; i < Device.Description.Axes.Num(); i++)
+	{
+		const uint16 Code = Device.Description.Axes[i].Code;
+		if (Code < ABS_CNT)
+		{
+			Device.AxisIndices[Code] = i;
+		}
+	}
+
+	Device.ButtonIndices.Init(-1, KEY_CNT);
+	for (int i = 0; i < Device.Description.Buttons.Num(); i++)
+	{
+		const uint16 Code = Device.Description.Buttons[i];
+		if (Code < KEY_CNT)
+		{
+			Device.ButtonIndices[Code] = i;
+		}
+	}
+
+	Device.Description.HatCount = FMath::Min(Device.Description.HatCount, MaxHats);
+	Device.HatValues.Init(0, Device.Description.HatCount * 2);
+
+	FScopeLock Lock(&DevicesLock);
+	return Devices.Add(MoveTemp(Device));
+}
+
+void FJoystickBackendEvdev::DetachDevice(const int InstanceId)
+{
+	int DeviceId = -1;
+	{
+		FScopeLock Lock(&DevicesLock);
+
+		const int DeviceIndex = FindDeviceIndexByInstanceId(InstanceId);
+		if (DeviceIndex == -1)
+		{
+			return;
+		}
+
+		FEvdevDevice& Device = Devices[DeviceIndex];
+		Device.IsEndOfStream = true;
+		DeviceId = Device.DeviceId;
+
+		if (DeviceId == -1)
+		{
+			CloseDescriptor(Device);
+			Devices.RemoveAt(DeviceIndex);
+			return;
+		}
+	}
+
+	// The listener closes the device, which removes it now that it has ended
+	Listener->OnDeviceDetached(*this, DeviceId);
+}
+
+void FJoystickBackendEvdev::CloseDescriptor(FEvdevDevice& Device) const
+{
+	if (Device.Fd >= 0)
+	{
+		close(Device.Fd);
+		Device.Fd = -1;
+	}
+}
+
+void FJoystickBackendEvdev::ReadDevice(FEvdevDevice& Device)
+{
+	if (Device.IsEndOfStream)
+	{
+		return;
+	}
+
+	const input_event* Events = reinterpret_cast<const input_event*>(ReadBuffer.GetData());
+	while (true)
+	{
+		// The part of an event left over from the last read goes first, the rest of it follows in this read
+		const int CarriedBytes = Device.PartialEvent.Num();
+		if (CarriedBytes > 0)
+		{
+			FMemory::Memcpy(ReadBuffer.GetData(), Device.PartialEvent.GetData(), CarriedBytes);
+		}
+
+		const int ReadSize = ReadBuffer.Num() - CarriedBytes;
+		const ssize_t BytesRead = read(Device.Fd, ReadBuffer.GetData() + CarriedBytes, ReadSize);
+		if (BytesRead < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				return;
+			}
+
+			// ENODEV once the device has been unplugged
+			break;
+		}
+
+		if (BytesRead == 0)
+		{
+			// The writer closed the pipe or the file ended
+			break;
+		}
+
+		// Recorded streams carry stale times, only devices probed here are on the monotonic clock
+		const bool TrackLatency = Device.IsProbed && JoystickLatency::IsTrackingEnabled();
+		double KernelNow = 0.0;
+		double PlatformNow = 0.0;
+		if (TrackLatency)
+		{
+			timespec Now;
+			clock_gettime(CLOCK_MONOTONIC, &Now);
+			KernelNow = Now.tv_sec + Now.tv_nsec / 1000000000.0;
+			PlatformNow = FPlatformTime::Seconds();
+		}
+
+		const int BufferedBytes = CarriedBytes + static_cast<int>(BytesRead);
+		const int EventCount = BufferedBytes / sizeof(input_event);
+		const int RemainingBytes = BufferedBytes - EventCount * sizeof(input_event);
+		Device.PartialEvent.SetNumUninitialized(RemainingBytes);
+		if (RemainingBytes > 0)
+		{
+			FMemory::Memcpy(Device.PartialEvent.GetData(), ReadBuffer.GetData() + EventCount * sizeof(input_event), RemainingBytes);
+		}
+
+		for (int i = 0; i < EventCount; i++)
+		{
+			if (TrackLatency)
+			{
+				EventSourceTimestamp = PlatformNow - (KernelNow - (Events[i].time.tv_sec + Events[i].time.tv_usec / 1000000.0));
+			}
+
+			ProcessEvent(Device, Events[i].type, Events[i].code, Events[i].value);
+		}
+
+		EventSourceTimestamp = 0.0;
+
+		// A short read drained the device, save the syscall that would return EAGAIN
+		if (BytesRead < ReadSize)
+		{
+			return;
+		}
+	}
+
+	if (!Device.IsPolled)
+	{
+		epoll_ctl(EpollFd, EPOLL_CTL_DEL, Device.Fd, nullptr);
+	}
+
+	Device.IsEndOfStream = true;
+	PendingDeviceEvents.Enqueue(FJoystickDeviceEvent(EJoystickDeviceEventType::Removed, Device.InstanceId));
+}
+
+void FJoystickBackendEvdev::ProcessEvent(FEvdevDevice& Device, const uint16 Type, const uint16 Code, const int32 Value)
+{
+	if (Type == EV_SYN)
+	{
+		if (Code == SYN_DROPPED)
+		{
+			Device.IsDropping = true;
+		}
+		else if (Code == SYN_REPORT && Device.IsDropping)
+		{
+			Device.IsDropping = false;
+			Resynchronise(Device);
+		}
+
+		return;
+	}
+
+	if (Device.IsDropping)
+	{
+		return;
+	}
+
+	switch (Type)
+	{
+		case EV_KEY:
+			// Value 2 is auto-repeat
+			if (Code < KEY_CNT && Device.ButtonIndices[Code] != -1 && Value != 2)
+			{
+				SendButton(Device, Device.ButtonIndices[Code], Value != 0);
+			}
+			break;
+		case EV_ABS:
+			if (IsHatCode(Code))
+			{
+				const int HatAxis = Code - ABS_HAT0X;
+				if (HatAxis < Device.HatValues.Num())
+				{
+					Device.HatValues[HatAxis] = static_cast<int8>(FMath::Sign(Value));
+					SendHat(Device, HatAxis / 2);
+				}
+			}
+			else if (Code < ABS_CNT && Device.AxisIndices[Code] != -1)
+			{
+				SendAxis(Device, Device.AxisIndices[Code], Value);
+			}
+			break;
+		case EV_REL:
+			if (Code / 2 < Device.Description.BallCount)
+			{
+				FJoystickInputEvent InputEvent;
+				InputEvent.Type = EJoystickInputEventType::Ball;
+				InputEvent.DeviceId = Device.DeviceId;
+				InputEvent.Index = Code / 2;
+				InputEvent.BallDelta = (Code & 1) == 0 ? FVector2D(Value, 0) : FVector2D(0, Value);
+				InputEvent.Timestamp = FPlatformTime::Seconds();
+				InputEvent.SourceTimestamp = EventSourceTimestamp;
+				Listener->OnInputEvent(*this, InputEvent);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+void FJoystickBackendEvdev::Resynchronise(FEvdevDevice& Device)
+{
+	// Descriptors that were not probed cannot be queried, their state catches up with the next events
+	if (!Device.IsProbed || Device.DeviceId == -1)
+	{
+		return;
+	}
+
+	uint8 KeyStates[(KEY_MAX + 8) / 8] = {};
+	if (ioctl(Device.Fd, EVIOCGKEY(sizeof(KeyStates)), KeyStates) >= 0)
+	{
+		for (int i = 0; i < Device.Description.Buttons.Num(); i++)
+		{
+			SendButton(Device, i, TestBit(KeyStates, Device.Description.Buttons[i]));
+		}
+	}
+
+	for (int i = 0; i < Device.Description.Axes.Num(); i++)
+	{
+		input_absinfo AbsInfo = {};
+		if (ioctl(Device.Fd, EVIOCGABS(Device.Description.Axes[i].Code), &AbsInfo) >= 0)
+		{
+			SendAxis(Device, i, AbsInfo.value);
+		}
+	}
+
+	for (int HatAxis = 0; HatAxis < Device.HatValues.Num(); HatAxis++)
+	{
+		input_absinfo AbsInfo = {};
+		if (ioctl(Device.Fd, EVIOCGABS(ABS_HAT0X + HatAxis), &AbsInfo) >= 0)
+		{
+			Device.HatValues[HatAxis] = static_cast<int8>(FMath::Sign(AbsInfo.value));
+		}
+	}
+
+	for (int Hat = 0; Hat < Device.Description.HatCount; Hat++)
+	{
+		SendHat(Device, Hat);
+	}
+}
+
+void FJoystickBackendEvdev::SendAxis(const FEvdevDevice& Device, const int Axis, const int32 Value) const
+{
+	const FJoystickEvdevAxis& AxisInfo = Device.Description.Axes[Axis];
+	const int64 Range = static_cast<int64>(AxisInfo.Maximum) - AxisInfo.Minimum;
+
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Axis;
+	InputEvent.DeviceId = Device.DeviceId;
+	InputEvent.Index = Axis;
+	InputEvent.Value = Range > 0 ? FMath::Clamp(static_cast<float>((Value - AxisInfo.Minimum) * 2.0 / Range - 1.0), -1.f, 1.f) : 0.f;
+	InputEvent.Timestamp = FPlatformTime::Seconds();
+	InputEvent.SourceTimestamp = EventSourceTimestamp;
+	Listener->OnInputEvent(*this, InputEvent);
+}
+
+void FJoystickBackendEvdev::SendButton(const FEvdevDevice& Device, const int Button, const bool Pressed) const
+{
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Button;
+	InputEvent.DeviceId = Device.DeviceId;
+	InputEvent.Index = Button;
+	InputEvent.ButtonPressed = Pressed;
+	InputEvent.Timestamp = FPlatformTime::Seconds();
+	InputEvent.SourceTimestamp = EventSourceTimestamp;
+	Listener->OnInputEvent(*this, InputEvent);
+}
+
+void FJoystickBackendEvdev::SendHat(const FEvdevDevice& Device, const int Hat) const
+{
+	const int8 X = Device.HatValues[Hat * 2];
+	const int8 Y = Device.HatValues[Hat * 2 + 1];
+
+	int8 HatValue = SDL_HAT_CENTERED;
+	HatValue |= Y < 0 ? SDL_HAT_UP : Y > 0 ? SDL_HAT_DOWN : 0;
+	HatValue |= X < 0 ? SDL_HAT_LEFT : X > 0 ? SDL_HAT_RIGHT : 0;
+
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Hat;
+	InputEvent.DeviceId = Device.DeviceId;
+	InputEvent.Index = Hat;
+	InputEvent.HatDirection = UJoystickFunctionLibrary::HatValueToDirection(HatValue);
+	InputEvent.Timestamp = FPlatformTime::Seconds();
+	InputEvent.SourceTimestamp = EventSourceTimestamp;
+	Listener->OnInputEvent(*this, InputEvent);
+}
+
+FJoystickBackendEvdev::FEvdevDevice* FJoystickBackendEvdev::FindDeviceByFd(const int Fd)
+{
+	return Devices.FindByPredicate([Fd](const FEvdevDevice& Device)
+	{
+		return Device.Fd == Fd;
+	});
+}
+
+int FJoystickBackendEvdev::FindDeviceIndexByInstanceId(const int InstanceId) const
+{
+	return Devices.IndexOfByPredicate([InstanceId](const FEvdevDevice& Device)
+	{
+		return Device.InstanceId == InstanceId;
+	});
+}
+
+bool FJoystickBackendEvdev::IsOpen(const FString& Path) const
+{
+	FScopeLock Lock(&DevicesLock);
+	return Devices.ContainsByPredicate([&Path](const FEvdevDevice& Device)
+	{
+		return Device.Path == Path && !Device.IsEndOfStream;
+	});
+}
+
+void FJoystickBackendEvdev::ProcessHotplug()
+{
+	if (InotifyFd < 0)
+	{
+		return;
+	}
+
+	alignas(inotify_event) uint8 Buffer[4096];
+	ssize_t BytesRead;
+	while ((BytesRead = read(InotifyFd, Buffer, sizeof(Buffer))) > 0)
+	{
+		for (ssize_t Offset = 0; Offset < BytesRead;)
+		{
+			const inotify_event* Event = reinterpret_cast<const inotify_event*>(Buffer + Offset);
+			Offset += sizeof(inotify_event) + Event->len;
+
+			if (Event->len == 0 || FCStringAnsi::Strncmp(Event->name, "event", 5) != 0)
+			{
+				continue;
+			}
+
+			const FString Path = FString::Printf(TEXT("%s/%s"), UTF8_TO_TCHAR(InputDirectory), UTF8_TO_TCHAR(Event->name));
+			if ((Event->mask & (IN_CREATE | IN_ATTRIB)) != 0)
+			{
+				// Nodes usually become readable on IN_ATTRIB, once udev has set their permissions
+				FEvdevDevice Device;
+				if (!IsOpen(Path) && ProbeDevice(Path, Device))
+				{
+					Listener->OnDeviceAttached(*this, AddDevice(MoveTemp(Device)));
+				}
+			}
+			else if ((Event->mask & IN_DELETE) != 0)
+			{
+				int InstanceId = -1;
+				{
+					// A reused path can still list the entry of an earlier device that already ended, skip it
+					FScopeLock Lock(&DevicesLock);
+					if (const FEvdevDevice* Device = Devices.FindByPredicate([&Path](const FEvdevDevice& Candidate) { return Candidate.Path == Path && !Candidate.IsEndOfStream; }))
+					{
+						InstanceId = Device->InstanceId;
+					}
+				}
+
+				DetachDevice(InstanceId);
+			}
+		}
+	}
+}
+
+void FJoystickBackendEvdev::ProcessDeviceEvents()
+{
+	FJoystickDeviceEvent DeviceEvent;
+	while (PendingDeviceEvents.Dequeue(DeviceEvent))
+	{
+		if (DeviceEvent.Type == EJoystickDeviceEventType::Removed)
+		{
+			DetachDevice(DeviceEvent.Which);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,233 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendMock.h"
+#include "Data/JoystickInputEvent.h"
+
+FJoystickBackendMock::FJoystickBackendMock()
+	: Listener(nullptr)
+	  , LastBoundDeviceId(-1)
+	  , NextInstanceId(0)
+	  , NextEffectId(0)
+	  , HapticCallCount(0)
+{
+}
+
+int FJoystickBackendMock::AddDevice(const FString& DeviceName, const int AxisCount, const int ButtonCount, const int HatCount, const int BallCount)
+{
+	if (Listener == nullptr)
+	{
+		return -1;
+	}
+
+	FDeviceInfoSDL Device;
+	Device.DeviceName = DeviceName;
+	Device.InstanceId = NextInstanceId++;
+	Device.AxisCount = AxisCount;
+	Device.ButtonCount = ButtonCount;
+	Device.HatCount = HatCount;
+	Device.BallCount = BallCount;
+
+	LastBoundDeviceId = -1;
+
+	AttachingDevices.Reset();
+	AttachingDevices.Add(Device);
+	Listener->OnDeviceAttached(*this, 0);
+	AttachingDevices.Reset();
+
+	return LastBoundDeviceId;
+}
+
+void FJoystickBackendMock::RemoveDevice(const int DeviceId)
+{
+	if (Listener == nullptr || !DeviceIds.Contains(DeviceId))
+	{
+		return;
+	}
+
+	Listener->OnDeviceDetached(*this, DeviceId);
+}
+
+void FJoystickBackendMock::SetAxis(const int DeviceId, const int Axis, const float Value) const
+{
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Axis;
+	InputEvent.DeviceId = DeviceId;
+	InputEvent.Index = Axis;
+	InputEvent.Value = FMath::Clamp(Value, -1.f, 1.f);
+	SendInputEvent(InputEvent);
+}
+
+void FJoystickBackendMock::SetButton(const int DeviceId, const int Button, const bool Pressed) const
+{
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Button;
+	InputEvent.DeviceId = DeviceId;
+	InputEvent.Index = Button;
+	InputEvent.ButtonPressed = Pressed;
+	SendInputEvent(InputEvent);
+}
+
+void FJoystickBackendMock::SetHat(const int DeviceId, const int Hat, const EJoystickPOVDirection Direction) const
+{
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Hat;
+	InputEvent.DeviceId = DeviceId;
+	InputEvent.Index = Hat;
+	InputEvent.HatDirection = Direction;
+	SendInputEvent(InputEvent);
+}
+
+void FJoystickBackendMock::MoveBall(const int DeviceId, const int Ball, const FVector2D& Delta) const
+{
+	FJoystickInputEvent InputEvent;
+	InputEvent.Type = EJoystickInputEventType::Ball;
+	InputEvent.DeviceId = DeviceId;
+	InputEvent.Index = Ball;
+	InputEvent.BallDelta = Delta;
+	SendInputEvent(InputEvent);
+}
+
+int FJoystickBackendMock::GetHapticCallCount() const
+{
+	FScopeLock Lock(&HapticLock);
+	return HapticCallCount;
+}
+
+FName FJoystickBackendMock::GetName() const
+{
+	return TEXT("Mock");
+}
+
+bool FJoystickBackendMock::Initialise(IJoystickBackendListener& InListener)
+{
+	Listener = &InListener;
+	return true;
+}
+
+void FJoystickBackendMock::Shutdown()
+{
+	const TArray<int> AttachedDeviceIds = DeviceIds.Array();
+	for (const int DeviceId : AttachedDeviceIds)
+	{
+		Listener->OnDeviceDetached(*this, DeviceId);
+	}
+
+	{
+		FScopeLock Lock(&HapticLock);
+		DeviceIds.Empty();
+	}
+
+	Listener = nullptr;
+}
+
+void FJoystickBackendMock::EnumerateDevices()
+{
+	// Devices only exist once AddDevice is called
+}
+
+int FJoystickBackendMock::GetDeviceCount() const
+{
+	return AttachingDevices.Num();
+}
+
+bool FJoystickBackendMock::IsGamepad(const int DeviceIndex) const
+{
+	return false;
+}
+
+bool FJoystickBackendMock::OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device)
+{
+	if (!AttachingDevices.IsValidIndex(DeviceIndex))
+	{
+		return false;
+	}
+
+	Device = AttachingDevices[DeviceIndex];
+	return true;
+}
+
+void FJoystickBackendMock::BindDevice(const FDeviceInfoSDL& Device)
+{
+	FScopeLock Lock(&HapticLock);
+	DeviceIds.Add(Device.DeviceId);
+	LastBoundDeviceId = Device.DeviceId;
+}
+
+void FJoystickBackendMock::CloseDevice(const FDeviceInfoSDL& Device)
+{
+	FScopeLock Lock(&HapticLock);
+	DeviceIds.Remove(Device.DeviceId);
+}
+
+void FJoystickBackendMock::Update(const bool PollInput)
+{
+}
+
+bool FJoystickBackendMock::SetAutoCenter(const int DeviceId, const int Center)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId);
+}
+
+bool FJoystickBackendMock::SetGain(const int DeviceId, const int Gain)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId);
+}
+
+int FJoystickBackendMock::CreateEffect(const int DeviceId, SDL_HapticEffect& Effect)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId) ? NextEffectId++ : -1;
+}
+
+bool FJoystickBackendMock::UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId);
+}
+
+bool FJoystickBackendMock::RunEffect(const int DeviceId, const int EffectId, const int Iterations)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId);
+}
+
+bool FJoystickBackendMock::StopEffect(const int DeviceId, const int EffectId)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+	return DeviceIds.Contains(DeviceId);
+}
+
+void FJoystickBackendMock::PlayRumble(const int DeviceId, const float LowFrequency, const float HighFrequency, const float Duration)
+{
+	FScopeLock Lock(&HapticLock);
+	HapticCallCount++;
+}
+
+void FJoystickBackendMock::SendInputEvent(FJoystickInputEvent& InputEvent) const
+{
+	if (Listener == nullptr)
+	{
+		return;
+	}
+
+	{
+		// Inputs can be sent from any thread while the game thread binds and closes devices
+		FScopeLock Lock(&HapticLock);
+		if (!DeviceIds.Contains(InputEvent.DeviceId))
+		{
+			return;
+		}
+	}
+
+	InputEvent.Timestamp = FPlatformTime::Seconds();
+	Listener->OnInputEvent(*this, InputEvent);
+}
@@ -0,0 +1,377 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendReplay.h"
+#include "JoystickLogManager.h"
+#include "HAL/PlatformFileManager.h"
+
+namespace
+{
+	constexpr int ReadBufferSize = 64 * 1024;
+
+	/* Records released per frame when replaying as fast as possible, well below the per device queue capacity */
+	constexpr int FastRecordsPerTick = 256;
+}
+
+FJoystickBackendReplay::FJoystickBackendReplay(const FString& InPath, const bool InAsFastAsPossible)
+	: Listener(nullptr)
+	  , Path(InPath)
+	  , ReadOffset(0)
+	  , EndOfFile(false)
+	  , AsFastAsPossible(InAsFastAsPossible)
+	  , Started(false)
+	  , Finished(false)
+	  , StartTime(0.0)
+	  , RecordTime(0.0)
+	  , HasPendingRecord(false)
+{
+	File.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Path));
+	if (!File.IsValid())
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to open recording %s"), *Path);
+		return;
+	}
+
+	Buffer.Reserve(ReadBufferSize);
+	if (!ReadHeader())
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("%s is not a joystick recording."), *Path);
+		File.Reset();
+	}
+}
+
+FJoystickBackendReplay::~FJoystickBackendReplay()
+{
+	File.Reset();
+}
+
+bool FJoystickBackendReplay::IsValid() const
+{
+	return File.IsValid();
+}
+
+const FString& FJoystickBackendReplay::GetPath() const
+{
+	return Path;
+}
+
+bool FJoystickBackendReplay::IsFinished() const
+{
+	return Finished;
+}
+
+FName FJoystickBackendReplay::GetName() const
+{
+	return TEXT("Replay");
+}
+
+bool FJoystickBackendReplay::Initialise(IJoystickBackendListener& InListener)
+{
+	Listener = &InListener;
+	return File.IsValid();
+}
+
+void FJoystickBackendReplay::Shutdown()
+{
+	TArray<int> ReplayedDeviceIds;
+	DeviceIds.GenerateValueArray(ReplayedDeviceIds);
+	for (const int DeviceId : ReplayedDeviceIds)
+	{
+		Listener->OnDeviceDetached(*this, DeviceId);
+	}
+
+	DeviceIds.Empty();
+	File.Reset();
+}
+
+void FJoystickBackendReplay::EnumerateDevices()
+{
+	// The recorded devices attach on the first update, when the replay clock starts
+}
+
+int FJoystickBackendReplay::GetDeviceCount() const
+{
+	return AttachingDevices.Num();
+}
+
+bool FJoystickBackendReplay::IsGamepad(const int DeviceIndex) const
+{
+	return AttachingDevices.IsValidIndex(DeviceIndex) && AttachingDevices[DeviceIndex].IsGamepad;
+}
+
+bool FJoystickBackendReplay::OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device)
+{
+	if (!AttachingDevices.IsValidIndex(DeviceIndex))
+	{
+		return false;
+	}
+
+	// The recorded device id doubles as the instance id so the binding can be found again
+	Device = AttachingDevices[DeviceIndex];
+	Device.DeviceIndex = -1;
+	Device.InstanceId = AttachingDevices[DeviceIndex].DeviceId;
+	Device.HasRumble = false;
+	Device.IsReplayed = true;
+	return true;
+}
+
+void FJoystickBackendReplay::BindDevice(const FDeviceInfoSDL& Device)
+{
+	DeviceIds.Add(Device.InstanceId, Device.DeviceId);
+}
+
+void FJoystickBackendReplay::CloseDevice(const FDeviceInfoSDL& Device)
+{
+	DeviceIds.Remove(Device.InstanceId);
+}
+
+bool FJoystickBackendReplay::IsReplay() const
+{
+	return true;
+}
+
+void FJoystickBackendReplay::Update(const bool PollInput)
+{
+	if (!File.IsValid() || Finished)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (!Started)
+	{
+		Started = true;
+		StartTime = Now;
+
+		for (const FDeviceInfoSDL& Device : HeaderDevices)
+		{
+			AttachDevice(Device);
+		}
+	}
+
+	int Released = 0;
+	while (true)
+	{
+		if (!HasPendingRecord)
+		{
+			HasPendingRecord = ReadRecord(PendingRecord);
+			if (!HasPendingRecord)
+			{
+				Finished = true;
+				return;
+			}
+		}
+
+		if (AsFastAsPossible ? Released >= FastRecordsPerTick : StartTime + PendingRecord.Time > Now)
+		{
+			return;
+		}
+
+		Release(PendingRecord);
+		HasPendingRecord = false;
+		Released++;
+	}
+}
+
+void FJoystickBackendReplay::AttachDevice(const FDeviceInfoSDL& Device)
+{
+	AttachingDevices.Reset();
+	AttachingDevices.Add(Device);
+	Listener->OnDeviceAttached(*this, 0);
+	AttachingDevices.Reset();
+}
+
+bool FJoystickBackendReplay::ReadHeader()
+{
+	if (!Refill() || Buffer.Num() < 5)
+	{
+		return false;
+	}
+
+	const uint8* Data = Buffer.GetData();
+	const uint32 Magic = Data[0] | Data[1] << 8 | Data[2] << 16 | static_cast<uint32>(Data[3]) << 24;
+	if (Magic != JoystickRecording::Magic || Data[4] != JoystickRecording::Version)
+	{
+		return false;
+	}
+	Data += 5;
+
+	const uint8* End = Buffer.GetData() + Buffer.Num();
+	uint64 DeviceCount;
+	if (!JoystickRecording::ReadVarint(Data, End, DeviceCount))
+	{
+		return false;
+	}
+
+	for (uint64 i = 0; i < DeviceCount; i++)
+	{
+		ReadOffset = Data - Buffer.GetData();
+		if (!Refill())
+		{
+			return false;
+		}
+
+		Data = Buffer.GetData() + ReadOffset;
+		End = Buffer.GetData() + Buffer.Num();
+
+		FDeviceInfoSDL Device;
+		if (!JoystickRecording::ReadDevice(Data, End, Device))
+		{
+			return false;
+		}
+
+		HeaderDevices.Add(Device);
+	}
+
+	ReadOffset = Data - Buffer.GetData();
+	return true;
+}
+
+bool FJoystickBackendReplay::ReadRecord(FReplayRecord& Record)
+{
+	if (!Refill() || ReadOffset >= Buffer.Num())
+	{
+		return false;
+	}
+
+	const uint8* Data = Buffer.GetData() + ReadOffset;
+	const uint8* End = Buffer.GetData() + Buffer.Num();
+
+	const uint8 Tag = *Data++;
+	uint64 DeltaMicroseconds;
+	if ((Tag & JoystickRecording::RecordTypeMask) > static_cast<uint8>(JoystickRecording::ERecordType::DeviceRemoved) || !JoystickRecording::ReadVarint(Data, End, DeltaMicroseconds))
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Recording %s is corrupt or truncated, stopping the replay."), *Path);
+		return false;
+	}
+
+	RecordTime += DeltaMicroseconds * 1.e-6;
+	Record.Type = static_cast<JoystickRecording::ERecordType>(Tag & JoystickRecording::RecordTypeMask);
+	Record.Time = RecordTime;
+
+	bool Valid = true;
+	if (Record.Type == JoystickRecording::ERecordType::DeviceAdded)
+	{
+		Record.Device = FDeviceInfoSDL();
+		Valid = JoystickRecording::ReadDevice(Data, End, Record.Device);
+	}
+	else
+	{
+		FJoystickInputEvent& InputEvent = Record.InputEvent;
+		InputEvent = FJoystickInputEvent();
+
+		uint64 DeviceId;
+		uint64 Index = 0;
+		Valid = JoystickRecording::ReadVarint(Data, End, DeviceId) && (Record.Type == JoystickRecording::ERecordType::DeviceRemoved || JoystickRecording::ReadVarint(Data, End, Index));
+		InputEvent.DeviceId = static_cast<int>(DeviceId);
+		InputEvent.Index = static_cast<int>(Index);
+
+		switch (Record.Type)
+		{
+			case JoystickRecording::ERecordType::Axis:
+				{
+					uint64 Delta = 0;
+					Valid = Valid && JoystickRecording::ReadVarint(Data, End, Delta);
+
+					int32& LastValue = LastAxisValues.FindOrAdd(JoystickRecording::AxisKey(InputEvent.DeviceId, InputEvent.Index));
+					LastValue += static_cast<int32>(JoystickRecording::ZigZagDecode(Delta));
+
+					InputEvent.Type = EJoystickInputEventType::Axis;
+					InputEvent.Value = JoystickRecording::RawToAxisValue(LastValue);
+					break;
+				}
+			case JoystickRecording::ERecordType::Button:
+				InputEvent.Type = EJoystickInputEventType::Button;
+				InputEvent.ButtonPressed = (Tag & JoystickRecording::ButtonPressedFlag) != 0;
+				break;
+			case JoystickRecording::ERecordType::Hat:
+				Valid = Valid && Data < End;
+				InputEvent.Type = EJoystickInputEventType::Hat;
+				InputEvent.HatDirection = Valid ? static_cast<EJoystickPOVDirection>(*Data++) : EJoystickPOVDirection::Direction_None;
+				break;
+			case JoystickRecording::ERecordType::Ball:
+				{
+					uint64 DeltaX;
+					uint64 DeltaY;
+					Valid = Valid && JoystickRecording::ReadVarint(Data, End, DeltaX) && JoystickRecording::ReadVarint(Data, End, DeltaY);
+
+					InputEvent.Type = EJoystickInputEventType::Ball;
+					InputEvent.BallDelta = Valid ? FVector2D(static_cast<float>(JoystickRecording::ZigZagDecode(DeltaX)), static_cast<float>(JoystickRecording::ZigZagDecode(DeltaY))) : FVector2D::ZeroVector;
+					break;
+				}
+			default:
+				break;
+		}
+	}
+
+	if (!Valid)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Recording %s is corrupt or truncated, stopping the replay."), *Path);
+		return false;
+	}
+
+	ReadOffset = Data - Buffer.GetData();
+	return true;
+}
+
+bool FJoystickBackendReplay::Refill()
+{
+	const int Unread = Buffer.Num() - ReadOffset;
+	if (EndOfFile || Unread >= JoystickRecording::MaxRecordSize)
+	{
+		return true;
+	}
+
+	if (ReadOffset > 0)
+	{
+		FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + ReadOffset, Unread);
+		ReadOffset = 0;
+	}
+
+	const int64 Remaining = File->Size() - File->Tell();
+	const int ToRead = static_cast<int>(FMath::Min<int64>(Remaining, ReadBufferSize - Unread));
+
+	Buffer.SetNumUninitialized(Unread + ToRead);
+	if (ToRead > 0 && !File->Read(Buffer.GetData() + Unread, ToRead))
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to read recording %s"), *Path);
+		Buffer.SetNum(Unread);
+		EndOfFile = true;
+		return false;
+	}
+
+	EndOfFile = ToRead == Remaining;
+	return true;
+}
+
+void FJoystickBackendReplay::Release(FReplayRecord& Record)
+{
+	switch (Record.Type)
+	{
+		case JoystickRecording::ERecordType::DeviceAdded:
+			AttachDevice(Record.Device);
+			break;
+		case JoystickRecording::ERecordType::DeviceRemoved:
+			{
+				const int* DeviceId = DeviceIds.Find(Record.InputEvent.DeviceId);
+				if (DeviceId != nullptr)
+				{
+					Listener->OnDeviceDetached(*this, *DeviceId);
+				}
+				break;
+			}
+		default:
+			{
+				const int* DeviceId = DeviceIds.Find(Record.InputEvent.DeviceId);
+				if (DeviceId == nullptr)
+				{
+					break;
+				}
+
+				Record.InputEvent.DeviceId = *DeviceId;
+				Record.InputEvent.Timestamp = StartTime + Record.Time;
+				Listener->OnInputEvent(*this, Record.InputEvent);
+				break;
+			}
+	}
+}
@@ -0,0 +1,87 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickInputRecording.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "Interfaces/JoystickBackend.h"
+#include "Templates/UniquePtr.h"
+
+class IFileHandle;
+
+/**
+ * Plays a recording from FJoystickInputRecorder back as if the devices were attached.
+ * The file is streamed through a small buffer, so multi-hour captures replay in constant memory.
+ * Records are released on the game thread either at their original timing or, when running as fast
+ * as possible, a fixed batch per frame.
+ */
+class FJoystickBackendReplay final : public IJoystickBackend
+{
+public:
+	FJoystickBackendReplay(const FString& InPath, const bool InAsFastAsPossible);
+	virtual ~FJoystickBackendReplay() override;
+
+	bool IsValid() const;
+	bool IsFinished() const;
+	const FString& GetPath() const;
+
+	// Begin IJoystickBackend
+	virtual FName GetName() const override;
+	virtual bool Initialise(IJoystickBackendListener& InListener) override;
+	virtual void Shutdown() override;
+	virtual void EnumerateDevices() override;
+	virtual int GetDeviceCount() const override;
+	virtual bool IsGamepad(const int DeviceIndex) const override;
+	virtual bool OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device) override;
+	virtual void BindDevice(const FDeviceInfoSDL& Device) override;
+	virtual void CloseDevice(const FDeviceInfoSDL& Device) override;
+	virtual void Update(const bool PollInput) override;
+	virtual bool IsReplay() const override;
+	// End IJoystickBackend
+
+private:
+	struct FReplayRecord
+	{
+		JoystickRecording::ERecordType Type = JoystickRecording::ERecordType::Axis;
+		double Time = 0.0;
+		FJoystickInputEvent InputEvent;
+		FDeviceInfoSDL Device;
+	};
+
+	bool ReadHeader();
+	bool ReadRecord(FReplayRecord& Record);
+	bool Refill();
+	void Release(FReplayRecord& Record);
+	void AttachDevice(const FDeviceInfoSDL& Device);
+
+	IJoystickBackendListener* Listener;
+
+	FString Path;
+	TUniquePtr<IFileHandle> File;
+
+	TArray<uint8> Buffer;
+	int ReadOffset;
+	bool EndOfFile;
+
+	bool AsFastAsPossible;
+	bool Started;
+	bool Finished;
+	double StartTime;
+
+	// Decoder state mirroring the recorder
+	double RecordTime;
+	TMap<uint64, int32> LastAxisValues;
+
+	TArray<FDeviceInfoSDL> HeaderDevices;
+
+	// Recorded devices waiting to be opened, indexed by the device index passed to the listener
+	TArray<FDeviceInfoSDL> AttachingDevices;
+
+	// Recorded device id to the id the replayed device was given
+	TMap<int, int> DeviceIds;
+
+	bool HasPendingRecord;
+	FReplayRecord PendingRecord;
+};
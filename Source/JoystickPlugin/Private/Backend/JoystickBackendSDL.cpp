@@ -0,0 +1,911 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendSDL.h"
+#include "JoystickFunctionLibrary.h"
+#include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "Data/DeviceInfoSDL.h"
+#include "JoystickInputSettings.h"
+#include "Async/Async.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+THIRD_PARTY_INCLUDES_START
+
+#include "SDL.h"
+
+THIRD_PARTY_INCLUDES_END
+
+FJoystickBackendSDL::FJoystickBackendSDL()
+	: Listener(nullptr)
+	  , IsOwningSDL(false)
+	  , IsWatching(false)
+	  , OpenAsynchronously(false)
+{
+	for (std::atomic<int64>& Mapping : PublishedDeviceMapping)
+	{
+		Mapping.store(-1, std::memory_order_relaxed);
+	}
+
+	UnpublishedDeviceCount.store(0, std::memory_order_relaxed);
+}
+
+FName FJoystickBackendSDL::GetName() const
+{
+	return TEXT("SDL");
+}
+
+bool FJoystickBackendSDL::Initialise(IJoystickBackendListener& InListener)
+{
+	Listener = &InListener;
+
+	FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL Starting"));
+
+	if (SDL_WasInit(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC) != 0)
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL already loaded"));
+		IsOwningSDL = false;
+	}
+	else
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL::InitSDL() SDL init 0"));
+		SDL_Init(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC);
+		IsOwningSDL = true;
+	}
+
+	const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
+	OpenAsynchronously = IsValid(JoystickInputSettings) && JoystickInputSettings->OpenDevicesAsynchronously;
+
+	return SDL_WasInit(SDL_INIT_JOYSTICK) != 0;
+}
+
+void FJoystickBackendSDL::Shutdown()
+{
+	FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL Closing"));
+
+	if (IsWatching)
+	{
+		SDL_DelEventWatch(HandleSDLEvent, this);
+		IsWatching = false;
+	}
+
+	// Workers still opening devices reference the backend, wait for them before tearing it down
+	for (TFuture<void>& OpenTask : OpenTasks)
+	{
+		OpenTask.Wait();
+	}
+	OpenTasks.Empty();
+
+	FPreparedDevice Prepared;
+	while (PreparedResults.Dequeue(Prepared))
+	{
+		CloseHandles(Prepared.Handles);
+	}
+
+	for (TTuple<int, FPreparedDevice>& PreparedDevice : PreparedDevices)
+	{
+		CloseHandles(PreparedDevice.Value.Handles);
+	}
+	PreparedDevices.Empty();
+	OpeningDevices.Empty();
+
+	TArray<int> DeviceIds;
+	BoundDevices.GetKeys(DeviceIds);
+	for (const int DeviceId : DeviceIds)
+	{
+		Listener->OnDeviceDetached(*this, DeviceId);
+	}
+
+	if (IsOwningSDL)
+	{
+		SDL_Quit();
+	}
+}
+
+void FJoystickBackendSDL::EnumerateDevices()
+{
+	if (SDL_WasInit(SDL_INIT_JOYSTICK) == 0)
+	{
+		return;
+	}
+
+	const int JoystickCount = GetDeviceCount();
+	for (int i = 0; i < JoystickCount; i++)
+	{
+		if (OpenAsynchronously)
+		{
+			// Startup enumeration overlaps with whatever the game thread does next, e.g. a loading screen
+			PrepareDevice(SDL_JoystickGetDeviceInstanceID(i));
+		}
+		else
+		{
+			Listener->OnDeviceAttached(*this, i);
+		}
+	}
+
+	// Only start watching now, the devices that were already attached have been added above
+	if (!IsWatching)
+	{
+		SDL_AddEventWatch(HandleSDLEvent, this);
+		IsWatching = true;
+	}
+}
+
+int FJoystickBackendSDL::GetDeviceCount() const
+{
+	return SDL_NumJoysticks();
+}
+
+bool FJoystickBackendSDL::IsGamepad(const int DeviceIndex) const
+{
+	return SDL_IsGameController(DeviceIndex) == SDL_TRUE;
+}
+
+bool FJoystickBackendSDL::OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device)
+{
+	// Devices opened by a worker only need handing over
+	FPreparedDevice Prepared;
+	if (PreparedDevices.RemoveAndCopyValue(SDL_JoystickGetDeviceInstanceID(DeviceIndex), Prepared))
+	{
+		Device = Prepared.Device;
+		Device.DeviceIndex = DeviceIndex;
+		OpenedDevices.Add(Device.InstanceId, Prepared.Handles);
+		return true;
+	}
+
+	FDeviceHandles Handles;
+	if (!OpenHandles(DeviceIndex, Device, Handles))
+	{
+		return false;
+	}
+
+	ProbeHandles(Device, Handles);
+	OpenedDevices.Add(Device.InstanceId, Handles);
+	return true;
+}
+
+bool FJoystickBackendSDL::OpenHandles(const int DeviceIndex, FDeviceInfoSDL& Device, FDeviceHandles& Handles)
+{
+	Handles.Joystick = SDL_JoystickOpen(DeviceIndex);
+	if (Handles.Joystick == nullptr)
+	{
+		return false;
+	}
+
+	Device.DeviceIndex = DeviceIndex;
+	Device.IsGamepad = SDL_IsGameController(DeviceIndex) == SDL_TRUE;
+	Device.InstanceId = SDL_JoystickInstanceID(Handles.Joystick);
+
+	const SDL_JoystickGUID SDLGuid = SDL_JoystickGetDeviceGUID(DeviceIndex);
+	memcpy(&Device.ProductId, &SDLGuid, sizeof(FGuid));
+
+	return true;
+}
+
+void FJoystickBackendSDL::ProbeHandles(FDeviceInfoSDL& Device, FDeviceHandles& Handles)
+{
+	// DEBUG
+	Device.DeviceName = FString(ANSI_TO_TCHAR(SDL_JoystickName(Handles.Joystick)));
+	FJoystickLogManager::Get()->LogDebug(TEXT("%s:"), *Device.DeviceName);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tInstance ID: %d"), Device.InstanceId);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tDevice Index: %d"), Device.DeviceIndex);
+
+	Device.AxisCount = SDL_JoystickNumAxes(Handles.Joystick);
+	Device.ButtonCount = SDL_JoystickNumButtons(Handles.Joystick);
+	Device.HatCount = SDL_JoystickNumHats(Handles.Joystick);
+	Device.BallCount = SDL_JoystickNumBalls(Handles.Joystick);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Axis %i"), Device.AxisCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Balls %i"), Device.BallCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Buttons %i"), Device.ButtonCount);
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Hats %i"), Device.HatCount);
+
+#if ENGINE_MAJOR_VERSION == 5
+	const bool HasRumble = SDL_JoystickHasRumble(Handles.Joystick) == SDL_TRUE;
+#else
+	const bool HasRumble = false;
+#endif
+	FJoystickLogManager::Get()->LogDebug(TEXT("\tRumble Support: %s"), HasRumble ? TEXT("true") : TEXT("false"));
+	Device.HasRumble = HasRumble;
+
+	if (SDL_JoystickIsHaptic(Handles.Joystick))
+	{
+		OpenHaptic(Handles);
+	}
+}
+
+void FJoystickBackendSDL::CloseHandles(FDeviceHandles& Handles)
+{
+	if (Handles.Haptic != nullptr)
+	{
+		FScopeLock Lock(&HapticLock);
+		SDL_HapticClose(Handles.Haptic);
+		Handles.Haptic = nullptr;
+	}
+
+	if (Handles.Joystick != nullptr)
+	{
+		SDL_JoystickClose(Handles.Joystick);
+		Handles.Joystick = nullptr;
+	}
+}
+
+void FJoystickBackendSDL::PrepareDevice(const int InstanceId)
+{
+	if (OpeningDevices.Contains(InstanceId) || PreparedDevices.Contains(InstanceId) || OpenedDevices.Contains(InstanceId))
+	{
+		return;
+	}
+
+	OpeningDevices.Add(InstanceId);
+	OpenTasks.Add(Async(EAsyncExecution::ThreadPool, [this, InstanceId]()
+	{
+		FPreparedDevice Prepared;
+		Prepared.Device.InstanceId = InstanceId;
+
+		// Indices shift as devices come and go, the lock keeps this one valid until the joystick is open.
+		// Probing only needs the handle, so it runs unlocked and does not hold up the thread pumping SDL.
+		SDL_LockJoysticks();
+		const int DeviceIndex = FindDeviceIndex(InstanceId);
+		Prepared.IsOpen = DeviceIndex != -1 && OpenHandles(DeviceIndex, Prepared.Device, Prepared.Handles);
+		SDL_UnlockJoysticks();
+
+		if (Prepared.IsOpen)
+		{
+			ProbeHandles(Prepared.Device, Prepared.Handles);
+		}
+
+		PreparedResults.Enqueue(MoveTemp(Prepared));
+	}));
+}
+
+void FJoystickBackendSDL::ProcessPreparedDevices()
+{
+	OpenTasks.RemoveAll([](const TFuture<void>& OpenTask)
+	{
+		return OpenTask.IsReady();
+	});
+
+	FPreparedDevice Prepared;
+	while (PreparedResults.Dequeue(Prepared))
+	{
+		const int InstanceId = Prepared.Device.InstanceId;
+		OpeningDevices.Remove(InstanceId);
+
+		if (!Prepared.IsOpen)
+		{
+			continue;
+		}
+
+		// The device may have gone while the worker was opening it
+		const int DeviceIndex = FindDeviceIndex(InstanceId);
+		if (DeviceIndex == -1 || SDL_JoystickGetAttached(Prepared.Handles.Joystick) != SDL_TRUE)
+		{
+			CloseHandles(Prepared.Handles);
+			continue;
+		}
+
+		PreparedDevices.Add(InstanceId, Prepared);
+		Listener->OnDeviceAttached(*this, DeviceIndex);
+
+		// Still here when the listener turned it down, e.g. an ignored game controller
+		FPreparedDevice Unused;
+		if (PreparedDevices.RemoveAndCopyValue(InstanceId, Unused))
+		{
+			CloseHandles(Unused.Handles);
+		}
+	}
+}
+
+void FJoystickBackendSDL::BindDevice(const FDeviceInfoSDL& Device)
+{
+	FDeviceHandles Handles;
+	if (!OpenedDevices.RemoveAndCopyValue(Device.InstanceId, Handles))
+	{
+		return;
+	}
+
+	{
+		FScopeLock Lock(&HapticLock);
+		BoundDevices.Add(Device.DeviceId, Handles);
+	}
+
+	{
+		FScopeLock Lock(&DeviceMappingLock);
+		DeviceMapping.Add(Device.InstanceId, Device.DeviceId);
+	}
+
+	PublishDeviceMapping(Device.InstanceId, Device.DeviceId);
+}
+
+void FJoystickBackendSDL::CloseDevice(const FDeviceInfoSDL& Device)
+{
+	{
+		// The haptic thread may be using the device
+		FScopeLock Lock(&HapticLock);
+
+		FDeviceHandles Handles;
+		if (BoundDevices.RemoveAndCopyValue(Device.DeviceId, Handles))
+		{
+			FJoystickLogManager::Get()->LogDebug(TEXT("Closing Joystick Device for %d"), Device.DeviceId);
+			CloseHandles(Handles);
+		}
+	}
+
+	UnpublishDeviceMapping(Device.InstanceId);
+
+	FScopeLock Lock(&DeviceMappingLock);
+	DeviceMapping.Remove(Device.InstanceId);
+}
+
+void FJoystickBackendSDL::Update(const bool PollInput)
+{
+	if (PollInput && IsOwningSDL)
+	{
+		SDL_Event Event;
+		while (SDL_PollEvent(&Event))
+		{
+			// The event watcher handles it
+		}
+	}
+
+	ProcessDeviceEvents();
+	ProcessPreparedDevices();
+}
+
+void FJoystickBackendSDL::PollInput()
+{
+	if (IsOwningSDL)
+	{
+		SDL_Event Event;
+		while (SDL_PollEvent(&Event))
+		{
+			// The event watcher handles it
+		}
+	}
+	else
+	{
+		// The engine owns the SDL event queue, only poll the joysticks so the watcher sees the samples
+		SDL_JoystickUpdate();
+	}
+}
+
+bool FJoystickBackendSDL::OwnsSDL() const
+{
+	return IsOwningSDL;
+}
+
+void FJoystickBackendSDL::OpenHaptic(FDeviceHandles& Handles)
+{
+	// SDL keeps opened haptics in an unguarded global list, opening races with the calls made on other devices
+	FScopeLock Lock(&HapticLock);
+
+	Handles.Haptic = SDL_HapticOpenFromJoystick(Handles.Joystick);
+	if (Handles.Haptic != nullptr)
+	{
+		const unsigned int Supported = SDL_HapticQuery(Handles.Haptic);
+		FJoystickLogManager::Get()->LogDebug(TEXT("Haptic Device detected"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("Number of Haptic Axis: %i"), SDL_HapticNumAxes(Handles.Haptic));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_CONSTANT support: %s"), (Supported & SDL_HAPTIC_CONSTANT) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SINE support: %s"), (Supported & SDL_HAPTIC_SINE) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_TRIANGLE support: %s"), (Supported & SDL_HAPTIC_TRIANGLE) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SAWTOOTHUP support: %s"), (Supported & SDL_HAPTIC_SAWTOOTHUP) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SAWTOOTHDOWN support: %s"), (Supported & SDL_HAPTIC_SAWTOOTHDOWN) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_RAMP support: %s"), (Supported & SDL_HAPTIC_RAMP) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SPRING support: %s"), (Supported & SDL_HAPTIC_SPRING) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_DAMPER support: %s"), (Supported & SDL_HAPTIC_DAMPER) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_INERTIA support: %s"), (Supported & SDL_HAPTIC_INERTIA) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_FRICTION support: %s"), (Supported & SDL_HAPTIC_FRICTION) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_CUSTOM support: %s"), (Supported & SDL_HAPTIC_CUSTOM) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_GAIN support: %s"), (Supported & SDL_HAPTIC_GAIN) != 0 ? TEXT("true") : TEXT("false"));
+		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_AUTOCENTER support: %s"), (Supported & SDL_HAPTIC_AUTOCENTER) != 0 ? TEXT("true") : TEXT("false"));
+	}
+}
+
+SDL_Haptic* FJoystickBackendSDL::GetHaptic(const int DeviceId) const
+{
+	const FDeviceHandles* Handles = BoundDevices.Find(DeviceId);
+	if (Handles == nullptr)
+	{
+		return nullptr;
+	}
+
+	return Handles->Haptic;
+}
+
+bool FJoystickBackendSDL::FindDeviceId(const int InstanceId, int& DeviceId)
+{
+	// Called for every input event on the event watch, which must not wait on the game thread
+	for (const std::atomic<int64>& PublishedMapping : PublishedDeviceMapping)
+	{
+		const int64 Mapping = PublishedMapping.load(std::memory_order_acquire);
+		if (Mapping != -1 && static_cast<int>(Mapping >> 32) == InstanceId)
+		{
+			DeviceId = static_cast<int>(static_cast<uint32>(Mapping));
+			return true;
+		}
+	}
+
+	if (UnpublishedDeviceCount.load(std::memory_order_acquire) == 0)
+	{
+		return false;
+	}
+
+	FScopeLock Lock(&DeviceMappingLock);
+
+	const int* MappedDeviceId = DeviceMapping.Find(InstanceId);
+	if (MappedDeviceId == nullptr)
+	{
+		return false;
+	}
+
+	DeviceId = *MappedDeviceId;
+	return true;
+}
+
+void FJoystickBackendSDL::PublishDeviceMapping(const int InstanceId, const int DeviceId)
+{
+	const int64 Mapping = (static_cast<int64>(InstanceId) << 32) | static_cast<uint32>(DeviceId);
+	for (std::atomic<int64>& PublishedMapping : PublishedDeviceMapping)
+	{
+		if (PublishedMapping.load(std::memory_order_relaxed) == -1)
+		{
+			PublishedMapping.store(Mapping, std::memory_order_release);
+			return;
+		}
+	}
+
+	++UnpublishedDeviceCount;
+}
+
+void FJoystickBackendSDL::UnpublishDeviceMapping(const int InstanceId)
+{
+	for (std::atomic<int64>& PublishedMapping : PublishedDeviceMapping)
+	{
+		const int64 Mapping = PublishedMapping.load(std::memory_order_relaxed);
+		if (Mapping != -1 && static_cast<int>(Mapping >> 32) == InstanceId)
+		{
+			PublishedMapping.store(-1, std::memory_order_release);
+			return;
+		}
+	}
+
+	FScopeLock Lock(&DeviceMappingLock);
+	if (DeviceMapping.Contains(InstanceId))
+	{
+		--UnpublishedDeviceCount;
+	}
+}
+
+int FJoystickBackendSDL::FindDeviceIndex(const int InstanceId) const
+{
+	const int JoystickCount = GetDeviceCount();
+	for (int i = 0; i < JoystickCount; i++)
+	{
+		if (SDL_JoystickGetDeviceInstanceID(i) == InstanceId)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void FJoystickBackendSDL::ProcessDeviceEvents()
+{
+	FJoystickDeviceEvent DeviceEvent;
+	while (PendingDeviceEvents.Dequeue(DeviceEvent))
+	{
+		switch (DeviceEvent.Type)
+		{
+			case EJoystickDeviceEventType::Added:
+				{
+					if (OpenAsynchronously)
+					{
+						PrepareDevice(DeviceEvent.Which);
+						break;
+					}
+
+					// Device indices shift as devices come and go, so resolve it again now that we are on the game thread
+					const int DeviceIndex = FindDeviceIndex(DeviceEvent.Which);
+					if (DeviceIndex != -1)
+					{
+						Listener->OnDeviceAttached(*this, DeviceIndex);
+					}
+					break;
+				}
+			case EJoystickDeviceEventType::Removed:
+				{
+					int DeviceId;
+					if (FindDeviceId(DeviceEvent.Which, DeviceId))
+					{
+						Listener->OnDeviceDetached(*this, DeviceId);
+					}
+					break;
+				}
+			default:
+				break;
+		}
+	}
+}
+
+int FJoystickBackendSDL::HandleSDLEvent(void* UserData, SDL_Event* Event)
+{
+	// Called from whichever thread pumps SDL (the game thread, or the input thread when enabled).
+	// SDL serialises event watchers, so each device queue only ever has one producer at a time.
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickHandleSDLEvent);
+
+	FJoystickBackendSDL& Backend = *static_cast<FJoystickBackendSDL*>(UserData);
+	if (Backend.Listener == nullptr)
+	{
+		return -1;
+	}
+
+	FJoystickInputEvent InputEvent;
+	InputEvent.Timestamp = FPlatformTime::Seconds();
+
+	// SourceTimestamp stays unknown: the watch runs as SDL pushes the event and SDL stamps it in the same millisecond,
+	// so an event to queue stage would always read 0. Latency tracking starts at the queue on this backend.
+
+	switch (Event->type)
+	{
+		case SDL_JOYDEVICEADDED:
+			Backend.PendingDeviceEvents.Enqueue(FJoystickDeviceEvent(EJoystickDeviceEventType::Added, SDL_JoystickGetDeviceInstanceID(Event->cdevice.which)));
+			break;
+		/*case SDL_CONTROLLERDEVICEADDED:
+		{
+			if (Self.bIgnoreGameControllers)
+			{
+				// Since JOYSTICK is inited before GAMECONTROLLER (by GAMECONTROLLER),
+				// a controller can be added as a joystick before we can check that it is a controller.
+				// Remove it again and let UE handle it.
+				FDeviceIndex DeviceIndex = FDeviceIndex(Event->cdevice.which);
+				for (auto &Device : Self.Devices)
+				{
+					if (Device.Value.DeviceIndex == DeviceIndex && Self.DeviceMapping.Contains(Device.Value.InstanceId))
+					{
+						Self.DeviceMapping.Remove(Device.Value.InstanceId);
+						Self.EventInterface->JoystickUnplugged(Device.Value.DeviceId);
+					}
+				}
+			}
+			break;
+		}*/
+		case SDL_JOYDEVICEREMOVED:
+			Backend.PendingDeviceEvents.Enqueue(FJoystickDeviceEvent(EJoystickDeviceEventType::Removed, Event->cdevice.which));
+			break;
+		case SDL_JOYBUTTONDOWN:
+		case SDL_JOYBUTTONUP:
+			if (Backend.FindDeviceId(Event->jbutton.which, InputEvent.DeviceId))
+			{
+				InputEvent.Type = EJoystickInputEventType::Button;
+				InputEvent.Index = Event->jbutton.button;
+				InputEvent.ButtonPressed = Event->jbutton.state == SDL_PRESSED;
+				InputEvent.SDLTimestamp = Event->jbutton.timestamp;
+				Backend.Listener->OnInputEvent(Backend, InputEvent);
+
+				FJoystickLogManager::Get()->LogDebug(TEXT("Event JoystickButton Device=%d Button=%d State=%d"), InputEvent.DeviceId, Event->jbutton.button, Event->jbutton.state);
+			}
+			break;
+		case SDL_JOYAXISMOTION:
+			if (Backend.FindDeviceId(Event->jaxis.which, InputEvent.DeviceId))
+			{
+				InputEvent.Type = EJoystickInputEventType::Axis;
+				InputEvent.Index = Event->jaxis.axis;
+				InputEvent.Value = Event->jaxis.value / (Event->jaxis.value < 0 ? 32768.0f : 32767.0f);
+				InputEvent.SDLTimestamp = Event->jaxis.timestamp;
+				Backend.Listener->OnInputEvent(Backend, InputEvent);
+			}
+			break;
+		case SDL_JOYHATMOTION:
+			if (Backend.FindDeviceId(Event->jhat.which, InputEvent.DeviceId))
+			{
+				InputEvent.Type = EJoystickInputEventType::Hat;
+				InputEvent.Index = Event->jhat.hat;
+				InputEvent.HatDirection = UJoystickFunctionLibrary::HatValueToDirection(Event->jhat.value);
+				InputEvent.SDLTimestamp = Event->jhat.timestamp;
+				Backend.Listener->OnInputEvent(Backend, InputEvent);
+			}
+			break;
+		case SDL_JOYBALLMOTION:
+			if (Backend.FindDeviceId(Event->jball.which, InputEvent.DeviceId))
+			{
+				InputEvent.Type = EJoystickInputEventType::Ball;
+				InputEvent.Index = Event->jball.ball;
+				InputEvent.BallDelta = FVector2D(Event->jball.xrel, Event->jball.yrel);
+				InputEvent.SDLTimestamp = Event->jball.timestamp;
+				Backend.Listener->OnInputEvent(Backend, InputEvent);
+			}
+			break;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+bool FJoystickBackendSDL::SetAutoCenter(const int DeviceId, const int Center)
+{
+	JOYSTICK_HAPTIC_SCOPE(SetAutoCenter);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return false;
+	}
+
+	const int Result = SDL_HapticSetAutocenter(HapticDevice, Center);
+	if (Result == -1)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Autocenter Error: %s"), *ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+bool FJoystickBackendSDL::SetGain(const int DeviceId, const int Gain)
+{
+	JOYSTICK_HAPTIC_SCOPE(SetGain);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return false;
+	}
+
+	const int Result = SDL_HapticSetGain(HapticDevice, Gain);
+	if (Result == -1)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Gain Error: %s"), *ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+void FJoystickBackendSDL::PauseHaptics(const int DeviceId)
+{
+	JOYSTICK_HAPTIC_SCOPE(PauseHaptics);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return;
+	}
+
+	SDL_HapticPause(HapticDevice);
+}
+
+void FJoystickBackendSDL::UnpauseHaptics(const int DeviceId)
+{
+	JOYSTICK_HAPTIC_SCOPE(UnpauseHaptics);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return;
+	}
+
+	SDL_HapticUnpause(HapticDevice);
+}
+
+void FJoystickBackendSDL::StopAllEffects(const int DeviceId)
+{
+	JOYSTICK_HAPTIC_SCOPE(StopAllEffects);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return;
+	}
+
+	SDL_HapticStopAll(HapticDevice);
+}
+
+int FJoystickBackendSDL::GetNumEffects(const int DeviceId) const
+{
+	JOYSTICK_HAPTIC_SCOPE(GetNumEffects);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return -1;
+	}
+
+	return SDL_HapticNumEffects(HapticDevice);
+}
+
+int FJoystickBackendSDL::GetNumEffectsPlaying(const int DeviceId) const
+{
+	JOYSTICK_HAPTIC_SCOPE(GetNumEffectsPlaying);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return -1;
+	}
+
+	return SDL_HapticNumEffectsPlaying(HapticDevice);
+}
+
+int FJoystickBackendSDL::GetEffectStatus(const int DeviceId, const int EffectId) const
+{
+	JOYSTICK_HAPTIC_SCOPE(GetEffectStatus);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return -1;
+	}
+
+	const int Result = SDL_HapticGetEffectStatus(HapticDevice, EffectId);
+	if (Result == -1)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("GetEffectStatus Error: %s"), *ErrorMessage);
+		return -1;
+	}
+
+	return Result;
+}
+
+int FJoystickBackendSDL::CreateEffect(const int DeviceId, SDL_HapticEffect& Effect)
+{
+	JOYSTICK_HAPTIC_SCOPE(CreateEffect);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return -1;
+	}
+
+	const int EffectId = SDL_HapticNewEffect(HapticDevice, &Effect);
+	if (EffectId == -1)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Haptic CreateEffect Error: %s"), *ErrorMessage);
+	}
+
+	return EffectId;
+}
+
+bool FJoystickBackendSDL::UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect)
+{
+	JOYSTICK_HAPTIC_SCOPE(UpdateEffect);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return false;
+	}
+
+	const int Result = SDL_HapticUpdateEffect(HapticDevice, EffectId, &Effect);
+	if (Result != 0)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Haptic UpdateEffect Error: %s"), *ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+bool FJoystickBackendSDL::RunEffect(const int DeviceId, const int EffectId, const int Iterations)
+{
+	JOYSTICK_HAPTIC_SCOPE(RunEffect);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return false;
+	}
+
+	const int Result = SDL_HapticRunEffect(HapticDevice, EffectId, Iterations);
+	if (Result != 0)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Haptic RunEffect Error: %s"), *ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+bool FJoystickBackendSDL::StopEffect(const int DeviceId, const int EffectId)
+{
+	JOYSTICK_HAPTIC_SCOPE(StopEffect);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return false;
+	}
+
+	const int Result = SDL_HapticStopEffect(HapticDevice, EffectId);
+	if (Result != 0)
+	{
+		const FString ErrorMessage = FString(SDL_GetError());
+		FJoystickLogManager::Get()->LogError(TEXT("Haptic StopEffect Error: %s"), *ErrorMessage);
+		return false;
+	}
+
+	return true;
+}
+
+void FJoystickBackendSDL::DestroyEffect(const int DeviceId, const int EffectId)
+{
+	JOYSTICK_HAPTIC_SCOPE(DestroyEffect);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return;
+	}
+
+	SDL_HapticDestroyEffect(HapticDevice, EffectId);
+}
+
+void FJoystickBackendSDL::PlayRumble(const int DeviceId, const float LowFrequency, const float HighFrequency, const float Duration)
+{
+	JOYSTICK_HAPTIC_SCOPE(PlayRumble);
+
+#if ENGINE_MAJOR_VERSION == 5
+	FScopeLock Lock(&HapticLock);
+
+	const FDeviceHandles* Handles = BoundDevices.Find(DeviceId);
+	if (Handles == nullptr)
+	{
+		return;
+	}
+
+	const Uint16 LowFrequencyRumble = FMath::Clamp<Uint16>(LowFrequency * UINT16_MAX, 0, UINT16_MAX);
+	const Uint16 HighFrequencyRumble = FMath::Clamp<Uint16>(HighFrequency * UINT16_MAX, 0, UINT16_MAX);
+	const Uint32 ClampedDuration = Duration == -1 ? SDL_HAPTIC_INFINITY : FMath::Clamp<Uint32>(Duration * 1000.0f, 0, UINT32_MAX);
+	SDL_JoystickRumble(Handles->Joystick, LowFrequencyRumble, HighFrequencyRumble, ClampedDuration);
+#else
+	FJoystickLogManager::Get()->LogError(TEXT("PlayRumble not supported on this engine version."));
+#endif
+}
+
+void FJoystickBackendSDL::StopRumble(const int DeviceId)
+{
+	JOYSTICK_HAPTIC_SCOPE(StopRumble);
+
+	FScopeLock Lock(&HapticLock);
+
+	SDL_Haptic* HapticDevice = GetHaptic(DeviceId);
+	if (HapticDevice == nullptr)
+	{
+		return;
+	}
+
+	SDL_HapticRumbleStop(HapticDevice);
+}
@@ -0,0 +1,131 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "HAL/CriticalSection.h"
+#include "Interfaces/JoystickBackend.h"
+
+THIRD_PARTY_INCLUDES_START
+
+#include "SDL_haptic.h"
+#include "SDL_joystick.h"
+
+THIRD_PARTY_INCLUDES_END
+
+#include <atomic>
+
+union SDL_Event;
+
+/**
+ * Joysticks, hats, balls and haptics through SDL2. Input arrives through an SDL event watch on whichever
+ * thread pumps SDL and goes straight to the listener; hot-plug events are deferred to the game thread.
+ * With OpenDevicesAsynchronously set, devices are opened and probed on a worker and only reported to the
+ * listener once their record is complete, so slow devices (force feedback wheels) never stall a frame.
+ */
+class FJoystickBackendSDL final : public IJoystickBackend
+{
+public:
+	FJoystickBackendSDL();
+
+	// Begin IJoystickBackend
+	virtual FName GetName() const override;
+	virtual bool Initialise(IJoystickBackendListener& InListener) override;
+	virtual void Shutdown() override;
+	virtual void EnumerateDevices() override;
+	virtual int GetDeviceCount() const override;
+	virtual bool IsGamepad(const int DeviceIndex) const override;
+	virtual bool OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device) override;
+	virtual void BindDevice(const FDeviceInfoSDL& Device) override;
+	virtual void CloseDevice(const FDeviceInfoSDL& Device) override;
+	virtual void Update(const bool PollInput) override;
+	virtual void PollInput() override;
+
+	virtual bool SetAutoCenter(const int DeviceId, const int Center) override;
+	virtual bool SetGain(const int DeviceId, const int Gain) override;
+	virtual void PauseHaptics(const int DeviceId) override;
+	virtual void UnpauseHaptics(const int DeviceId) override;
+	virtual void StopAllEffects(const int DeviceId) override;
+	virtual int GetNumEffects(const int DeviceId) const override;
+	virtual int GetNumEffectsPlaying(const int DeviceId) const override;
+	virtual int GetEffectStatus(const int DeviceId, const int EffectId) const override;
+	virtual int CreateEffect(const int DeviceId, SDL_HapticEffect& Effect) override;
+	virtual bool UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect) override;
+	virtual bool RunEffect(const int DeviceId, const int EffectId, const int Iterations) override;
+	virtual bool StopEffect(const int DeviceId, const int EffectId) override;
+	virtual void DestroyEffect(const int DeviceId, const int EffectId) override;
+	virtual void PlayRumble(const int DeviceId, const float LowFrequency, const float HighFrequency, const float Duration) override;
+	virtual void StopRumble(const int DeviceId) override;
+	// End IJoystickBackend
+
+	bool OwnsSDL() const;
+
+private:
+	struct FDeviceHandles
+	{
+		SDL_Joystick* Joystick = nullptr;
+		SDL_Haptic* Haptic = nullptr;
+	};
+
+	struct FPreparedDevice
+	{
+		FDeviceInfoSDL Device;
+		FDeviceHandles Handles;
+		bool IsOpen = false;
+	};
+
+	static int HandleSDLEvent(void* UserData, SDL_Event* Event);
+
+	/* Opens the joystick and reads what depends on the device index, the index must stay valid throughout */
+	bool OpenHandles(const int DeviceIndex, FDeviceInfoSDL& Device, FDeviceHandles& Handles);
+	void ProbeHandles(FDeviceInfoSDL& Device, FDeviceHandles& Handles);
+	void CloseHandles(FDeviceHandles& Handles);
+	void OpenHaptic(FDeviceHandles& Handles);
+	SDL_Haptic* GetHaptic(const int DeviceId) const;
+	bool FindDeviceId(const int InstanceId, int& DeviceId);
+	void PublishDeviceMapping(const int InstanceId, const int DeviceId);
+	void UnpublishDeviceMapping(const int InstanceId);
+	int FindDeviceIndex(const int InstanceId) const;
+	void ProcessDeviceEvents();
+
+	void PrepareDevice(const int InstanceId);
+	void ProcessPreparedDevices();
+
+	IJoystickBackendListener* Listener;
+
+	// Opened but not yet given a device id, by instance id
+	TMap<int, FDeviceHandles> OpenedDevices;
+	TMap<int, FDeviceHandles> BoundDevices;
+
+	// Written on the game thread only, read from the input thread under the lock
+	TMap<int, int> DeviceMapping;
+	FCriticalSection DeviceMappingLock;
+
+	// Lock free copy of DeviceMapping for the event watch, the instance id in the high half and the device id in the low half, -1 when free.
+	// Only devices that did not fit are looked up in DeviceMapping.
+	static constexpr int MaxPublishedDevices = 64;
+	std::atomic<int64> PublishedDeviceMapping[MaxPublishedDevices];
+	std::atomic<int> UnpublishedDeviceCount;
+
+	TQueue<FJoystickDeviceEvent, EQueueMode::Mpsc> PendingDeviceEvents;
+
+	// Instance ids being opened by a worker, and the finished records waiting for the game thread
+	TSet<int> OpeningDevices;
+	TArray<TFuture<void>> OpenTasks;
+	TQueue<FPreparedDevice, EQueueMode::Mpsc> PreparedResults;
+
+	// Opened by a worker and reported to the listener, handed over by OpenDevice, by instance id
+	TMap<int, FPreparedDevice> PreparedDevices;
+
+	// SDL's haptic list is not thread safe, every haptic call and open or close holds this. Changes to BoundDevices
+	// hold it too since haptic calls can come from the haptic thread.
+	mutable FCriticalSection HapticLock;
+
+	bool IsOwningSDL;
+	bool IsWatching;
+	bool OpenAsynchronously;
+};
@@ -0,0 +1,107 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Data/JoystickAxisFilter.h"
+
+namespace
+{
+	// Samples captured in the same poll can share a timestamp, keep the filters stable for them
+	constexpr float MinDeltaTime = 1.e-4f;
+
+	float SmoothingFactor(const float CutoffFrequency, const float DeltaTime)
+	{
+		const float TimeConstant = 1.f / (2.f * PI * CutoffFrequency);
+		return 1.f / (1.f + TimeConstant / DeltaTime);
+	}
+}
+
+void FJoystickAxisFilter::Reset()
+{
+	Value = 0.f;
+	Derivative = 0.f;
+	LastTimestamp = 0.0;
+	HasValue = false;
+	HistoryCount = 0;
+	HistoryIndex = 0;
+
+	for (float& Entry : History)
+	{
+		Entry = 0.f;
+	}
+}
+
+float FJoystickAxisFilter::Apply(const float Sample, const double Timestamp)
+{
+	if (Settings.FilterType == EJoystickAxisFilterType::Median)
+	{
+		return ApplyMedian(Sample);
+	}
+
+	if (!HasValue)
+	{
+		Value = Sample;
+		Derivative = 0.f;
+		LastTimestamp = Timestamp;
+		HasValue = true;
+		return Value;
+	}
+
+	const float DeltaTime = FMath::Max(static_cast<float>(Timestamp - LastTimestamp), MinDeltaTime);
+	LastTimestamp = Timestamp;
+
+	switch (Settings.FilterType)
+	{
+		case EJoystickAxisFilterType::LowPass:
+			return ApplyLowPass(Sample, DeltaTime);
+		case EJoystickAxisFilterType::OneEuro:
+			return ApplyOneEuro(Sample, DeltaTime);
+		default:
+			return Sample;
+	}
+}
+
+float FJoystickAxisFilter::ApplyLowPass(const float Sample, const float DeltaTime)
+{
+	const float Alpha = 1.f - FMath::Exp(-2.f * PI * FMath::Max(Settings.CutoffFrequency, 0.01f) * DeltaTime);
+	Value += Alpha * (Sample - Value);
+	return Value;
+}
+
+float FJoystickAxisFilter::ApplyOneEuro(const float Sample, const float DeltaTime)
+{
+	const float SampleDerivative = (Sample - Value) / DeltaTime;
+	Derivative += SmoothingFactor(FMath::Max(Settings.DerivativeCutoff, 0.01f), DeltaTime) * (SampleDerivative - Derivative);
+
+	const float Cutoff = FMath::Max(Settings.MinCutoff, 0.01f) + Settings.Beta * FMath::Abs(Derivative);
+	Value += SmoothingFactor(Cutoff, DeltaTime) * (Sample - Value);
+	return Value;
+}
+
+float FJoystickAxisFilter::ApplyMedian(const float Sample)
+{
+	// Only odd counts have a true middle sample
+	const int Taps = Settings.MedianTaps <= 3 ? 3 : MaxMedianTaps;
+	History[HistoryIndex] = Sample;
+	HistoryIndex = (HistoryIndex + 1) % Taps;
+	HistoryCount = FMath::Min(HistoryCount + 1, Taps);
+
+	// Insertion sort of at most five values
+	float Sorted[MaxMedianTaps];
+	for (int Index = 0; Index < HistoryCount; Index++)
+	{
+		const float Entry = History[Index];
+		int Insert = Index;
+		while (Insert > 0 && Sorted[Insert - 1] > Entry)
+		{
+			Sorted[Insert] = Sorted[Insert - 1];
+			Insert--;
+		}
+		Sorted[Insert] = Entry;
+	}
+
+	// While the history fills up an even count averages the two middle samples rather than favouring the upper one
+	const int Middle = HistoryCount / 2;
+	Value = HistoryCount % 2 == 1 ? Sorted[Middle] : (Sorted[Middle - 1] + Sorted[Middle]) * 0.5f;
+	HasValue = true;
+	return Value;
+}
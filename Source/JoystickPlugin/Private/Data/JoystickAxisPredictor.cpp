@@ -0,0 +1,90 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Data/JoystickAxisPredictor.h"
+
+namespace
+{
+	constexpr double MinSampleInterval = 1.e-4;
+	constexpr float ErrorSmoothing = 0.05f;
+}
+
+void FJoystickAxisPredictor::Reset()
+{
+	for (int Index = 0; Index < SampleCount; Index++)
+	{
+		SampleTimes[Index] = 0.0;
+		SampleValues[Index] = 0.f;
+	}
+
+	NumSamples = 0;
+	PendingValue = 0.f;
+	PendingTime = 0.0;
+	HasPending = false;
+	MeanError = 0.f;
+}
+
+void FJoystickAxisPredictor::AddSample(const float Value, const double Timestamp)
+{
+	// Samples from the same poll share a timestamp, keep the latest value only
+	if (NumSamples > 0 && Timestamp - SampleTimes[SampleCount - 1] < MinSampleInterval)
+	{
+		SampleValues[SampleCount - 1] = Value;
+		return;
+	}
+
+	for (int Index = 0; Index < SampleCount - 1; Index++)
+	{
+		SampleTimes[Index] = SampleTimes[Index + 1];
+		SampleValues[Index] = SampleValues[Index + 1];
+	}
+
+	SampleTimes[SampleCount - 1] = Timestamp;
+	SampleValues[SampleCount - 1] = Value;
+	NumSamples = FMath::Min(NumSamples + 1, SampleCount);
+}
+
+float FJoystickAxisPredictor::Predict(const EJoystickAxisPredictionMode Mode, const float CurrentValue, const double Now, const float Horizon, const float Clamp)
+{
+	float Prediction = CurrentValue;
+
+	const double LastTime = SampleTimes[SampleCount - 1];
+	if (Mode != EJoystickAxisPredictionMode::None && NumSamples >= 2 && Now - LastTime <= MaxSampleAge)
+	{
+		const float Elapsed = static_cast<float>(Now + Horizon - LastTime);
+		const float Velocity = (SampleValues[2] - SampleValues[1]) / static_cast<float>(SampleTimes[2] - SampleTimes[1]);
+		Prediction = SampleValues[2] + Velocity * Elapsed;
+
+		if (Mode == EJoystickAxisPredictionMode::ConstantAcceleration && NumSamples >= 3)
+		{
+			const float PreviousVelocity = (SampleValues[1] - SampleValues[0]) / static_cast<float>(SampleTimes[1] - SampleTimes[0]);
+			const float Acceleration = (Velocity - PreviousVelocity) / static_cast<float>((SampleTimes[2] - SampleTimes[0]) * 0.5);
+			Prediction += 0.5f * Acceleration * Elapsed * Elapsed;
+		}
+
+		if (Clamp > 0.f)
+		{
+			Prediction = FMath::Clamp(Prediction, CurrentValue - Clamp, CurrentValue + Clamp);
+		}
+	}
+
+	if (!HasPending)
+	{
+		PendingValue = Prediction;
+		PendingTime = Now + Horizon;
+		HasPending = true;
+	}
+
+	return Prediction;
+}
+
+void FJoystickAxisPredictor::ResolveError(const float CurrentValue, const double Now)
+{
+	if (!HasPending || Now < PendingTime)
+	{
+		return;
+	}
+
+	MeanError += ErrorSmoothing * (FMath::Abs(CurrentValue - PendingValue) - MeanError);
+	HasPending = false;
+}
@@ -0,0 +1,393 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Data/JoystickDeviceStore.h"
+#include "JoystickAxisKernel.h"
+
+namespace
+{
+	template <typename ElementType>
+	void RemoveRange(TArray<ElementType>& Array, const int Offset, const int Count)
+	{
+		if (Count > 0)
+		{
+			Array.RemoveAt(Offset, Count);
+		}
+	}
+
+	template <typename ElementType>
+	void ResetRange(TArray<ElementType>& Array, const int Offset, const int Count, const ElementType& Value)
+	{
+		for (int Index = Offset; Index < Offset + Count; Index++)
+		{
+			Array[Index] = Value;
+		}
+	}
+
+	bool HasSameSettings(const FJoystickAxisFilterSettings& A, const FJoystickAxisFilterSettings& B)
+	{
+		return A.FilterType == B.FilterType && A.CutoffFrequency == B.CutoffFrequency && A.MinCutoff == B.MinCutoff && A.Beta == B.Beta
+			&& A.DerivativeCutoff == B.DerivativeCutoff && A.MedianTaps == B.MedianTaps;
+	}
+}
+
+int FJoystickDeviceStore::AddDevice(const int DeviceId, const int AxisCount, const int ButtonCount, const int HatCount, const int BallCount)
+{
+	const FJoystickDeviceSlot* ExistingDevice = FindDevice(DeviceId);
+	if (ExistingDevice != nullptr
+		&& (ExistingDevice->AxisCount != AxisCount || ExistingDevice->ButtonCount != ButtonCount || ExistingDevice->HatCount != HatCount || ExistingDevice->BallCount != BallCount))
+	{
+		RemoveDevice(DeviceId);
+	}
+
+	int Slot = FindSlot(DeviceId);
+	if (Slot != INDEX_NONE)
+	{
+		// Reconnected with the same layout, start from a clean state
+		const FJoystickDeviceSlot& Device = Slots[Slot];
+		ResetRange(AxisValues, Device.AxisOffset, Device.AxisCount, 0.f);
+		ResetRange(PreviousAxisValues, Device.AxisOffset, Device.AxisCount, 0.f);
+		ResetRange(MappedAxisValues, Device.AxisOffset, Device.AxisCount, 0.f);
+		ResetRange(PredictedAxisValues, Device.AxisOffset, Device.AxisCount, 0.f);
+		ResetRange(AxisPredictors, Device.AxisOffset, Device.AxisCount, FJoystickAxisPredictor());
+		ResetRange(AxisSamples, Device.AxisOffset, Device.AxisCount, FJoystickAxisFrameSamples());
+		ResetRange(AxisDispatch, Device.AxisOffset, Device.AxisCount, FJoystickAnalogDispatchState());
+		for (int Index = Device.AxisOffset; Index < Device.AxisOffset + Device.AxisCount; Index++)
+		{
+			const FIntPoint& FilterRange = AxisFilterRanges[Index];
+			for (int FilterIndex = FilterRange.X; FilterIndex < FilterRange.X + FilterRange.Y; FilterIndex++)
+			{
+				AxisFilters[FilterIndex].Reset();
+			}
+		}
+		ResetRange(ButtonWords, Device.ButtonWordOffset, GetButtonWordCount(Device.ButtonCount), static_cast<uint64>(0));
+		ResetRange(PreviousButtonWords, Device.ButtonWordOffset, GetButtonWordCount(Device.ButtonCount), static_cast<uint64>(0));
+		ResetRange(HatDirections, Device.HatOffset, Device.HatCount, EJoystickPOVDirection::Direction_None);
+		ResetRange(PreviousHatDirections, Device.HatOffset, Device.HatCount, EJoystickPOVDirection::Direction_None);
+		ResetRange(HatDispatch, Device.HatOffset * 2, Device.HatCount * 2, FJoystickAnalogDispatchState());
+		ResetRange(BallDeltas, Device.BallOffset, Device.BallCount, FVector2D::ZeroVector);
+		ResetRange(PreviousBallDeltas, Device.BallOffset, Device.BallCount, FVector2D::ZeroVector);
+		ResetRange(BallDispatch, Device.BallOffset * 2, Device.BallCount * 2, FJoystickAnalogDispatchState());
+		ButtonEdges[Slot].Reset();
+		Slots[Slot].ReplayButtonEdges = false;
+		return Slot;
+	}
+
+	FJoystickDeviceSlot Device;
+	Device.DeviceId = DeviceId;
+	Device.AxisOffset = AxisValues.Num();
+	Device.AxisCount = AxisCount;
+	Device.ButtonOffset = ButtonKeys.Num();
+	Device.ButtonCount = ButtonCount;
+	Device.ButtonWordOffset = ButtonWords.Num();
+	Device.HatOffset = HatDirections.Num();
+	Device.HatCount = HatCount;
+	Device.BallOffset = BallDeltas.Num();
+	Device.BallCount = BallCount;
+	Slot = Slots.Add(Device);
+
+	AxisValues.AddZeroed(AxisCount);
+	PreviousAxisValues.AddZeroed(AxisCount);
+	MappedAxisValues.AddZeroed(AxisCount);
+	PredictedAxisValues.AddZeroed(AxisCount);
+	AxisPredictors.AddDefaulted(AxisCount);
+	AxisSamples.AddDefaulted(AxisCount);
+	AxisDispatch.AddDefaulted(AxisCount);
+	AxisInputScales.AddZeroed(AxisCount);
+	AxisInputBiases.AddZeroed(AxisCount);
+	AxisOutputScales.AddZeroed(AxisCount);
+	AxisOutputBiases.AddZeroed(AxisCount);
+	AxisFilterRanges.AddZeroed(AxisCount);
+	AxisConfigs.AddDefaulted(AxisCount);
+	AxisKeys.AddDefaulted(AxisCount);
+
+	ButtonWords.AddZeroed(GetButtonWordCount(ButtonCount));
+	PreviousButtonWords.AddZeroed(GetButtonWordCount(ButtonCount));
+	ButtonKeys.AddDefaulted(ButtonCount);
+
+	HatDirections.AddZeroed(HatCount);
+	PreviousHatDirections.AddZeroed(HatCount);
+	HatDispatch.AddDefaulted(HatCount * 2);
+	HatKeys.AddDefaulted(HatCount * 2);
+
+	BallDeltas.AddZeroed(BallCount);
+	PreviousBallDeltas.AddZeroed(BallCount);
+	BallDispatch.AddDefaulted(BallCount * 2);
+	BallKeys.AddDefaulted(BallCount * 2);
+
+	ButtonEdges.AddDefaulted();
+	DeviceNames.AddDefaulted();
+
+	if (DeviceId >= DeviceSlots.Num())
+	{
+		const int PreviousNum = DeviceSlots.Num();
+		DeviceSlots.SetNum(DeviceId + 1);
+		ResetRange(DeviceSlots, PreviousNum, DeviceSlots.Num() - PreviousNum, static_cast<int>(INDEX_NONE));
+	}
+
+	DeviceSlots[DeviceId] = Slot;
+	BuildAxisRemap();
+	return Slot;
+}
+
+void FJoystickDeviceStore::RemoveDevice(const int DeviceId)
+{
+	const int Slot = FindSlot(DeviceId);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FJoystickDeviceSlot Device = Slots[Slot];
+
+	RemoveRange(AxisValues, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(PreviousAxisValues, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(MappedAxisValues, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(PredictedAxisValues, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisPredictors, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisSamples, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisDispatch, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisInputScales, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisInputBiases, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisOutputScales, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisOutputBiases, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisFilterRanges, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisConfigs, Device.AxisOffset, Device.AxisCount);
+	RemoveRange(AxisKeys, Device.AxisOffset, Device.AxisCount);
+
+	RemoveRange(ButtonWords, Device.ButtonWordOffset, GetButtonWordCount(Device.ButtonCount));
+	RemoveRange(PreviousButtonWords, Device.ButtonWordOffset, GetButtonWordCount(Device.ButtonCount));
+	RemoveRange(ButtonKeys, Device.ButtonOffset, Device.ButtonCount);
+
+	RemoveRange(HatDirections, Device.HatOffset, Device.HatCount);
+	RemoveRange(PreviousHatDirections, Device.HatOffset, Device.HatCount);
+	RemoveRange(HatDispatch, Device.HatOffset * 2, Device.HatCount * 2);
+	RemoveRange(HatKeys, Device.HatOffset * 2, Device.HatCount * 2);
+
+	RemoveRange(BallDeltas, Device.BallOffset, Device.BallCount);
+	RemoveRange(PreviousBallDeltas, Device.BallOffset, Device.BallCount);
+	RemoveRange(BallDispatch, Device.BallOffset * 2, Device.BallCount * 2);
+	RemoveRange(BallKeys, Device.BallOffset * 2, Device.BallCount * 2);
+
+	Slots.RemoveAt(Slot);
+	ButtonEdges.RemoveAt(Slot);
+	DeviceNames.RemoveAt(Slot);
+	DeviceSlots[DeviceId] = INDEX_NONE;
+
+	// Slots are laid out in order, so only the ones after the removed device move
+	for (int Index = Slot; Index < Slots.Num(); Index++)
+	{
+		FJoystickDeviceSlot& MovedDevice = Slots[Index];
+		MovedDevice.AxisOffset -= Device.AxisCount;
+		MovedDevice.ButtonOffset -= Device.ButtonCount;
+		MovedDevice.ButtonWordOffset -= GetButtonWordCount(Device.ButtonCount);
+		MovedDevice.HatOffset -= Device.HatCount;
+		MovedDevice.BallOffset -= Device.BallCount;
+		DeviceSlots[MovedDevice.DeviceId] = Index;
+	}
+
+	BuildAxisRemap();
+}
+
+void FJoystickDeviceStore::BuildAxisRemap()
+{
+	AxisResponseTables.Reset();
+	AxisResponseTableOffsets.Init(INDEX_NONE, AxisConfigs.Num());
+	AxisRadialPartners.Init(INDEX_NONE, AxisConfigs.Num());
+	ResponseAxes.Reset();
+	RadialAxisPairs.Reset();
+	PredictedAxes.Reset();
+
+	// Stages are carried over by position so adding a device or editing one axis does not reset the smoothing of the others
+	const TArray<FJoystickAxisFilter> PreviousFilters = MoveTemp(AxisFilters);
+	AxisFilters.Reset();
+
+	for (const FJoystickDeviceSlot& Device : Slots)
+	{
+		for (int AxisIndex = 0; AxisIndex < Device.AxisCount; AxisIndex++)
+		{
+			const int Index = Device.AxisOffset + AxisIndex;
+			const FJoystickAxisConfig& Config = AxisConfigs[Index];
+			JoystickAxisKernel::BuildRemap(Config, AxisInputScales[Index], AxisInputBiases[Index], AxisOutputScales[Index], AxisOutputBiases[Index]);
+
+			const FIntPoint PreviousRange = AxisFilterRanges[Index];
+			AxisFilterRanges[Index] = FIntPoint(AxisFilters.Num(), Config.Filters.Num());
+			for (int FilterIndex = 0; FilterIndex < Config.Filters.Num(); FilterIndex++)
+			{
+				const FJoystickAxisFilterSettings& FilterSettings = Config.Filters[FilterIndex];
+				if (FilterIndex < PreviousRange.Y && HasSameSettings(PreviousFilters[PreviousRange.X + FilterIndex].Settings, FilterSettings))
+				{
+					AxisFilters.Add(PreviousFilters[PreviousRange.X + FilterIndex]);
+					continue;
+				}
+
+				AxisFilters.Emplace(FilterSettings);
+			}
+
+			if (Config.PredictionMode != EJoystickAxisPredictionMode::None)
+			{
+				PredictedAxes.Add(Index);
+			}
+
+			// The Y axis of a radial pair uses the response of its X axis
+			if (AxisRadialPartners[Index] != INDEX_NONE || !Config.HasResponse())
+			{
+				continue;
+			}
+
+			const int TableOffset = AxisResponseTables.AddUninitialized(JoystickAxisKernel::ResponseTableSize);
+			JoystickAxisKernel::BakeResponseTable(Config, AxisResponseTables.GetData() + TableOffset);
+			AxisResponseTableOffsets[Index] = TableOffset;
+
+			const int PairedIndex = Device.AxisOffset + Config.PairedAxisIndex;
+			if (Config.HasRadialDeadzone() && Config.PairedAxisIndex < Device.AxisCount && Config.PairedAxisIndex != AxisIndex
+				&& AxisRadialPartners[PairedIndex] == INDEX_NONE)
+			{
+				ResponseAxes.Remove(PairedIndex);
+				AxisResponseTableOffsets[PairedIndex] = TableOffset;
+				AxisRadialPartners[Index] = PairedIndex;
+				AxisRadialPartners[PairedIndex] = Index;
+				RadialAxisPairs.Emplace(Index, PairedIndex);
+				continue;
+			}
+
+			ResponseAxes.Add(Index);
+		}
+	}
+
+	RemapAxes();
+	PredictAxes();
+}
+
+void FJoystickDeviceStore::RemapAxes()
+{
+	if (ResponseAxes.Num() == 0 && RadialAxisPairs.Num() == 0)
+	{
+		JoystickAxisKernel::RemapAxes(AxisValues.GetData(), AxisInputScales.GetData(), AxisInputBiases.GetData(), AxisOutputScales.GetData(), AxisOutputBiases.GetData(),
+		                              MappedAxisValues.GetData(), AxisValues.Num());
+		return;
+	}
+
+	JoystickAxisKernel::NormalizeAxes(AxisValues.GetData(), AxisInputScales.GetData(), AxisInputBiases.GetData(), MappedAxisValues.GetData(), AxisValues.Num());
+
+	for (const int Index : ResponseAxes)
+	{
+		const float* Table = AxisResponseTables.GetData() + AxisResponseTableOffsets[Index];
+		MappedAxisValues[Index] = JoystickAxisKernel::ApplyResponse(Table, MappedAxisValues[Index], AxisConfigs[Index].Centered);
+	}
+
+	for (const FIntPoint& RadialAxisPair : RadialAxisPairs)
+	{
+		const float* Table = AxisResponseTables.GetData() + AxisResponseTableOffsets[RadialAxisPair.X];
+		JoystickAxisKernel::ApplyRadialResponse(Table, MappedAxisValues[RadialAxisPair.X], MappedAxisValues[RadialAxisPair.Y]);
+	}
+
+	JoystickAxisKernel::ScaleAxes(MappedAxisValues.GetData(), AxisOutputScales.GetData(), AxisOutputBiases.GetData(), MappedAxisValues.Num());
+}
+
+void FJoystickDeviceStore::PredictAxes()
+{
+	const double Now = FPlatformTime::Seconds();
+	for (const int Index : PredictedAxes)
+	{
+		const FJoystickAxisConfig& Config = AxisConfigs[Index];
+		const float CurrentValue = MappedAxisValues[Index];
+
+		FJoystickAxisPredictor& Predictor = AxisPredictors[Index];
+		Predictor.ResolveError(CurrentValue, Now);
+
+		const float OutputMin = FMath::Min(AxisOutputBiases[Index], AxisOutputBiases[Index] + AxisOutputScales[Index]);
+		const float OutputMax = FMath::Max(AxisOutputBiases[Index], AxisOutputBiases[Index] + AxisOutputScales[Index]);
+		const float Prediction = Predictor.Predict(Config.PredictionMode, CurrentValue, Now, Config.PredictionHorizon, Config.PredictionClamp);
+		PredictedAxisValues[Index] = FMath::Clamp(Prediction, OutputMin, OutputMax);
+	}
+}
+
+float FJoystickDeviceStore::FilterAxisValue(const int Index, const float Value, const double Timestamp)
+{
+	float FilteredValue = Value;
+
+	const FIntPoint& FilterRange = AxisFilterRanges[Index];
+	for (int FilterIndex = FilterRange.X; FilterIndex < FilterRange.X + FilterRange.Y; FilterIndex++)
+	{
+		FilteredValue = AxisFilters[FilterIndex].Apply(FilteredValue, Timestamp);
+	}
+
+	return FilteredValue;
+}
+
+float FJoystickDeviceStore::RemapAxisValue(const int Index, const float Value) const
+{
+	float RangePct = JoystickAxisKernel::NormalizeAxis(Value, AxisInputScales[Index], AxisInputBiases[Index]);
+
+	const int TableOffset = AxisResponseTableOffsets[Index];
+	if (TableOffset != INDEX_NONE)
+	{
+		const float* Table = AxisResponseTables.GetData() + TableOffset;
+		const int PartnerIndex = AxisRadialPartners[Index];
+		if (PartnerIndex == INDEX_NONE)
+		{
+			RangePct = JoystickAxisKernel::ApplyResponse(Table, RangePct, AxisConfigs[Index].Centered);
+		}
+		else
+		{
+			// Pair the sample with the partner's latest value
+			float PartnerRangePct = JoystickAxisKernel::NormalizeAxis(AxisValues[PartnerIndex], AxisInputScales[PartnerIndex], AxisInputBiases[PartnerIndex]);
+			JoystickAxisKernel::ApplyRadialResponse(Table, RangePct, PartnerRangePct);
+		}
+	}
+
+	return JoystickAxisKernel::ScaleAxis(RangePct, AxisOutputScales[Index], AxisOutputBiases[Index]);
+}
+
+void FJoystickDeviceStore::BuildDeviceData(const FJoystickDeviceSlot& Slot, FJoystickDeviceData& DeviceData) const
+{
+	DeviceData.Axes.SetNum(Slot.AxisCount);
+	for (int AxisIndex = 0; AxisIndex < Slot.AxisCount; AxisIndex++)
+	{
+		const int Index = Slot.AxisOffset + AxisIndex;
+		const FJoystickAxisConfig& Config = AxisConfigs[Index];
+
+		FAxisData& AxisData = DeviceData.Axes[AxisIndex];
+		AxisData.Value = AxisValues[Index];
+		AxisData.PreviousValue = PreviousAxisValues[Index];
+		AxisData.MappedValue = MappedAxisValues[Index];
+		AxisData.PreviousMappedValue = RemapAxisValue(Index, PreviousAxisValues[Index]);
+		AxisData.RemappingEnabled = Config.RemappingEnabled;
+		AxisData.InputOffset = Config.InputOffset;
+		AxisData.InvertInput = Config.InvertInput;
+		AxisData.InputRangeMin = Config.InputRangeMin;
+		AxisData.InputRangeMax = Config.InputRangeMax;
+		AxisData.OutputRangeMin = Config.OutputRangeMin;
+		AxisData.OutputRangeMax = Config.OutputRangeMax;
+		AxisData.InvertOutput = Config.InvertOutput;
+		AxisData.bGamepadStick = Config.bGamepadStick;
+		AxisData.DispatchThreshold = Config.DispatchThreshold;
+		AxisData.PredictedValue = GetOutputAxisValue(Index);
+		AxisData.PredictionError = AxisPredictors[Index].MeanError;
+	}
+
+	DeviceData.Buttons.SetNumZeroed(Slot.ButtonCount);
+	for (int ButtonIndex = 0; ButtonIndex < Slot.ButtonCount; ButtonIndex++)
+	{
+		FButtonData& ButtonData = DeviceData.Buttons[ButtonIndex];
+		ButtonData.ButtonState = IsButtonPressed(Slot, ButtonIndex);
+		ButtonData.PreviousButtonState = WasButtonPressed(Slot, ButtonIndex);
+	}
+
+	DeviceData.Hats.SetNumZeroed(Slot.HatCount);
+	for (int HatIndex = 0; HatIndex < Slot.HatCount; HatIndex++)
+	{
+		FHatData& HatData = DeviceData.Hats[HatIndex];
+		HatData.Direction = HatDirections[Slot.HatOffset + HatIndex];
+		HatData.PreviousDirection = PreviousHatDirections[Slot.HatOffset + HatIndex];
+	}
+
+	DeviceData.Balls.SetNumZeroed(Slot.BallCount);
+	for (int BallIndex = 0; BallIndex < Slot.BallCount; BallIndex++)
+	{
+		FBallData& BallData = DeviceData.Balls[BallIndex];
+		BallData.Direction = BallDeltas[Slot.BallOffset + BallIndex];
+		BallData.PreviousDirection = PreviousBallDeltas[Slot.BallOffset + BallIndex];
+	}
+}
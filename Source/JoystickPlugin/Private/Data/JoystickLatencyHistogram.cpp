@@ -0,0 +1,97 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Data/JoystickLatencyHistogram.h"
+#include "Data/JoystickInputLatency.h"
+
+std::atomic<bool> JoystickLatency::TrackingEnabled(false);
+
+namespace
+{
+	// Values below SubBucketCount are exact, above it each power of two is split into HalfSubBucketCount buckets
+	constexpr int SubBucketBits = 6;
+	constexpr int SubBucketCount = 1 << SubBucketBits;
+	constexpr int HalfSubBucketCount = SubBucketCount / 2;
+	constexpr int MaxValueBits = 36;
+	constexpr int BucketCount = SubBucketCount + (MaxValueBits - SubBucketBits) * HalfSubBucketCount;
+	constexpr uint64 MaxValue = (uint64(1) << MaxValueBits) - 1;
+}
+
+void FJoystickLatencyHistogram::Record(const double Seconds)
+{
+	if (Counts.Num() == 0)
+	{
+		Counts.SetNumZeroed(BucketCount);
+	}
+
+	const uint64 Microseconds = FMath::Min<uint64>(static_cast<uint64>(FMath::Max(Seconds, 0.0) * 1000000.0), MaxValue);
+	Counts[GetBucketIndex(Microseconds)]++;
+	TotalCount++;
+	TotalMicroseconds += Microseconds;
+	MaxMicroseconds = FMath::Max(MaxMicroseconds, Microseconds);
+}
+
+void FJoystickLatencyHistogram::Reset()
+{
+	Counts.Empty();
+	TotalCount = 0;
+	TotalMicroseconds = 0;
+	MaxMicroseconds = 0;
+}
+
+uint64 FJoystickLatencyHistogram::GetValueAtPercentile(const double Percentile) const
+{
+	if (TotalCount == 0)
+	{
+		return 0;
+	}
+
+	const uint64 Target = FMath::Max<uint64>(static_cast<uint64>(FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 100.0) / 100.0 * TotalCount)), 1);
+
+	uint64 Cumulative = 0;
+	for (int BucketIndex = 0; BucketIndex < Counts.Num(); BucketIndex++)
+	{
+		Cumulative += Counts[BucketIndex];
+		if (Cumulative >= Target)
+		{
+			// The bucket bound can overshoot the largest value actually seen
+			return FMath::Min(GetBucketUpperBound(BucketIndex), MaxMicroseconds);
+		}
+	}
+
+	return MaxMicroseconds;
+}
+
+void FJoystickLatencyHistogram::GetPercentiles(FJoystickLatencyPercentiles& Percentiles) const
+{
+	Percentiles.SampleCount = TotalCount;
+	Percentiles.Mean = TotalCount > 0 ? TotalMicroseconds / 1000.0 / TotalCount : 0.f;
+	Percentiles.P50 = GetValueAtPercentile(50.0) / 1000.f;
+	Percentiles.P95 = GetValueAtPercentile(95.0) / 1000.f;
+	Percentiles.P99 = GetValueAtPercentile(99.0) / 1000.f;
+	Percentiles.Max = MaxMicroseconds / 1000.f;
+}
+
+int FJoystickLatencyHistogram::GetBucketIndex(const uint64 Microseconds)
+{
+	if (Microseconds < SubBucketCount)
+	{
+		return static_cast<int>(Microseconds);
+	}
+
+	// Shift so the value lands in [HalfSubBucketCount, SubBucketCount)
+	const int Shift = FMath::FloorLog2_64(Microseconds) - (SubBucketBits - 1);
+	return SubBucketCount + (Shift - 1) * HalfSubBucketCount + static_cast<int>((Microseconds >> Shift) - HalfSubBucketCount);
+}
+
+uint64 FJoystickLatencyHistogram::GetBucketUpperBound(const int BucketIndex)
+{
+	if (BucketIndex < SubBucketCount)
+	{
+		return BucketIndex;
+	}
+
+	const int Shift = (BucketIndex - SubBucketCount) / HalfSubBucketCount + 1;
+	const uint64 SubBucket = (BucketIndex - SubBucketCount) % HalfSubBucketCount + HalfSubBucketCount;
+	return ((SubBucket + 1) << Shift) - 1;
+}
@@ -4,6 +4,7 @@
 #include "ForceFeedback/Effects/ForceFeedbackEffectBase.h"
 #include "JoystickHapticDeviceManager.h"
 #include "JoystickLogManager.h"
+#include "JoystickStats.h"
 #include "JoystickSubsystem.h"
 #include "Runtime/Launch/Resources/Version.h"
 
@@ -16,6 +17,8 @@ UForceFeedbackEffectBase::UForceFeedbackEffectBase(const FObjectInitializer& Obj
 	  , AutoInitialise(false)
 	  , Iterations(1)
 	  , InfiniteIterations(false)
+	  , Priority(0)
+	  , HasUploadedEffect(false)
 {
 	if (AutoInitialise)
 	{
@@ -30,6 +33,11 @@ void UForceFeedbackEffectBase::BeginDestroy()
 	Super::BeginDestroy();
 }
 
+TStatId UForceFeedbackEffectBase::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UForceFeedbackEffectBase, STATGROUP_Joystick);
+}
+
 void UForceFeedbackEffectBase::Tick(const float DeltaTime)
 {
 	ReceiveTick(DeltaTime);
@@ -49,13 +57,14 @@ void UForceFeedbackEffectBase::InitialiseEffect()
 	}
 
 	CreateEffect();
-	EffectId = HapticDeviceManager->CreateEffect(DeviceId, Effect);
+	EffectId = HapticDeviceManager->CreateEffect(DeviceId, Effect, this, Priority);
 	if (EffectId == -1)
 	{
 		return;
 	}
 
 	IsInitialised = true;
+	RecordUploadedEffect();
 
 	//Safety check to ensure we don't try calling BP during destruction
 #if ENGINE_MAJOR_VERSION < 5
@@ -99,6 +108,7 @@ void UForceFeedbackEffectBase::DestroyEffect()
 
 	IsInitialised = false;
 	EffectId = -1;
+	HasUploadedEffect = false;
 
 	//Safety check to ensure we don't try calling BP during destruction
 #if ENGINE_MAJOR_VERSION < 5
@@ -218,10 +228,19 @@ void UForceFeedbackEffectBase::UpdateEffect()
 	}
 
 	UpdateEffectData();
-	const bool Result = HapticDeviceManager->UpdateEffect(DeviceId, EffectId, Effect);
-	if (Result == false)
+	if (IsEffectUploaded())
 	{
-		return;
+		HapticDeviceManager->RecordSkippedEffectUpdate();
+	}
+	else
+	{
+		const bool Result = HapticDeviceManager->UpdateEffect(DeviceId, EffectId, Effect);
+		if (Result == false)
+		{
+			return;
+		}
+
+		RecordUploadedEffect();
 	}
 
 	//Safety check to ensure we don't try calling BP during destruction
@@ -266,6 +285,54 @@ void UForceFeedbackEffectBase::SetDeviceId(const int NewDeviceId)
 	DeviceId = NewDeviceId;
 }
 
+void UForceFeedbackEffectBase::HandleEffectCreationFailed(const int FailedEffectId)
+{
+	// The effect may have been destroyed and created again since
+	if (!IsInitialised || EffectId != FailedEffectId)
+	{
+		return;
+	}
+
+	FJoystickLogManager::Get()->LogWarning(TEXT("Device %d rejected force feedback effect %s"), DeviceId, *GetName());
+
+	IsInitialised = false;
+	EffectId = -1;
+	HasUploadedEffect = false;
+}
+
+void UForceFeedbackEffectBase::HandleEffectEvicted(const int EvictedEffectId)
+{
+	if (!IsInitialised || EffectId != EvictedEffectId)
+	{
+		return;
+	}
+
+	FJoystickLogManager::Get()->LogDebug(TEXT("Force feedback effect %s on device %d lost its slot to an effect with a higher priority"), *GetName(), DeviceId);
+
+	IsInitialised = false;
+	EffectId = -1;
+	HasUploadedEffect = false;
+
+	//Safety check to ensure we don't try calling BP during destruction
+#if ENGINE_MAJOR_VERSION < 5
+	if (this->IsPendingKillOrUnreachable())
+	{
+		return;
+	}
+#else
+	if (!IsValidChecked(this))
+	{
+		return;
+	}
+#endif
+
+	OnStoppedEffect();
+	if (OnStoppedEffectDelegate.IsBound())
+	{
+		OnStoppedEffectDelegate.Broadcast(this);
+	}
+}
+
 void UForceFeedbackEffectBase::CreateEffect()
 {
 	SDL_memset(&Effect, 0, sizeof(SDL_HapticEffect));
@@ -275,3 +342,51 @@ void UForceFeedbackEffectBase::CreateEffect()
 void UForceFeedbackEffectBase::UpdateEffectData()
 {
 }
+
+bool UForceFeedbackEffectBase::IsEffectUploaded() const
+{
+	if (!HasUploadedEffect)
+	{
+		return false;
+	}
+
+	// Effect is zeroed before its fields are set, so the padding compares equal too
+	if (Effect.type != SDL_HAPTIC_CUSTOM)
+	{
+		return FMemory::Memcmp(&Effect, &UploadedEffect, sizeof(SDL_HapticEffect)) == 0;
+	}
+
+	// Custom effects point at a sample buffer that may be rebuilt on every update, compare the samples instead
+	SDL_HapticEffect Current;
+	FMemory::Memcpy(&Current, &Effect, sizeof(SDL_HapticEffect));
+	Current.custom.data = nullptr;
+	if (FMemory::Memcmp(&Current, &UploadedEffect, sizeof(SDL_HapticEffect)) != 0)
+	{
+		return false;
+	}
+
+	const int SampleCount = Effect.custom.samples * Effect.custom.channels;
+	if (SampleCount != UploadedCustomData.Num())
+	{
+		return false;
+	}
+
+	return SampleCount == 0 || (Effect.custom.data != nullptr && FMemory::Memcmp(Effect.custom.data, UploadedCustomData.GetData(), SampleCount * sizeof(Uint16)) == 0);
+}
+
+void UForceFeedbackEffectBase::RecordUploadedEffect()
+{
+	FMemory::Memcpy(&UploadedEffect, &Effect, sizeof(SDL_HapticEffect));
+	UploadedCustomData.Reset();
+
+	if (Effect.type == SDL_HAPTIC_CUSTOM)
+	{
+		UploadedEffect.custom.data = nullptr;
+		if (Effect.custom.data != nullptr)
+		{
+			UploadedCustomData.Append(Effect.custom.data, Effect.custom.samples * Effect.custom.channels);
+		}
+	}
+
+	HasUploadedEffect = true;
+}
@@ -0,0 +1,265 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickAxisKernel.h"
+#include "JoystickLogManager.h"
+#include "Data/JoystickDeviceStore.h"
+#include "HAL/IConsoleManager.h"
+#include "Math/VectorRegister.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MAJOR_VERSION == 5
+using FJoystickVectorRegister = VectorRegister4Float;
+#else
+using FJoystickVectorRegister = VectorRegister;
+#endif
+
+void JoystickAxisKernel::BuildRemap(const FJoystickAxisConfig& Config, float& InputScale, float& InputBias, float& OutputScale, float& OutputBias)
+{
+	if (!Config.RemappingEnabled)
+	{
+		// Identity over the [-1, 1] range SDL reports
+		InputScale = 0.5f;
+		InputBias = 0.5f;
+		OutputScale = 2.f;
+		OutputBias = -1.f;
+		return;
+	}
+
+	const float InputSign = Config.InvertInput ? -1.f : 1.f;
+	const float InputRange = Config.InputRangeMax - Config.InputRangeMin;
+	if (FMath::IsNearlyZero(InputRange))
+	{
+		// An empty input range steps from the minimum to the maximum output at the range value
+		constexpr float StepScale = 1.e20f;
+		InputScale = InputSign * StepScale;
+		InputBias = (Config.InputOffset - Config.InputRangeMax) * StepScale + 1.f;
+	}
+	else
+	{
+		InputScale = InputSign / InputRange;
+		InputBias = (Config.InputOffset - Config.InputRangeMin) / InputRange;
+	}
+
+	const float OutputSign = Config.InvertOutput ? -1.f : 1.f;
+	OutputScale = (Config.OutputRangeMax - Config.OutputRangeMin) * OutputSign;
+	OutputBias = Config.OutputRangeMin * OutputSign;
+}
+
+namespace
+{
+	float EvaluateCurvePoints(const TArray<FVector2D>& CurvePoints, const float Deflection)
+	{
+		if (CurvePoints.Num() == 0)
+		{
+			return Deflection;
+		}
+
+		if (Deflection <= CurvePoints[0].X)
+		{
+			return CurvePoints[0].Y;
+		}
+
+		for (int Index = 1; Index < CurvePoints.Num(); Index++)
+		{
+			const FVector2D& Start = CurvePoints[Index - 1];
+			const FVector2D& End = CurvePoints[Index];
+			if (Deflection <= End.X)
+			{
+				const float Span = End.X - Start.X;
+				const float Alpha = Span > KINDA_SMALL_NUMBER ? (Deflection - Start.X) / Span : 1.f;
+				return FMath::Lerp(static_cast<float>(Start.Y), static_cast<float>(End.Y), Alpha);
+			}
+		}
+
+		return CurvePoints.Last().Y;
+	}
+}
+
+void JoystickAxisKernel::BakeResponseTable(const FJoystickAxisConfig& Config, float* Table)
+{
+	const float InnerDeadzone = FMath::Clamp(Config.InnerDeadzone, 0.f, 1.f);
+	const float LiveRange = 1.f - InnerDeadzone - FMath::Clamp(Config.OuterDeadzone, 0.f, 1.f);
+	const float Exponent = FMath::Max(Config.CurveExponent, 0.01f);
+
+	for (int Index = 0; Index < ResponseTableSize; Index++)
+	{
+		const float Deflection = static_cast<float>(Index) / (ResponseTableSize - 1);
+		const float LiveDeflection = LiveRange > KINDA_SMALL_NUMBER
+			                             ? FMath::Clamp((Deflection - InnerDeadzone) / LiveRange, 0.f, 1.f)
+			                             : (Deflection > InnerDeadzone ? 1.f : 0.f);
+
+		float Response = LiveDeflection;
+		switch (Config.ResponseCurve)
+		{
+			case EJoystickAxisResponseCurve::Exponential:
+				Response = FMath::Pow(LiveDeflection, Exponent);
+				break;
+			case EJoystickAxisResponseCurve::SCurve:
+			{
+				const float Rising = FMath::Pow(LiveDeflection, Exponent);
+				const float Falling = FMath::Pow(1.f - LiveDeflection, Exponent);
+				Response = Rising + Falling > 0.f ? Rising / (Rising + Falling) : LiveDeflection;
+				break;
+			}
+			case EJoystickAxisResponseCurve::Custom:
+				Response = EvaluateCurvePoints(Config.CurvePoints, LiveDeflection);
+				break;
+			default:
+				break;
+		}
+
+		Table[Index] = FMath::Clamp(Response, 0.f, 1.f);
+	}
+}
+
+void JoystickAxisKernel::ApplyRadialResponse(const float* Table, float& RangePctX, float& RangePctY)
+{
+	const float X = RangePctX * 2.f - 1.f;
+	const float Y = RangePctY * 2.f - 1.f;
+	const float Length = FMath::Sqrt(X * X + Y * Y);
+	if (Length <= KINDA_SMALL_NUMBER)
+	{
+		RangePctX = 0.5f;
+		RangePctY = 0.5f;
+		return;
+	}
+
+	const float Scale = EvaluateResponseTable(Table, FMath::Min(Length, 1.f)) / Length;
+	RangePctX = FMath::Clamp(X * Scale, -1.f, 1.f) * 0.5f + 0.5f;
+	RangePctY = FMath::Clamp(Y * Scale, -1.f, 1.f) * 0.5f + 0.5f;
+}
+
+void JoystickAxisKernel::RemapAxes(const float* Input, const float* InputScale, const float* InputBias, const float* OutputScale, const float* OutputBias, float* Output, const int Count)
+{
+	const FJoystickVectorRegister Zero = VectorSetFloat1(0.f);
+	const FJoystickVectorRegister One = VectorSetFloat1(1.f);
+
+	int Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		FJoystickVectorRegister RangePct = VectorMultiplyAdd(VectorLoad(Input + Index), VectorLoad(InputScale + Index), VectorLoad(InputBias + Index));
+		RangePct = VectorMin(VectorMax(RangePct, Zero), One);
+		VectorStore(VectorMultiplyAdd(RangePct, VectorLoad(OutputScale + Index), VectorLoad(OutputBias + Index)), Output + Index);
+	}
+
+	for (; Index < Count; Index++)
+	{
+		Output[Index] = RemapAxis(Input[Index], InputScale[Index], InputBias[Index], OutputScale[Index], OutputBias[Index]);
+	}
+}
+
+void JoystickAxisKernel::NormalizeAxes(const float* Input, const float* InputScale, const float* InputBias, float* Output, const int Count)
+{
+	const FJoystickVectorRegister Zero = VectorSetFloat1(0.f);
+	const FJoystickVectorRegister One = VectorSetFloat1(1.f);
+
+	int Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		const FJoystickVectorRegister RangePct = VectorMultiplyAdd(VectorLoad(Input + Index), VectorLoad(InputScale + Index), VectorLoad(InputBias + Index));
+		VectorStore(VectorMin(VectorMax(RangePct, Zero), One), Output + Index);
+	}
+
+	for (; Index < Count; Index++)
+	{
+		Output[Index] = NormalizeAxis(Input[Index], InputScale[Index], InputBias[Index]);
+	}
+}
+
+void JoystickAxisKernel::ScaleAxes(float* Values, const float* OutputScale, const float* OutputBias, const int Count)
+{
+	int Index = 0;
+	for (; Index + 4 <= Count; Index += 4)
+	{
+		VectorStore(VectorMultiplyAdd(VectorLoad(Values + Index), VectorLoad(OutputScale + Index), VectorLoad(OutputBias + Index)), Values + Index);
+	}
+
+	for (; Index < Count; Index++)
+	{
+		Values[Index] = ScaleAxis(Values[Index], OutputScale[Index], OutputBias[Index]);
+	}
+}
+
+namespace
+{
+	/* The per-axis remap the kernel replaced, kept as the benchmark's reference */
+	float MapAxisValue(const FJoystickAxisConfig& Config, const float Input)
+	{
+		const float NormalizedValue = (Config.InvertInput ? (Input * -1.0f) : Input);
+		const float OffsetNormalizedValue = NormalizedValue + Config.InputOffset;
+		const float MappedValue = FMath::GetMappedRangeValueClamped(FVector2D(Config.InputRangeMin, Config.InputRangeMax), FVector2D(Config.OutputRangeMin, Config.OutputRangeMax), OffsetNormalizedValue);
+		return Config.InvertOutput ? (MappedValue * -1.0f) : MappedValue;
+	}
+
+	void BenchmarkAxisRemap(const int AxisCount)
+	{
+		constexpr int Iterations = 10000;
+
+		TArray<FJoystickAxisConfig> Configs;
+		TArray<float> Values, InputScale, InputBias, OutputScale, OutputBias, Output;
+		Configs.SetNum(AxisCount);
+		Values.SetNum(AxisCount);
+		InputScale.SetNum(AxisCount);
+		InputBias.SetNum(AxisCount);
+		OutputScale.SetNum(AxisCount);
+		OutputBias.SetNum(AxisCount);
+		Output.SetNum(AxisCount);
+
+		for (int Index = 0; Index < AxisCount; Index++)
+		{
+			FJoystickAxisConfig& Config = Configs[Index];
+			Config.RemappingEnabled = true;
+			Config.InvertInput = (Index & 1) != 0;
+			Config.InputOffset = 0.1f;
+			Config.InputRangeMin = -1.f;
+			Config.InputRangeMax = 1.f;
+			Config.OutputRangeMin = 0.f;
+			Config.OutputRangeMax = 1.f;
+			Config.InvertOutput = (Index & 2) != 0;
+			JoystickAxisKernel::BuildRemap(Config, InputScale[Index], InputBias[Index], OutputScale[Index], OutputBias[Index]);
+
+			Values[Index] = FMath::Sin(Index * 0.37f);
+		}
+
+		float Checksum = 0.f;
+		const double ScalarStart = FPlatformTime::Seconds();
+		for (int Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			for (int Index = 0; Index < AxisCount; Index++)
+			{
+				Output[Index] = MapAxisValue(Configs[Index], Values[Index]);
+			}
+			Checksum += Output[Iteration % AxisCount];
+		}
+		const double ScalarTime = FPlatformTime::Seconds() - ScalarStart;
+
+		const double BatchStart = FPlatformTime::Seconds();
+		for (int Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			JoystickAxisKernel::RemapAxes(Values.GetData(), InputScale.GetData(), InputBias.GetData(), OutputScale.GetData(), OutputBias.GetData(), Output.GetData(), AxisCount);
+			Checksum += Output[Iteration % AxisCount];
+		}
+		const double BatchTime = FPlatformTime::Seconds() - BatchStart;
+
+		float MaxError = 0.f;
+		for (int Index = 0; Index < AxisCount; Index++)
+		{
+			MaxError = FMath::Max(MaxError, FMath::Abs(Output[Index] - MapAxisValue(Configs[Index], Values[Index])));
+		}
+
+		const double AxisSamples = static_cast<double>(Iterations) * AxisCount;
+		FJoystickLogManager::Get()->LogInformation(TEXT("Axis remap %d axes: per-axis %.2f ns/axis, batch %.2f ns/axis (%.1fx), max error %g, checksum %g"),
+		                                           AxisCount, ScalarTime * 1.e9 / AxisSamples, BatchTime * 1.e9 / AxisSamples, ScalarTime / FMath::Max(BatchTime, 1.e-9), MaxError, Checksum);
+	}
+
+	FAutoConsoleCommand BenchmarkAxisRemapCommand(
+		TEXT("Joystick.BenchmarkAxisRemap"),
+		TEXT("Compares the per-axis remap path with the batch kernel at 8, 64 and 512 axes."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			BenchmarkAxisRemap(8);
+			BenchmarkAxisRemap(64);
+			BenchmarkAxisRemap(512);
+		}));
+}
@@ -0,0 +1,64 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+struct FJoystickAxisConfig;
+
+/**
+ * Axis remapping in scale/bias form: Output = Response(Clamp(Input * InputScale + InputBias, 0, 1)) * OutputScale + OutputBias.
+ * Inversion, offset and both ranges are folded into the four parameters, and deadzones and curves into a lookup table,
+ * when the axis properties change. The per-frame path is two multiply-adds and a clamp which run four axes at a time,
+ * plus a table lookup for the axes that have a response.
+ */
+namespace JoystickAxisKernel
+{
+	constexpr int ResponseTableSize = 1024;
+
+	void BuildRemap(const FJoystickAxisConfig& Config, float& InputScale, float& InputBias, float& OutputScale, float& OutputBias);
+
+	/* Bakes the deadzones and curve of an axis into ResponseTableSize entries covering a deflection of 0 to 1 */
+	void BakeResponseTable(const FJoystickAxisConfig& Config, float* Table);
+
+	FORCEINLINE float NormalizeAxis(const float Input, const float InputScale, const float InputBias)
+	{
+		return FMath::Clamp(Input * InputScale + InputBias, 0.f, 1.f);
+	}
+
+	FORCEINLINE float ScaleAxis(const float RangePct, const float OutputScale, const float OutputBias)
+	{
+		return RangePct * OutputScale + OutputBias;
+	}
+
+	FORCEINLINE float RemapAxis(const float Input, const float InputScale, const float InputBias, const float OutputScale, const float OutputBias)
+	{
+		return ScaleAxis(NormalizeAxis(Input, InputScale, InputBias), OutputScale, OutputBias);
+	}
+
+	FORCEINLINE float EvaluateResponseTable(const float* Table, const float Deflection)
+	{
+		const float Position = FMath::Clamp(Deflection, 0.f, 1.f) * (ResponseTableSize - 1);
+		const int Index = FMath::Min(static_cast<int>(Position), ResponseTableSize - 2);
+		return FMath::Lerp(Table[Index], Table[Index + 1], Position - Index);
+	}
+
+	/* Shapes a range percentage, measuring the deflection from the centre of the range when Centered */
+	FORCEINLINE float ApplyResponse(const float* Table, const float RangePct, const bool Centered)
+	{
+		if (!Centered)
+		{
+			return EvaluateResponseTable(Table, RangePct);
+		}
+
+		const float Deflection = RangePct * 2.f - 1.f;
+		const float Response = EvaluateResponseTable(Table, FMath::Abs(Deflection));
+		return (Deflection < 0.f ? -Response : Response) * 0.5f + 0.5f;
+	}
+
+	/* Shapes the length of a centred X/Y pair, keeping its direction */
+	void ApplyRadialResponse(const float* Table, float& RangePctX, float& RangePctY);
+
+	void RemapAxes(const float* Input, const float* InputScale, const float* InputBias, const float* OutputScale, const float* OutputBias, float* Output, const int Count);
+	void NormalizeAxes(const float* Input, const float* InputScale, const float* InputBias, float* Output, const int Count);
+	void ScaleAxes(float* Values, const float* OutputScale, const float* OutputBias, const int Count);
+}
@@ -0,0 +1,242 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickDeviceCache.h"
+#include "JoystickLogManager.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 CacheMagic = 0x4A594443; // JYDC
+	constexpr uint32 CacheVersion = 2;
+
+	// Devices are forgotten after this long unseen, or once there are more than MaxCachedDevices newer ones
+	constexpr int32 MaxUnseenDays = 90;
+	constexpr int32 MaxCachedDevices = 32;
+}
+
+FArchive& operator<<(FArchive& Ar, FJoystickCachedKey& Key)
+{
+	uint8 Type = static_cast<uint8>(Key.Type);
+
+	Ar << Key.Name;
+	Ar << Key.DisplayName;
+	Ar << Key.Flags;
+	Ar << Type;
+	Ar << Key.Index;
+	Ar << Key.Component;
+
+	Key.Type = static_cast<EJoystickInputEventType>(Type);
+	return Ar;
+}
+
+FArchive& operator<<(FArchive& Ar, FJoystickCachedDevice& Device)
+{
+	Ar << Device.ProductId;
+	Ar << Device.DeviceName;
+	Ar << Device.DeviceId;
+	Ar << Device.IsGamepad;
+	Ar << Device.HasRumble;
+	Ar << Device.AxisCount;
+	Ar << Device.ButtonCount;
+	Ar << Device.HatCount;
+	Ar << Device.BallCount;
+	Ar << Device.BaseKeyName;
+	Ar << Device.BaseDisplayName;
+	Ar << Device.Keys;
+	Ar << Device.LastSeen;
+	return Ar;
+}
+
+FJoystickDeviceCache::FJoystickDeviceCache(const FString& InPath)
+	: Path(InPath)
+	  , IsDirty(false)
+{
+}
+
+FString FJoystickDeviceCache::GetDefaultPath()
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Joystick"), TEXT("DeviceCache.bin"));
+}
+
+bool FJoystickDeviceCache::Load()
+{
+	Devices.Reset();
+	IsDirty = false;
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Path, FILEREAD_Silent))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic;
+	Reader << Version;
+	if (Magic != CacheMagic || Version != CacheVersion)
+	{
+		FJoystickLogManager::Get()->LogInformation(TEXT("Ignoring device cache %s, it was written by another version"), *Path);
+		return false;
+	}
+
+	Reader << Devices;
+	if (Reader.IsError())
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Ignoring device cache %s, it is corrupt"), *Path);
+		Devices.Reset();
+		return false;
+	}
+
+	Prune();
+
+	FJoystickLogManager::Get()->LogDebug(TEXT("Loaded %d cached devices from %s"), Devices.Num(), *Path);
+	return true;
+}
+
+bool FJoystickDeviceCache::Save()
+{
+	if (!IsDirty)
+	{
+		return true;
+	}
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = CacheMagic;
+	uint32 Version = CacheVersion;
+	Writer << Magic;
+	Writer << Version;
+	Writer << Devices;
+
+	if (!FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to write the device cache to %s"), *Path);
+		return false;
+	}
+
+	IsDirty = false;
+	return true;
+}
+
+const TArray<FJoystickCachedDevice>& FJoystickDeviceCache::GetDevices() const
+{
+	return Devices;
+}
+
+FJoystickCachedDevice* FJoystickDeviceCache::Find(const FGuid& ProductId, const FString& DeviceName, const int PreferredDeviceId)
+{
+	FJoystickCachedDevice* Found = nullptr;
+	for (FJoystickCachedDevice& CachedDevice : Devices)
+	{
+		if (CachedDevice.ProductId != ProductId || CachedDevice.DeviceName != DeviceName)
+		{
+			continue;
+		}
+
+		// Ids are unique within a session, an attached entry with the device's own id is the device coming back
+		if (CachedDevice.IsAttached)
+		{
+			if (PreferredDeviceId != -1 && CachedDevice.DeviceId == PreferredDeviceId)
+			{
+				return &CachedDevice;
+			}
+
+			continue;
+		}
+
+		// Identical devices share a GUID and name, the id tells them apart when it is known
+		if (PreferredDeviceId == -1 || CachedDevice.DeviceId == PreferredDeviceId)
+		{
+			return &CachedDevice;
+		}
+
+		if (Found == nullptr)
+		{
+			Found = &CachedDevice;
+		}
+	}
+
+	return Found;
+}
+
+bool FJoystickDeviceCache::IsDeviceIdReserved(const int DeviceId) const
+{
+	return Devices.ContainsByPredicate([DeviceId](const FJoystickCachedDevice& CachedDevice)
+	{
+		return !CachedDevice.IsAttached && CachedDevice.DeviceId == DeviceId;
+	});
+}
+
+FJoystickCachedDevice& FJoystickDeviceCache::Store(const FDeviceInfoSDL& Device, const FString& BaseKeyName, const FString& BaseDisplayName, TArray<FJoystickCachedKey>&& Keys)
+{
+	FJoystickCachedDevice* CachedDevice = Find(Device.ProductId, Device.DeviceName, Device.DeviceId);
+	if (CachedDevice == nullptr)
+	{
+		CachedDevice = &Devices.AddDefaulted_GetRef();
+	}
+
+	// Another cached device may have had this id, it gets a fresh one the next time it attaches
+	for (FJoystickCachedDevice& OtherDevice : Devices)
+	{
+		if (&OtherDevice != CachedDevice && !OtherDevice.IsAttached && OtherDevice.DeviceId == Device.DeviceId)
+		{
+			OtherDevice.DeviceId = -1;
+		}
+	}
+
+	CachedDevice->ProductId = Device.ProductId;
+	CachedDevice->DeviceName = Device.DeviceName;
+	CachedDevice->DeviceId = Device.DeviceId;
+	CachedDevice->IsGamepad = Device.IsGamepad;
+	CachedDevice->HasRumble = Device.HasRumble;
+	CachedDevice->AxisCount = Device.AxisCount;
+	CachedDevice->ButtonCount = Device.ButtonCount;
+	CachedDevice->HatCount = Device.HatCount;
+	CachedDevice->BallCount = Device.BallCount;
+	CachedDevice->BaseKeyName = BaseKeyName;
+	CachedDevice->BaseDisplayName = BaseDisplayName;
+	CachedDevice->Keys = MoveTemp(Keys);
+	CachedDevice->LastSeen = FDateTime::UtcNow().GetTicks();
+	CachedDevice->IsAttached = true;
+
+	IsDirty = true;
+	return *CachedDevice;
+}
+
+void FJoystickDeviceCache::MarkAttached(FJoystickCachedDevice& CachedDevice)
+{
+	CachedDevice.IsAttached = true;
+	CachedDevice.LastSeen = FDateTime::UtcNow().GetTicks();
+	IsDirty = true;
+}
+
+void FJoystickDeviceCache::Prune()
+{
+	const int32 DeviceCount = Devices.Num();
+	const int64 OldestAllowed = (FDateTime::UtcNow() - FTimespan::FromDays(MaxUnseenDays)).GetTicks();
+	Devices.RemoveAll([OldestAllowed](const FJoystickCachedDevice& CachedDevice)
+	{
+		return CachedDevice.LastSeen < OldestAllowed;
+	});
+
+	if (Devices.Num() > MaxCachedDevices)
+	{
+		Devices.Sort([](const FJoystickCachedDevice& A, const FJoystickCachedDevice& B) { return A.LastSeen > B.LastSeen; });
+		Devices.SetNum(MaxCachedDevices);
+	}
+
+	if (Devices.Num() != DeviceCount)
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("Dropped %d devices not seen recently from the device cache"), DeviceCount - Devices.Num());
+		IsDirty = true;
+	}
+}
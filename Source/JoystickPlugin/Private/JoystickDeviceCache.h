@@ -0,0 +1,94 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/JoystickInputEvent.h"
+
+struct FDeviceInfoSDL;
+
+/* A key generated for a device, enough to register it again without rebuilding its name */
+struct FJoystickCachedKey
+{
+	FString Name;
+	FString DisplayName;
+	uint32 Flags = 0;
+
+	EJoystickInputEventType Type = EJoystickInputEventType::Axis;
+	uint16 Index = 0;
+	uint8 Component = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FJoystickCachedKey& Key);
+};
+
+/* What a device looked like the last time it was attached */
+struct FJoystickCachedDevice
+{
+	FGuid ProductId;
+	FString DeviceName;
+	int DeviceId = -1;
+
+	bool IsGamepad = false;
+	bool HasRumble = false;
+
+	int AxisCount = 0;
+	int ButtonCount = 0;
+	int HatCount = 0;
+	int BallCount = 0;
+
+	/* Key names depend on the naming settings, cached keys are only reused while these still match */
+	FString BaseKeyName;
+	FString BaseDisplayName;
+
+	TArray<FJoystickCachedKey> Keys;
+
+	/* UTC ticks of the last time the device was attached, devices unseen for long are dropped */
+	int64 LastSeen = 0;
+
+	/* Not saved, set once the device has been attached this session */
+	bool IsAttached = false;
+
+	friend FArchive& operator<<(FArchive& Ar, FJoystickCachedDevice& Device);
+};
+
+/**
+ * Devices seen on previous runs, keyed by product GUID and name. At startup their keys are registered in one pass
+ * before any device is opened, and each device keeps its device id across runs. Once a device is actually opened its
+ * counts and key names are checked against the cache and the entry is refreshed when they differ.
+ *
+ * Devices not attached for a long time are dropped on load, and only the most recently seen are kept, so their ids
+ * do not stay reserved forever.
+ */
+class FJoystickDeviceCache
+{
+public:
+	explicit FJoystickDeviceCache(const FString& InPath);
+
+	static FString GetDefaultPath();
+
+	bool Load();
+
+	/* Writes the cache if anything changed since it was loaded */
+	bool Save();
+
+	const TArray<FJoystickCachedDevice>& GetDevices() const;
+
+	/* The entry for a device not attached yet this session, preferring the one that had PreferredDeviceId. An entry
+	 * already attached this session is only found by its own id, when the device is plugged in again. */
+	FJoystickCachedDevice* Find(const FGuid& ProductId, const FString& DeviceName, const int PreferredDeviceId = -1);
+
+	/* True when a cached device that has not been attached yet owns the id */
+	bool IsDeviceIdReserved(const int DeviceId) const;
+
+	/* Creates or refreshes the entry for an attached device and marks it attached */
+	FJoystickCachedDevice& Store(const FDeviceInfoSDL& Device, const FString& BaseKeyName, const FString& BaseDisplayName, TArray<FJoystickCachedKey>&& Keys);
+	void MarkAttached(FJoystickCachedDevice& CachedDevice);
+
+private:
+	void Prune();
+
+	FString Path;
+	TArray<FJoystickCachedDevice> Devices;
+	bool IsDirty;
+};
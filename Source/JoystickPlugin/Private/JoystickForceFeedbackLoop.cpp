@@ -0,0 +1,411 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickForceFeedbackLoop.h"
+#include "JoystickHapticThread.h"
+#include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Interfaces/JoystickBackend.h"
+
+namespace
+{
+	// Targets further apart than this are treated as a new stream of targets rather than interpolated
+	constexpr double MaxInterpolationSpan = 0.1;
+}
+
+FJoystickForceFeedbackLoop::FJoystickForceFeedbackLoop(const int InRate, FJoystickHapticThread* InHapticThread)
+	: StepInterval(1.0 / FMath::Max(InRate, 1))
+	  , HapticThread(InHapticThread)
+	  , WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	  , Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, TEXT("JoystickForceFeedbackLoop"), 0, TPri_AboveNormal);
+	if (Thread == nullptr)
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to create the joystick force feedback loop."));
+	}
+}
+
+FJoystickForceFeedbackLoop::~FJoystickForceFeedbackLoop()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	TArray<FStreamPtr> RemovedStreams;
+	{
+		FScopeLock Lock(&StreamsLock);
+		Streams.GenerateValueArray(RemovedStreams);
+		Streams.Empty();
+	}
+
+	for (const FStreamPtr& Stream : RemovedStreams)
+	{
+		DestroyStream(Stream);
+	}
+
+	// Queued tasks reference the loop
+	if (HapticThread != nullptr)
+	{
+		HapticThread->Flush();
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+bool FJoystickForceFeedbackLoop::StartStream(IJoystickBackend& Backend, const int DeviceId)
+{
+	if (IsStreaming(DeviceId))
+	{
+		return true;
+	}
+
+	const FStreamPtr Stream = MakeShared<FStream, ESPMode::ThreadSafe>();
+	Stream->Backend = &Backend;
+	Stream->DeviceId = DeviceId;
+
+	SDL_memset(&Stream->Effect, 0, sizeof(SDL_HapticEffect));
+	Stream->Effect.type = SDL_HAPTIC_CONSTANT;
+	Stream->Effect.constant.direction.type = SDL_HAPTIC_CARTESIAN;
+	Stream->Effect.constant.direction.dir[0] = 1;
+	Stream->Effect.constant.length = SDL_HAPTIC_INFINITY;
+
+	{
+		FScopeLock Lock(&StreamsLock);
+		Streams.Add(DeviceId, Stream);
+	}
+
+	RunHapticTask(Backend, [this, Stream]() { CreateStreamEffect(Stream); });
+
+	WakeEvent->Trigger();
+	return true;
+}
+
+void FJoystickForceFeedbackLoop::StopStream(const int DeviceId)
+{
+	FStreamPtr Stream;
+	{
+		FScopeLock Lock(&StreamsLock);
+		if (!Streams.RemoveAndCopyValue(DeviceId, Stream))
+		{
+			return;
+		}
+	}
+
+	DestroyStream(Stream);
+}
+
+bool FJoystickForceFeedbackLoop::IsStreaming(const int DeviceId) const
+{
+	FScopeLock Lock(&StreamsLock);
+	return Streams.Contains(DeviceId);
+}
+
+void FJoystickForceFeedbackLoop::SetTarget(const int DeviceId, const float Force)
+{
+	const FStreamPtr Stream = FindStream(DeviceId);
+	if (!Stream.IsValid())
+	{
+		return;
+	}
+
+	const float ClampedForce = FMath::Clamp(Force, -1.f, 1.f);
+	uint32 ForceBits;
+	FMemory::Memcpy(&ForceBits, &ClampedForce, sizeof(float));
+
+	uint64 Current = Stream->Target.load(std::memory_order_relaxed);
+	uint64 Next;
+	do
+	{
+		const uint32 Sequence = static_cast<uint32>(Current >> 32) + 1;
+		Next = static_cast<uint64>(Sequence) << 32 | ForceBits;
+	}
+	while (!Stream->Target.compare_exchange_weak(Current, Next, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void FJoystickForceFeedbackLoop::SetCallback(const int DeviceId, FJoystickForceCallback&& Callback)
+{
+	const FStreamPtr Stream = FindStream(DeviceId);
+	if (!Stream.IsValid())
+	{
+		return;
+	}
+
+	TSharedPtr<FJoystickForceCallback, ESPMode::ThreadSafe> NewCallback;
+	if (Callback)
+	{
+		NewCallback = MakeShared<FJoystickForceCallback, ESPMode::ThreadSafe>(MoveTemp(Callback));
+	}
+
+	// Only held to swap the pointer, the loop calls the callback outside of it
+	FScopeLock Lock(&Stream->CallbackLock);
+	Stream->Callback = MoveTemp(NewCallback);
+}
+
+void FJoystickForceFeedbackLoop::SetSlewRate(const int DeviceId, const float SlewRate)
+{
+	const FStreamPtr Stream = FindStream(DeviceId);
+	if (!Stream.IsValid())
+	{
+		return;
+	}
+
+	Stream->SlewRate.store(FMath::Max(SlewRate, 0.f), std::memory_order_relaxed);
+}
+
+void FJoystickForceFeedbackLoop::SetInterpolation(const int DeviceId, const bool Interpolate)
+{
+	const FStreamPtr Stream = FindStream(DeviceId);
+	if (!Stream.IsValid())
+	{
+		return;
+	}
+
+	Stream->Interpolate.store(Interpolate, std::memory_order_relaxed);
+}
+
+void FJoystickForceFeedbackLoop::RestartStream(const int DeviceId)
+{
+	const FStreamPtr Stream = FindStream(DeviceId);
+	if (!Stream.IsValid())
+	{
+		return;
+	}
+
+	Stream->RestartRequested.store(true, std::memory_order_release);
+}
+
+void FJoystickForceFeedbackLoop::RemoveBackend(const IJoystickBackend& Backend)
+{
+	TArray<FStreamPtr> RemovedStreams;
+	{
+		FScopeLock Lock(&StreamsLock);
+		for (auto It = Streams.CreateIterator(); It; ++It)
+		{
+			if (It.Value()->Backend == &Backend)
+			{
+				RemovedStreams.Add(It.Value());
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	for (const FStreamPtr& Stream : RemovedStreams)
+	{
+		DestroyStream(Stream);
+	}
+}
+
+uint32 FJoystickForceFeedbackLoop::Run()
+{
+	TArray<FStreamPtr> ActiveStreams;
+	double LastStep = FPlatformTime::Seconds();
+
+	while (!StopRequested)
+	{
+		{
+			FScopeLock Lock(&StreamsLock);
+			Streams.GenerateValueArray(ActiveStreams);
+		}
+
+		// Nothing to stream, sleep until a stream starts
+		if (ActiveStreams.Num() == 0)
+		{
+			WakeEvent->Wait();
+			LastStep = FPlatformTime::Seconds();
+			continue;
+		}
+
+		const double StepStart = FPlatformTime::Seconds();
+		const double DeltaTime = StepStart - LastStep;
+		LastStep = StepStart;
+
+		{
+			JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickForceFeedbackLoop);
+			for (const FStreamPtr& Stream : ActiveStreams)
+			{
+				if (!Stream->IsStopped.load(std::memory_order_acquire))
+				{
+					Step(*Stream, StepStart, DeltaTime);
+				}
+			}
+		}
+
+		ActiveStreams.Reset();
+
+		const double Remaining = StepInterval - (FPlatformTime::Seconds() - StepStart);
+		if (Remaining > 0.0)
+		{
+			FPlatformProcess::SleepNoStats(Remaining);
+		}
+	}
+
+	return 0;
+}
+
+void FJoystickForceFeedbackLoop::Stop()
+{
+	StopRequested = true;
+	WakeEvent->Trigger();
+}
+
+FJoystickForceFeedbackLoop::FStreamPtr FJoystickForceFeedbackLoop::FindStream(const int DeviceId) const
+{
+	FScopeLock Lock(&StreamsLock);
+	const FStreamPtr* Stream = Streams.Find(DeviceId);
+	return Stream != nullptr ? *Stream : FStreamPtr();
+}
+
+void FJoystickForceFeedbackLoop::Step(FStream& Stream, const double Now, const double DeltaTime) const
+{
+	float Force = GetDesiredForce(Stream, Now);
+	const float SlewRate = Stream.SlewRate.load(std::memory_order_relaxed);
+	if (SlewRate > 0.f)
+	{
+		const float MaxChange = SlewRate * static_cast<float>(DeltaTime);
+		Force = Stream.Output + FMath::Clamp(Force - Stream.Output, -MaxChange, MaxChange);
+	}
+	Stream.Output = Force;
+
+	const Sint16 Level = static_cast<Sint16>(FMath::Clamp(FMath::RoundToInt(Force * 0x7FFF), -0x7FFF, 0x7FFF));
+
+	FScopeLock Lock(&Stream.UploadLock);
+	if (Stream.EffectId == -1)
+	{
+		return;
+	}
+
+	if (Stream.RestartRequested.exchange(false, std::memory_order_acquire))
+	{
+		Stream.Backend->RunEffect(Stream.DeviceId, Stream.EffectId, SDL_HAPTIC_INFINITY);
+	}
+
+	if (Level == Stream.Effect.constant.level)
+	{
+		return;
+	}
+
+	Stream.Effect.constant.level = Level;
+	Stream.Backend->UpdateEffect(Stream.DeviceId, Stream.EffectId, Stream.Effect);
+}
+
+float FJoystickForceFeedbackLoop::GetDesiredForce(FStream& Stream, const double Now) const
+{
+	TSharedPtr<FJoystickForceCallback, ESPMode::ThreadSafe> Callback;
+	{
+		FScopeLock Lock(&Stream.CallbackLock);
+		Callback = Stream.Callback;
+	}
+
+	if (Callback.IsValid())
+	{
+		return FMath::Clamp((*Callback)(Now), -1.f, 1.f);
+	}
+
+	// Where the interpolation currently is between the two latest targets
+	const bool Interpolate = Stream.Interpolate.load(std::memory_order_relaxed);
+	const double Span = Stream.LatestTargetTime - Stream.PreviousTargetTime;
+	const bool CanInterpolate = Interpolate && Span > 0.0 && Span <= MaxInterpolationSpan;
+	const float Alpha = CanInterpolate ? FMath::Clamp(static_cast<float>((Now - Stream.LatestTargetTime) / Span), 0.f, 1.f) : 1.f;
+	const float Current = FMath::Lerp(Stream.PreviousTarget, Stream.LatestTarget, Alpha);
+
+	const uint64 Target = Stream.Target.load(std::memory_order_acquire);
+	const uint32 Sequence = static_cast<uint32>(Target >> 32);
+	if (Sequence == Stream.LastSequence)
+	{
+		return Current;
+	}
+
+	const uint32 ForceBits = static_cast<uint32>(Target);
+	float Force;
+	FMemory::Memcpy(&Force, &ForceBits, sizeof(float));
+
+	// A new target starts from wherever the last one had got to, so it never jumps
+	Stream.LastSequence = Sequence;
+	Stream.PreviousTarget = Current;
+	Stream.PreviousTargetTime = Stream.LatestTargetTime;
+	Stream.LatestTarget = Force;
+	Stream.LatestTargetTime = Now;
+
+	return Interpolate && Now - Stream.PreviousTargetTime <= MaxInterpolationSpan ? Current : Force;
+}
+
+void FJoystickForceFeedbackLoop::CreateStreamEffect(const FStreamPtr& Stream)
+{
+	// Runs before the stream's destruction, which is queued behind it, so the stream cannot be stopped part way
+	if (Stream->IsStopped.load(std::memory_order_acquire))
+	{
+		return;
+	}
+
+	// The loop leaves Effect alone until EffectId is set
+	const int EffectId = Stream->Backend->CreateEffect(Stream->DeviceId, Stream->Effect);
+	if (EffectId == -1)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to create the force stream's effect on device %d"), Stream->DeviceId);
+	}
+	else if (!Stream->Backend->RunEffect(Stream->DeviceId, EffectId, SDL_HAPTIC_INFINITY))
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to start the force stream's effect on device %d"), Stream->DeviceId);
+		Stream->Backend->DestroyEffect(Stream->DeviceId, EffectId);
+	}
+	else
+	{
+		FScopeLock Lock(&Stream->UploadLock);
+		Stream->EffectId = EffectId;
+		return;
+	}
+
+	FScopeLock Lock(&StreamsLock);
+	const FStreamPtr* CurrentStream = Streams.Find(Stream->DeviceId);
+	if (CurrentStream != nullptr && *CurrentStream == Stream)
+	{
+		Streams.Remove(Stream->DeviceId);
+	}
+}
+
+void FJoystickForceFeedbackLoop::DestroyStream(const FStreamPtr& Stream) const
+{
+	if (Stream->IsStopped.exchange(true, std::memory_order_acq_rel))
+	{
+		return;
+	}
+
+	RunHapticTask(*Stream->Backend, [Stream]()
+	{
+		// Waits for a write the loop may be in the middle of, the effect id is not used again after this
+		int EffectId;
+		{
+			FScopeLock Lock(&Stream->UploadLock);
+			EffectId = Stream->EffectId;
+			Stream->EffectId = -1;
+		}
+
+		if (EffectId != -1)
+		{
+			Stream->Backend->DestroyEffect(Stream->DeviceId, EffectId);
+		}
+	});
+}
+
+void FJoystickForceFeedbackLoop::RunHapticTask(IJoystickBackend& Backend, TFunction<void()>&& Task) const
+{
+	if (HapticThread == nullptr)
+	{
+		Task();
+		return;
+	}
+
+	FJoystickHapticCommand Command;
+	Command.Type = EJoystickHapticCommandType::RunTask;
+	Command.Backend = &Backend;
+	Command.Task = MoveTemp(Task);
+	HapticThread->Enqueue(MoveTemp(Command));
+}
@@ -0,0 +1,136 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "SDL_haptic.h"
+THIRD_PARTY_INCLUDES_END
+
+#include <atomic>
+
+class FEvent;
+class FJoystickHapticThread;
+class FRunnableThread;
+class IJoystickBackend;
+
+/* Returns the force to apply at Time (FPlatformTime::Seconds), -1 to 1 along the device's X axis. Called on the loop thread. */
+using FJoystickForceCallback = TFunction<float(double Time)>;
+
+/**
+ * Streams a game driven force into a constant force effect at a fixed rate, for forces such as physics based
+ * steering that need updating far more often than once a frame.
+ *
+ * Each device streams from either a callback, which the loop calls every step, or a target published from any thread
+ * with SetTarget. Targets arrive once a frame, so the loop can interpolate between the last two to hide frame rate
+ * variation, at the cost of one frame of latency. The output can also be slew rate limited. The effect is only
+ * updated when its level changes.
+ *
+ * The streaming effects are created, started and destroyed on the haptic thread when there is one, so the game thread
+ * never waits on a device. The loop thread only writes levels into effects that the haptic thread has finished
+ * creating.
+ */
+class FJoystickForceFeedbackLoop final : public FRunnable
+{
+public:
+	/* InHapticThread runs the effect creation and destruction, nullptr runs them on the caller */
+	FJoystickForceFeedbackLoop(const int InRate, FJoystickHapticThread* InHapticThread);
+	virtual ~FJoystickForceFeedbackLoop() override;
+
+	bool IsRunning() const { return Thread != nullptr; }
+
+	/* Queues the creation and start of the device's streaming effect, game thread only. A failed creation is logged
+	 * and ends the stream. */
+	bool StartStream(IJoystickBackend& Backend, const int DeviceId);
+	void StopStream(const int DeviceId);
+	bool IsStreaming(const int DeviceId) const;
+
+	/* Any thread */
+	void SetTarget(const int DeviceId, const float Force);
+
+	/* Replaces targets with a callback, pass nullptr to go back to targets */
+	void SetCallback(const int DeviceId, FJoystickForceCallback&& Callback);
+
+	/* Largest change in force per second, 0 for none */
+	void SetSlewRate(const int DeviceId, const float SlewRate);
+	void SetInterpolation(const int DeviceId, const bool Interpolate);
+
+	/* Any thread. Starts the device's streaming effect again after the device stopped all of its effects. */
+	void RestartStream(const int DeviceId);
+
+	/* Stops the streams of a backend that is about to shut down */
+	void RemoveBackend(const IJoystickBackend& Backend);
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	struct FStream
+	{
+		// Held by the loop while it writes to the effect and by the haptic thread while it publishes or destroys the
+		// effect, never by the game thread
+		FCriticalSection UploadLock;
+
+		IJoystickBackend* Backend = nullptr;
+		int DeviceId = -1;
+
+		// -1 until the haptic thread has created and started the effect
+		int EffectId = -1;
+		SDL_HapticEffect Effect;
+
+		// The target's sequence number in the high half and its float bits in the low half, so both are published at once
+		std::atomic<uint64> Target{0};
+		uint32 LastSequence = 0;
+
+		// The two latest targets and when the loop first saw each of them
+		float PreviousTarget = 0.f;
+		float LatestTarget = 0.f;
+		double PreviousTargetTime = 0.0;
+		double LatestTargetTime = 0.0;
+
+		// Swapped whole so the loop never calls a callback while the game thread replaces it
+		TSharedPtr<FJoystickForceCallback, ESPMode::ThreadSafe> Callback;
+		FCriticalSection CallbackLock;
+
+		std::atomic<float> SlewRate{0.f};
+		std::atomic<bool> Interpolate{true};
+
+		// Loop thread only
+		float Output = 0.f;
+
+		std::atomic<bool> RestartRequested{false};
+
+		// Set once the stream is removed, the loop may still hold it for the rest of a step
+		std::atomic<bool> IsStopped{false};
+	};
+
+	using FStreamPtr = TSharedPtr<FStream, ESPMode::ThreadSafe>;
+
+	FStreamPtr FindStream(const int DeviceId) const;
+	void Step(FStream& Stream, const double Now, const double DeltaTime) const;
+	float GetDesiredForce(FStream& Stream, const double Now) const;
+	void CreateStreamEffect(const FStreamPtr& Stream);
+	void DestroyStream(const FStreamPtr& Stream) const;
+
+	/* Runs Task on the haptic thread, or straight away without one */
+	void RunHapticTask(IJoystickBackend& Backend, TFunction<void()>&& Task) const;
+
+	double StepInterval;
+	FJoystickHapticThread* HapticThread;
+
+	// Streams are added and removed on the game thread and stepped on the loop thread. The lock only guards the map,
+	// so publishing a target or changing a stream's parameters never waits for a device.
+	TMap<int, FStreamPtr> Streams;
+	mutable FCriticalSection StreamsLock;
+
+	FEvent* WakeEvent;
+	FThreadSafeBool StopRequested;
+	FRunnableThread* Thread;
+};
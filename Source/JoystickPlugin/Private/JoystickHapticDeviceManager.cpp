@@ -2,263 +2,413 @@
 // Copyright Jayden Maalouf. All Rights Reserved.
 
 #include "JoystickHapticDeviceManager.h"
-#include "JoystickLogManager.h"
 #include "Engine/Engine.h"
+#include "JoystickForceFeedbackLoop.h"
+#include "JoystickHapticThread.h"
+#include "JoystickStats.h"
 #include "JoystickSubsystem.h"
-#include "Data/DeviceInfoSDL.h"
-#include "Runtime/Launch/Resources/Version.h"
+#include "Interfaces/JoystickBackend.h"
 
-THIRD_PARTY_INCLUDES_START
+#include <atomic>
 
-#include "SDL_haptic.h"
+namespace
+{
+	std::atomic<uint64> SkippedEffectUpdates(0);
 
-THIRD_PARTY_INCLUDES_END
+	FJoystickHapticCommand MakeCommand(const EJoystickHapticCommandType Type, IJoystickBackend& Backend, const int DeviceId, const int EffectHandle = -1, const int Value = 0)
+	{
+		FJoystickHapticCommand Command;
+		Command.Type = Type;
+		Command.Backend = &Backend;
+		Command.DeviceId = DeviceId;
+		Command.EffectHandle = EffectHandle;
+		Command.Value = Value;
+		return Command;
+	}
+}
 
-FDeviceInfoSDL* UJoystickHapticDeviceManager::GetDeviceInfo(const int DeviceId) const
+IJoystickBackend* UJoystickHapticDeviceManager::GetDeviceBackend(const int DeviceId) const
 {
-	UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
+	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
 	if (!IsValid(JoystickSubsystem))
 	{
 		return nullptr;
 	}
 
-	return JoystickSubsystem->GetDeviceInfo(DeviceId);
+	return JoystickSubsystem->GetDeviceBackend(DeviceId);
 }
 
-SDL_Haptic* UJoystickHapticDeviceManager::GetHapticDevice(const int DeviceId) const
+FJoystickHapticThread* UJoystickHapticDeviceManager::GetHapticThread() const
 {
-	const FDeviceInfoSDL* DeviceInfo = GetDeviceInfo(DeviceId);
-	if (DeviceInfo == nullptr)
+	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
+	if (!IsValid(JoystickSubsystem))
+	{
+		return nullptr;
+	}
+
+	return JoystickSubsystem->GetHapticThread();
+}
+
+FJoystickForceFeedbackLoop* UJoystickHapticDeviceManager::GetForceFeedbackLoop(const bool CreateIfNeeded) const
+{
+	UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
+	if (!IsValid(JoystickSubsystem))
 	{
 		return nullptr;
 	}
 
-	return DeviceInfo->Haptic;
+	return JoystickSubsystem->GetForceFeedbackLoop(CreateIfNeeded);
 }
 
 bool UJoystickHapticDeviceManager::SetAutoCenter(const int DeviceId, const int Center)
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return false;
 	}
 
-	const int Result = SDL_HapticSetAutocenter(HapticDevice, Center);
-	if (Result == -1)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Autocenter Error: %s"), *ErrorMessage);
-		return false;
+		return HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::SetAutoCenter, *Backend, DeviceId, -1, Center));
 	}
 
-	return true;
+	return Backend->SetAutoCenter(DeviceId, Center);
 }
 
 bool UJoystickHapticDeviceManager::SetGain(const int DeviceId, const int Gain)
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return false;
 	}
 
-	const int Result = SDL_HapticSetGain(HapticDevice, Gain);
-	if (Result == -1)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Gain Error: %s"), *ErrorMessage);
-		return false;
+		return HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::SetGain, *Backend, DeviceId, -1, Gain));
 	}
 
-	return true;
+	return Backend->SetGain(DeviceId, Gain);
 }
 
 int UJoystickHapticDeviceManager::GetEffectStatus(const int DeviceId, const int EffectId)
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return -1;
 	}
 
-	const int Result = SDL_HapticGetEffectStatus(HapticDevice, EffectId);
-	if (Result == -1)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("GetEffectStatus Error: %s"), *ErrorMessage);
-		return -1;
+		return HapticThread->GetEffectStatus(EffectId);
 	}
 
-	return Result;
+	return Backend->GetEffectStatus(DeviceId, EffectId);
 }
 
 void UJoystickHapticDeviceManager::PlayRumble(const int DeviceId, const float LowFrequencyRumble, const float HighFrequencyRumble, const float Duration) const
 {
-#if ENGINE_MAJOR_VERSION == 5
-	const FDeviceInfoSDL* DeviceInfo = GetDeviceInfo(DeviceId);
-	if (DeviceInfo == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
+	{
+		return;
+	}
+
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
+		FJoystickHapticCommand Command = MakeCommand(EJoystickHapticCommandType::PlayRumble, *Backend, DeviceId);
+		Command.LowFrequency = LowFrequencyRumble;
+		Command.HighFrequency = HighFrequencyRumble;
+		Command.Duration = Duration;
+		HapticThread->Enqueue(MoveTemp(Command));
 		return;
 	}
 
-	const Uint16 LowFrequency = FMath::Clamp<Uint16>(LowFrequencyRumble * UINT16_MAX, 0, UINT16_MAX);
-	const Uint16 HighFrequency = FMath::Clamp<Uint16>(HighFrequencyRumble * UINT16_MAX, 0, UINT16_MAX);
-	const Uint32 ClampedDuration = Duration == -1 ? SDL_HAPTIC_INFINITY : FMath::Clamp<Uint32>(Duration * 1000.0f, 0, UINT32_MAX);
-	SDL_JoystickRumble(DeviceInfo->Joystick, LowFrequency, HighFrequency, ClampedDuration);
-#else
-	FJoystickLogManager::Get()->LogError(TEXT("PlayRumble not supported on this engine version."));
-#endif
+	Backend->PlayRumble(DeviceId, LowFrequencyRumble, HighFrequencyRumble, Duration);
 }
 
 void UJoystickHapticDeviceManager::StopRumble(const int DeviceId)
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return;
 	}
 
-	SDL_HapticRumbleStop(HapticDevice);
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
+	{
+		HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::StopRumble, *Backend, DeviceId));
+		return;
+	}
+
+	Backend->StopRumble(DeviceId);
+}
+
+int64 UJoystickHapticDeviceManager::GetSkippedEffectUpdateCount() const
+{
+	return static_cast<int64>(SkippedEffectUpdates.load(std::memory_order_relaxed));
 }
 
-int UJoystickHapticDeviceManager::CreateEffect(const int DeviceId, SDL_HapticEffect& Effect) const
+int64 UJoystickHapticDeviceManager::GetCoalescedEffectUpdateCount() const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	const FJoystickHapticThread* HapticThread = GetHapticThread();
+	if (HapticThread == nullptr)
+	{
+		return 0;
+	}
+
+	return static_cast<int64>(HapticThread->GetCoalescedUpdateCount());
+}
+
+void UJoystickHapticDeviceManager::RecordSkippedEffectUpdate() const
+{
+	SkippedEffectUpdates.fetch_add(1, std::memory_order_relaxed);
+	INC_DWORD_STAT(STAT_JoystickHapticUpdatesSkipped);
+}
+
+bool UJoystickHapticDeviceManager::GetEffectPoolStats(const int DeviceId, FJoystickEffectPoolStats& Stats) const
+{
+	const FJoystickHapticThread* HapticThread = GetHapticThread();
+	if (HapticThread == nullptr)
+	{
+		return false;
+	}
+
+	return HapticThread->GetEffectPoolStats(DeviceId, Stats);
+}
+
+bool UJoystickHapticDeviceManager::StartForceStream(const int DeviceId) const
+{
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
+	{
+		return false;
+	}
+
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop(true);
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return false;
+	}
+
+	return ForceFeedbackLoop->StartStream(*Backend, DeviceId);
+}
+
+void UJoystickHapticDeviceManager::StopForceStream(const int DeviceId) const
+{
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop();
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return;
+	}
+
+	ForceFeedbackLoop->StopStream(DeviceId);
+}
+
+void UJoystickHapticDeviceManager::SetForceTarget(const int DeviceId, const float Force) const
+{
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop();
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return;
+	}
+
+	ForceFeedbackLoop->SetTarget(DeviceId, Force);
+}
+
+void UJoystickHapticDeviceManager::SetForceSlewRate(const int DeviceId, const float SlewRate) const
+{
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop();
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return;
+	}
+
+	ForceFeedbackLoop->SetSlewRate(DeviceId, SlewRate);
+}
+
+void UJoystickHapticDeviceManager::SetForceInterpolation(const int DeviceId, const bool Interpolate) const
+{
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop();
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return;
+	}
+
+	ForceFeedbackLoop->SetInterpolation(DeviceId, Interpolate);
+}
+
+void UJoystickHapticDeviceManager::SetForceCallback(const int DeviceId, TFunction<float(double Time)>&& Callback) const
+{
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop();
+	if (ForceFeedbackLoop == nullptr)
+	{
+		return;
+	}
+
+	ForceFeedbackLoop->SetCallback(DeviceId, MoveTemp(Callback));
+}
+
+int UJoystickHapticDeviceManager::CreateEffect(const int DeviceId, SDL_HapticEffect& Effect, UForceFeedbackEffectBase* Owner, const int Priority) const
+{
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return -1;
 	}
 
-	const int EffectId = SDL_HapticNewEffect(HapticDevice, &Effect);
-	if (EffectId == -1)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Haptic CreateEffect Error: %s"), *ErrorMessage);
+		return HapticThread->CreateEffect(*Backend, DeviceId, Effect, Priority, Owner);
 	}
 
-	return EffectId;
+	return Backend->CreateEffect(DeviceId, Effect);
 }
 
 bool UJoystickHapticDeviceManager::UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return false;
 	}
 
-	const int Result = SDL_HapticUpdateEffect(HapticDevice, EffectId, &Effect);
-	if (Result != 0)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Haptic UpdateEffect Error: %s"), *ErrorMessage);
-		return false;
+		FJoystickHapticCommand Command = MakeCommand(EJoystickHapticCommandType::UpdateEffect, *Backend, DeviceId, EffectId);
+		Command.Effect = Effect;
+		return HapticThread->Enqueue(MoveTemp(Command));
 	}
 
-	return true;
+	return Backend->UpdateEffect(DeviceId, EffectId, Effect);
 }
 
 bool UJoystickHapticDeviceManager::RunEffect(const int DeviceId, const int EffectId, const int Iterations) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return false;
 	}
 
-	const int Result = SDL_HapticRunEffect(HapticDevice, EffectId, Iterations);
-	if (Result != 0)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Haptic RunEffect Error: %s"), *ErrorMessage);
-		return false;
+		return HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::RunEffect, *Backend, DeviceId, EffectId, Iterations));
 	}
 
-	return true;
+	return Backend->RunEffect(DeviceId, EffectId, Iterations);
 }
 
 bool UJoystickHapticDeviceManager::StopEffect(const int DeviceId, const int EffectId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return false;
 	}
 
-	const int Result = SDL_HapticStopEffect(HapticDevice, EffectId);
-	if (Result != 0)
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
-		const FString ErrorMessage = FString(SDL_GetError());
-		FJoystickLogManager::Get()->LogError(TEXT("Haptic StopEffect Error: %s"), *ErrorMessage);
-		return false;
+		return HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::StopEffect, *Backend, DeviceId, EffectId));
 	}
 
-	return true;
+	return Backend->StopEffect(DeviceId, EffectId);
 }
 
 void UJoystickHapticDeviceManager::DestroyEffect(const int DeviceId, const int EffectId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return;
 	}
 
-	SDL_HapticDestroyEffect(HapticDevice, EffectId);
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
+	{
+		HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::DestroyEffect, *Backend, DeviceId, EffectId));
+		return;
+	}
+
+	Backend->DestroyEffect(DeviceId, EffectId);
 }
 
 void UJoystickHapticDeviceManager::PauseDevice(const int DeviceId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
+	{
+		return;
+	}
+
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
+		HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::PauseHaptics, *Backend, DeviceId));
 		return;
 	}
 
-	SDL_HapticPause(HapticDevice);
+	Backend->PauseHaptics(DeviceId);
 }
 
 void UJoystickHapticDeviceManager::UnpauseDevice(const int DeviceId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
+	{
+		return;
+	}
+
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
 	{
+		HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::UnpauseHaptics, *Backend, DeviceId));
 		return;
 	}
 
-	SDL_HapticUnpause(HapticDevice);
+	Backend->UnpauseHaptics(DeviceId);
 }
 
 void UJoystickHapticDeviceManager::StopAllEffects(const int DeviceId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return;
 	}
 
-	SDL_HapticStopAll(HapticDevice);
+	if (FJoystickHapticThread* HapticThread = GetHapticThread())
+	{
+		HapticThread->Enqueue(MakeCommand(EJoystickHapticCommandType::StopAllEffects, *Backend, DeviceId));
+		return;
+	}
+
+	Backend->StopAllEffects(DeviceId);
+
+	// Force streams keep going, they are stopped with StopForceStream
+	if (FJoystickForceFeedbackLoop* ForceFeedbackLoop = GetForceFeedbackLoop())
+	{
+		ForceFeedbackLoop->RestartStream(DeviceId);
+	}
 }
 
 int UJoystickHapticDeviceManager::GetNumEffects(const int DeviceId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return -1;
 	}
 
-	return SDL_HapticNumEffects(HapticDevice);
+	return Backend->GetNumEffects(DeviceId);
 }
 
 int UJoystickHapticDeviceManager::GetNumEffectsPlaying(const int DeviceId) const
 {
-	SDL_Haptic* HapticDevice = GetHapticDevice(DeviceId);
-	if (HapticDevice == nullptr)
+	IJoystickBackend* Backend = GetDeviceBackend(DeviceId);
+	if (Backend == nullptr)
 	{
 		return -1;
 	}
 
-	return SDL_HapticNumEffectsPlaying(HapticDevice);
+	return Backend->GetNumEffectsPlaying(DeviceId);
 }
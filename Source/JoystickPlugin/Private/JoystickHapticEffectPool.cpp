@@ -0,0 +1,188 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickHapticEffectPool.h"
+#include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "Interfaces/JoystickBackend.h"
+
+FJoystickHapticEffectPool::FJoystickHapticEffectPool(IJoystickBackend& InBackend, const int InDeviceId, const int InMaxFreeSlots)
+	: Backend(InBackend)
+	  , DeviceId(InDeviceId)
+	  , MaxFreeSlots(FMath::Max(InMaxFreeSlots, 0))
+	  , NextOrder(0)
+{
+	Stats.Capacity = Backend.GetNumEffects(DeviceId);
+}
+
+int FJoystickHapticEffectPool::Acquire(const int EffectHandle, const SDL_HapticEffect& Effect, const int Priority, TFunctionRef<bool(int EffectHandle)> IsPlaying, int& EvictedHandle)
+{
+	EvictedHandle = -1;
+
+	FPooledSlot Slot;
+	Slot.Type = Effect.type;
+	Slot.Priority = Priority;
+	Slot.Order = NextOrder++;
+
+	// A free slot of the same type only needs the new effect uploaded
+	const int FreeIndex = FreeSlots.IndexOfByPredicate([&Effect](const FPooledSlot& FreeSlot) { return FreeSlot.Type == Effect.type; });
+	if (FreeIndex != INDEX_NONE)
+	{
+		if (Backend.UpdateEffect(DeviceId, FreeSlots[FreeIndex].EffectId, Effect))
+		{
+			Slot.EffectId = FreeSlots[FreeIndex].EffectId;
+			FreeSlots.RemoveAt(FreeIndex);
+			ActiveSlots.Add(EffectHandle, Slot);
+
+			Stats.Reused++;
+			INC_DWORD_STAT(STAT_JoystickHapticSlotsReused);
+			UpdateSlotCounts();
+			return Slot.EffectId;
+		}
+
+		DestroyFreeSlot(FreeIndex);
+	}
+
+	// Free slots of other types make way before anything live does
+	if (!HasRoom() && FreeSlots.Num() > 0)
+	{
+		DestroyFreeSlot(0);
+	}
+
+	if (HasRoom())
+	{
+		Slot.EffectId = CreateSlot(Effect);
+
+		// Slots can also be held by effects outside the pool, such as rumble
+		if (Slot.EffectId == -1 && FreeSlots.Num() > 0)
+		{
+			DestroyFreeSlot(0);
+			Slot.EffectId = CreateSlot(Effect);
+		}
+	}
+
+	// The device can be full before the pool is, the mixer, streams and rumble hold slots the pool does not count
+	if (Slot.EffectId == -1 && FindEvictionCandidate(Priority, IsPlaying, EvictedHandle))
+	{
+		const FPooledSlot EvictedSlot = ActiveSlots.FindAndRemoveChecked(EvictedHandle);
+		Backend.StopEffect(DeviceId, EvictedSlot.EffectId);
+
+		if (EvictedSlot.Type == Effect.type && Backend.UpdateEffect(DeviceId, EvictedSlot.EffectId, Effect))
+		{
+			Slot.EffectId = EvictedSlot.EffectId;
+		}
+		else
+		{
+			Backend.DestroyEffect(DeviceId, EvictedSlot.EffectId);
+			Slot.EffectId = CreateSlot(Effect);
+		}
+
+		Stats.Evicted++;
+		INC_DWORD_STAT(STAT_JoystickHapticSlotsEvicted);
+		FJoystickLogManager::Get()->LogDebug(TEXT("Evicted effect %d on device %d for an effect with priority %d"), EvictedHandle, DeviceId, Priority);
+	}
+
+	if (Slot.EffectId == -1)
+	{
+		Stats.Failed++;
+		UpdateSlotCounts();
+		return -1;
+	}
+
+	ActiveSlots.Add(EffectHandle, Slot);
+	UpdateSlotCounts();
+	return Slot.EffectId;
+}
+
+void FJoystickHapticEffectPool::Release(const int EffectHandle)
+{
+	FPooledSlot Slot;
+	if (!ActiveSlots.RemoveAndCopyValue(EffectHandle, Slot))
+	{
+		return;
+	}
+
+	if (FreeSlots.Num() >= MaxFreeSlots)
+	{
+		Backend.DestroyEffect(DeviceId, Slot.EffectId);
+		UpdateSlotCounts();
+		return;
+	}
+
+	Backend.StopEffect(DeviceId, Slot.EffectId);
+	FreeSlots.Add(Slot);
+	UpdateSlotCounts();
+}
+
+void FJoystickHapticEffectPool::Shutdown()
+{
+	for (const TPair<int, FPooledSlot>& Pair : ActiveSlots)
+	{
+		Backend.DestroyEffect(DeviceId, Pair.Value.EffectId);
+	}
+
+	for (const FPooledSlot& FreeSlot : FreeSlots)
+	{
+		Backend.DestroyEffect(DeviceId, FreeSlot.EffectId);
+	}
+
+	ActiveSlots.Empty();
+	FreeSlots.Empty();
+	UpdateSlotCounts();
+}
+
+bool FJoystickHapticEffectPool::HasRoom() const
+{
+	return Stats.Capacity <= 0 || ActiveSlots.Num() + FreeSlots.Num() < Stats.Capacity;
+}
+
+int FJoystickHapticEffectPool::CreateSlot(const SDL_HapticEffect& Effect)
+{
+	const int EffectId = Backend.CreateEffect(DeviceId, Effect);
+	if (EffectId != -1)
+	{
+		Stats.Created++;
+	}
+
+	return EffectId;
+}
+
+void FJoystickHapticEffectPool::DestroyFreeSlot(const int Index)
+{
+	Backend.DestroyEffect(DeviceId, FreeSlots[Index].EffectId);
+	FreeSlots.RemoveAt(Index);
+}
+
+bool FJoystickHapticEffectPool::FindEvictionCandidate(const int Priority, TFunctionRef<bool(int EffectHandle)> IsPlaying, int& EvictedHandle) const
+{
+	const FPooledSlot* Candidate = nullptr;
+	bool CandidatePlaying = false;
+	for (const TPair<int, FPooledSlot>& Pair : ActiveSlots)
+	{
+		const FPooledSlot& Slot = Pair.Value;
+		if (Slot.Priority >= Priority)
+		{
+			continue;
+		}
+
+		// Lowest priority first, then idle before playing, then oldest
+		const bool Playing = IsPlaying(Pair.Key);
+		const bool IsBetter = Candidate == nullptr
+			|| Slot.Priority < Candidate->Priority
+			|| (Slot.Priority == Candidate->Priority && ((CandidatePlaying && !Playing) || (Playing == CandidatePlaying && Slot.Order < Candidate->Order)));
+		if (IsBetter)
+		{
+			Candidate = &Slot;
+			CandidatePlaying = Playing;
+			EvictedHandle = Pair.Key;
+		}
+	}
+
+	return Candidate != nullptr;
+}
+
+void FJoystickHapticEffectPool::UpdateSlotCounts()
+{
+	Stats.ActiveSlots = ActiveSlots.Num();
+	Stats.FreeSlots = FreeSlots.Num();
+}
@@ -0,0 +1,70 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/JoystickEffectPoolStats.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "SDL_haptic.h"
+THIRD_PARTY_INCLUDES_END
+
+class IJoystickBackend;
+
+/**
+ * Hands out the hardware effect slots of one device. A destroyed effect leaves its slot stopped on the device, and the
+ * next effect of the same SDL type is uploaded into it with an update rather than a new effect, so short lived effects
+ * do not churn the driver.
+ *
+ * Once the device is full, an effect takes the slot of the live effect with the lowest priority below its own,
+ * preferring one that is not playing. Owned and called by the haptic thread only.
+ */
+class FJoystickHapticEffectPool
+{
+public:
+	FJoystickHapticEffectPool(IJoystickBackend& InBackend, const int InDeviceId, const int InMaxFreeSlots);
+
+	IJoystickBackend& GetBackend() const { return Backend; }
+	const FJoystickEffectPoolStats& GetStats() const { return Stats; }
+
+	/* Returns the backend's effect id now holding the effect, or -1 when there is no slot for it. When the slot was
+	 * taken from another effect, that effect's handle is written to EvictedHandle. */
+	int Acquire(const int EffectHandle, const SDL_HapticEffect& Effect, const int Priority, TFunctionRef<bool(int EffectHandle)> IsPlaying, int& EvictedHandle);
+
+	/* Stops the effect and keeps its slot for reuse, or destroys it when enough slots are already free */
+	void Release(const int EffectHandle);
+
+	/* Destroys every slot, live and free */
+	void Shutdown();
+
+private:
+	struct FPooledSlot
+	{
+		int EffectId = -1;
+		Uint16 Type = 0;
+		int Priority = 0;
+
+		// When the slot was handed out, the older of two equal candidates is evicted first
+		uint64 Order = 0;
+	};
+
+	bool HasRoom() const;
+	int CreateSlot(const SDL_HapticEffect& Effect);
+	void DestroyFreeSlot(const int Index);
+	bool FindEvictionCandidate(const int Priority, TFunctionRef<bool(int EffectHandle)> IsPlaying, int& EvictedHandle) const;
+	void UpdateSlotCounts();
+
+	IJoystickBackend& Backend;
+	int DeviceId;
+	int MaxFreeSlots;
+
+	// Live slots by effect handle
+	TMap<int, FPooledSlot> ActiveSlots;
+	uint64 NextOrder;
+
+	// Oldest first
+	TArray<FPooledSlot> FreeSlots;
+
+	FJoystickEffectPoolStats Stats;
+};
@@ -0,0 +1,302 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickHapticMixer.h"
+#include "JoystickLogManager.h"
+#include "Interfaces/JoystickBackend.h"
+
+namespace
+{
+	// The replay and envelope fields, which every mixable effect has under a different union member
+	struct FJoystickReplay
+	{
+		const SDL_HapticDirection* Direction;
+		Uint32 Length;
+		Uint16 Delay;
+		Uint16 AttackLength;
+		Uint16 AttackLevel;
+		Uint16 FadeLength;
+		Uint16 FadeLevel;
+	};
+
+	template <typename T>
+	FJoystickReplay MakeReplay(const T& Effect)
+	{
+		return {&Effect.direction, Effect.length, Effect.delay, Effect.attack_length, Effect.attack_level, Effect.fade_length, Effect.fade_level};
+	}
+
+	FJoystickReplay GetReplay(const SDL_HapticEffect& Effect)
+	{
+		switch (Effect.type)
+		{
+			case SDL_HAPTIC_CONSTANT:
+				return MakeReplay(Effect.constant);
+			case SDL_HAPTIC_RAMP:
+				return MakeReplay(Effect.ramp);
+			default:
+				return MakeReplay(Effect.periodic);
+		}
+	}
+
+	float GetDirectionScale(const SDL_HapticDirection& Direction)
+	{
+		switch (Direction.type)
+		{
+			case SDL_HAPTIC_POLAR:
+				// Hundredths of a degree, 9000 points along X
+				return FMath::Sin(FMath::DegreesToRadians(Direction.dir[0] / 100.0f));
+			case SDL_HAPTIC_SPHERICAL:
+				return FMath::Cos(FMath::DegreesToRadians(Direction.dir[0] / 100.0f)) * FMath::Cos(FMath::DegreesToRadians(Direction.dir[1] / 100.0f));
+			default:
+			{
+				const FVector Vector(static_cast<float>(Direction.dir[0]), static_cast<float>(Direction.dir[1]), static_cast<float>(Direction.dir[2]));
+
+				// Single axis devices play an effect without a direction along X
+				return Vector.IsNearlyZero() ? 1.0f : static_cast<float>(Vector.X / Vector.Size());
+			}
+		}
+	}
+
+	float ApplyEnvelope(const FJoystickReplay& Replay, const float Peak, const double Time, const bool IsInfinite)
+	{
+		// Levels above 0x7FFF saturate, as they do when SDL hands the envelope to the driver
+		if (Replay.AttackLength > 0 && Time < Replay.AttackLength)
+		{
+			const float AttackLevel = FMath::Min<float>(Replay.AttackLevel, 0x7FFF);
+			return FMath::Lerp(AttackLevel, Peak, static_cast<float>(Time / Replay.AttackLength));
+		}
+
+		if (!IsInfinite && Replay.FadeLength > 0 && Time > static_cast<double>(Replay.Length) - Replay.FadeLength)
+		{
+			const float FadeLevel = FMath::Min<float>(Replay.FadeLevel, 0x7FFF);
+			return FMath::Lerp(FadeLevel, Peak, static_cast<float>((Replay.Length - Time) / Replay.FadeLength));
+		}
+
+		return Peak;
+	}
+
+	float GetWave(const Uint16 Type, const float Position)
+	{
+		switch (Type)
+		{
+			case SDL_HAPTIC_TRIANGLE:
+				return Position < 0.25 ? 4.0f * Position : Position < 0.75 ? 2.0f - 4.0f * Position : 4.0f * Position - 4.0f;
+			case SDL_HAPTIC_SAWTOOTHUP:
+				return 2.0f * Position - 1.0f;
+			case SDL_HAPTIC_SAWTOOTHDOWN:
+				return 1.0f - 2.0f * Position;
+			default:
+				return FMath::Sin(2.0f * PI * Position);
+		}
+	}
+}
+
+FJoystickHapticMixer::FJoystickHapticMixer(IJoystickBackend& InBackend, const int InDeviceId)
+	: Backend(InBackend)
+	  , DeviceId(InDeviceId)
+	  , StreamEffectId(-1)
+	  , IsStreamStopped(false)
+{
+	SDL_memset(&StreamEffect, 0, sizeof(SDL_HapticEffect));
+	StreamEffect.type = SDL_HAPTIC_CONSTANT;
+	StreamEffect.constant.direction.type = SDL_HAPTIC_CARTESIAN;
+	StreamEffect.constant.direction.dir[0] = 1;
+	StreamEffect.constant.length = SDL_HAPTIC_INFINITY;
+}
+
+bool FJoystickHapticMixer::CanMix(const SDL_HapticEffect& Effect)
+{
+	switch (Effect.type)
+	{
+		case SDL_HAPTIC_CONSTANT:
+		case SDL_HAPTIC_RAMP:
+		case SDL_HAPTIC_SINE:
+		case SDL_HAPTIC_TRIANGLE:
+		case SDL_HAPTIC_SAWTOOTHUP:
+		case SDL_HAPTIC_SAWTOOTHDOWN:
+			return true;
+		default:
+			return false;
+	}
+}
+
+void FJoystickHapticMixer::AddEffect(const int EffectHandle, const SDL_HapticEffect& Effect)
+{
+	if (StreamEffectId == -1)
+	{
+		CreateStreamEffect();
+	}
+
+	FMixedEffect& MixedEffect = Effects.Add(EffectHandle);
+	MixedEffect.Effect = Effect;
+}
+
+void FJoystickHapticMixer::UpdateEffect(const int EffectHandle, const SDL_HapticEffect& Effect)
+{
+	if (FMixedEffect* MixedEffect = Effects.Find(EffectHandle))
+	{
+		MixedEffect->Effect = Effect;
+	}
+}
+
+void FJoystickHapticMixer::RunEffect(const int EffectHandle, const int Iterations, const double Now)
+{
+	if (FMixedEffect* MixedEffect = Effects.Find(EffectHandle))
+	{
+		MixedEffect->StartTime = Now;
+		MixedEffect->Iterations = Iterations;
+		MixedEffect->IsPlaying = true;
+	}
+}
+
+void FJoystickHapticMixer::StopEffect(const int EffectHandle)
+{
+	if (FMixedEffect* MixedEffect = Effects.Find(EffectHandle))
+	{
+		MixedEffect->IsPlaying = false;
+	}
+}
+
+void FJoystickHapticMixer::RemoveEffect(const int EffectHandle)
+{
+	Effects.Remove(EffectHandle);
+}
+
+void FJoystickHapticMixer::StopAllEffects()
+{
+	for (TPair<int, FMixedEffect>& Pair : Effects)
+	{
+		Pair.Value.IsPlaying = false;
+	}
+
+	// Stopping every effect on the device stopped the streaming effect with them
+	IsStreamStopped = StreamEffectId != -1;
+}
+
+bool FJoystickHapticMixer::Mix(const double Now, double& NextUploadTime, const double UploadInterval, TArray<int>& FinishedEffects)
+{
+	float Force = 0.0f;
+	bool IsPlaying = false;
+	for (TPair<int, FMixedEffect>& Pair : Effects)
+	{
+		bool IsFinished = false;
+		Force += Evaluate(Pair.Value, Now, IsFinished);
+
+		if (IsFinished)
+		{
+			Pair.Value.IsPlaying = false;
+			FinishedEffects.Add(Pair.Key);
+		}
+
+		IsPlaying |= Pair.Value.IsPlaying;
+	}
+
+	const Sint16 Level = static_cast<Sint16>(FMath::Clamp(FMath::RoundToInt(Force), -0x7FFF, 0x7FFF));
+	// Shares the device's update rate limit with every other effect update, a force held back goes out on a later mix
+	if (StreamEffectId != -1 && Level != StreamEffect.constant.level && Now >= NextUploadTime)
+	{
+		NextUploadTime = Now + UploadInterval;
+		StreamEffect.constant.level = Level;
+		Backend.UpdateEffect(DeviceId, StreamEffectId, StreamEffect);
+	}
+
+	if (IsStreamStopped && Level != 0 && Backend.RunEffect(DeviceId, StreamEffectId, SDL_HAPTIC_INFINITY))
+	{
+		IsStreamStopped = false;
+	}
+
+	return IsPlaying || Level != 0 || (StreamEffectId != -1 && Level != StreamEffect.constant.level);
+}
+
+void FJoystickHapticMixer::Shutdown()
+{
+	if (StreamEffectId == -1)
+	{
+		return;
+	}
+
+	Backend.DestroyEffect(DeviceId, StreamEffectId);
+	StreamEffectId = -1;
+	StreamEffect.constant.level = 0;
+	IsStreamStopped = false;
+}
+
+float FJoystickHapticMixer::Evaluate(const FMixedEffect& MixedEffect, const double Now, bool& IsFinished)
+{
+	IsFinished = false;
+	if (!MixedEffect.IsPlaying)
+	{
+		return 0.0f;
+	}
+
+	const SDL_HapticEffect& Effect = MixedEffect.Effect;
+	const FJoystickReplay Replay = GetReplay(Effect);
+	const bool IsInfinite = Replay.Length == SDL_HAPTIC_INFINITY;
+
+	// Milliseconds into the current iteration, each of which waits for the delay and then plays for the length
+	const double Elapsed = (Now - MixedEffect.StartTime) * 1000.0;
+	double Time = Elapsed - Replay.Delay;
+	if (!IsInfinite)
+	{
+		const double Cycle = static_cast<double>(Replay.Delay) + Replay.Length;
+		const int Iteration = Cycle > 0.0 ? FMath::FloorToInt(static_cast<float>(Elapsed / Cycle)) : 0;
+		if (Cycle <= 0.0 || (MixedEffect.Iterations >= 0 && Iteration >= FMath::Max(MixedEffect.Iterations, 1)))
+		{
+			IsFinished = true;
+			return 0.0f;
+		}
+
+		Time -= Iteration * Cycle;
+	}
+
+	if (Time < 0.0)
+	{
+		return 0.0f;
+	}
+
+	const float DirectionScale = GetDirectionScale(*Replay.Direction);
+
+	switch (Effect.type)
+	{
+		case SDL_HAPTIC_CONSTANT:
+		{
+			const float Peak = FMath::Abs(static_cast<float>(Effect.constant.level));
+			return FMath::Sign(static_cast<float>(Effect.constant.level)) * ApplyEnvelope(Replay, Peak, Time, IsInfinite) * DirectionScale;
+		}
+		case SDL_HAPTIC_RAMP:
+		{
+			const float Alpha = IsInfinite || Replay.Length == 0 ? 0.0f : FMath::Clamp(static_cast<float>(Time / Replay.Length), 0.0f, 1.0f);
+			const float Value = FMath::Lerp(static_cast<float>(Effect.ramp.start), static_cast<float>(Effect.ramp.end), Alpha);
+			const float Peak = FMath::Max(FMath::Abs(static_cast<float>(Effect.ramp.start)), FMath::Abs(static_cast<float>(Effect.ramp.end)));
+			return Peak > 0.0f ? Value * ApplyEnvelope(Replay, Peak, Time, IsInfinite) / Peak * DirectionScale : 0.0f;
+		}
+		default:
+		{
+			// A negative magnitude is the same wave half a period later
+			const SDL_HapticPeriodic& Periodic = Effect.periodic;
+			const double Cycles = (Periodic.period > 0 ? Time / Periodic.period : 0.0) + Periodic.phase / 36000.0;
+			const double Position = Cycles - FMath::FloorToDouble(Cycles);
+			const float Peak = FMath::Abs(static_cast<float>(Periodic.magnitude));
+			const float Wave = FMath::Sign(static_cast<float>(Periodic.magnitude)) * GetWave(Effect.type, static_cast<float>(Position));
+			return (Periodic.offset + ApplyEnvelope(Replay, Peak, Time, IsInfinite) * Wave) * DirectionScale;
+		}
+	}
+}
+
+bool FJoystickHapticMixer::CreateStreamEffect()
+{
+	StreamEffect.constant.level = 0;
+	StreamEffectId = Backend.CreateEffect(DeviceId, StreamEffect);
+	if (StreamEffectId == -1)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to create the force feedback mixer's effect on device %d"), DeviceId);
+		return false;
+	}
+
+	if (!Backend.RunEffect(DeviceId, StreamEffectId, SDL_HAPTIC_INFINITY))
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to start the force feedback mixer's effect on device %d"), DeviceId);
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "SDL_haptic.h"
+THIRD_PARTY_INCLUDES_END
+
+class IJoystickBackend;
+
+/**
+ * Sums the constant, periodic and ramp effects of one device in software and streams the result into a single
+ * hardware constant force effect, so any number of them can play on a device with only a few effect slots. Condition
+ * and custom effects are never mixed and keep their own hardware slots.
+ *
+ * Mixed effects are plain copies of their SDL_HapticEffect, evaluated the way the driver would: delay, length,
+ * iterations and envelope apply, and each effect is projected onto the X axis by its direction. Owned and called by
+ * the haptic thread only.
+ */
+class FJoystickHapticMixer
+{
+public:
+	FJoystickHapticMixer(IJoystickBackend& InBackend, const int InDeviceId);
+
+	static bool CanMix(const SDL_HapticEffect& Effect);
+
+	IJoystickBackend& GetBackend() const { return Backend; }
+	bool IsEmpty() const { return Effects.Num() == 0; }
+
+	void AddEffect(const int EffectHandle, const SDL_HapticEffect& Effect);
+	void UpdateEffect(const int EffectHandle, const SDL_HapticEffect& Effect);
+	void RunEffect(const int EffectHandle, const int Iterations, const double Now);
+	void StopEffect(const int EffectHandle);
+	void RemoveEffect(const int EffectHandle);
+
+	/* After the device stopped all of its effects, the streaming effect is started again once there is force to send */
+	void StopAllEffects();
+
+	/* Sends the mixed force when it changed and the device's upload slot at NextUploadTime has come, which then moves
+	 * on by UploadInterval. Effects that ran out are added to FinishedEffects. Returns true while the device still
+	 * needs mixing. */
+	bool Mix(const double Now, double& NextUploadTime, const double UploadInterval, TArray<int>& FinishedEffects);
+
+	/* Destroys the streaming effect */
+	void Shutdown();
+
+private:
+	struct FMixedEffect
+	{
+		SDL_HapticEffect Effect;
+		double StartTime = 0.0;
+		int Iterations = 0;
+		bool IsPlaying = false;
+	};
+
+	/* The effect's force along X at Now, IsFinished is set once its last iteration ended */
+	static float Evaluate(const FMixedEffect& MixedEffect, const double Now, bool& IsFinished);
+
+	bool CreateStreamEffect();
+
+	IJoystickBackend& Backend;
+	int DeviceId;
+
+	TMap<int, FMixedEffect> Effects;
+
+	SDL_HapticEffect StreamEffect;
+	int StreamEffectId;
+	bool IsStreamStopped;
+};
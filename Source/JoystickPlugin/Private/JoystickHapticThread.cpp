@@ -0,0 +1,785 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickHapticThread.h"
+#include "JoystickForceFeedbackLoop.h"
+#include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "ForceFeedback/Effects/ForceFeedbackEffectBase.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Interfaces/JoystickBackend.h"
+
+namespace
+{
+	// How often the status of playing effects is refreshed
+	constexpr uint32 StatusPollIntervalMs = 50;
+
+	bool HasEffectData(const EJoystickHapticCommandType Type)
+	{
+		return Type == EJoystickHapticCommandType::CreateEffect || Type == EJoystickHapticCommandType::UpdateEffect;
+	}
+}
+
+FJoystickHapticThread::FJoystickHapticThread(const int MaxUpdateRate, const int MixerRate, const int InMaxFreeEffectSlots)
+	: PendingCommands(0)
+	  , FlushRequested(false)
+	  , WakeEvent(FPlatformProcess::GetSynchEventFromPool(false))
+	  , NextEffectHandle(0)
+	  , UploadInterval(MaxUpdateRate > 0 ? 1.0 / MaxUpdateRate : 0.0)
+	  , CoalescedUpdates(0)
+	  , MixerInterval(MixerRate > 0 ? 1.0 / MixerRate : 0.0)
+	  , NextMixTime(0.0)
+	  , IsMixing(false)
+	  , MaxFreeEffectSlots(InMaxFreeEffectSlots)
+	  , ForceFeedbackLoop(nullptr)
+	  , Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, TEXT("JoystickHapticThread"), 0, TPri_AboveNormal);
+	if (Thread == nullptr)
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to create the joystick haptic thread."));
+	}
+}
+
+FJoystickHapticThread::~FJoystickHapticThread()
+{
+	if (Thread != nullptr)
+	{
+		Flush();
+
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+int FJoystickHapticThread::CreateEffect(IJoystickBackend& Backend, const int DeviceId, const SDL_HapticEffect& Effect, const int Priority, UForceFeedbackEffectBase* Owner)
+{
+	const int EffectHandle = NextEffectHandle++;
+
+	{
+		FScopeLock Lock(&EffectsLock);
+		FEffectSlot& Slot = Effects.Add(EffectHandle);
+		Slot.Backend = &Backend;
+		Slot.DeviceId = DeviceId;
+	}
+
+	if (Owner != nullptr)
+	{
+		EffectOwners.Add(EffectHandle, Owner);
+	}
+
+	FJoystickHapticCommand Command;
+	Command.Type = EJoystickHapticCommandType::CreateEffect;
+	Command.Backend = &Backend;
+	Command.DeviceId = DeviceId;
+	Command.EffectHandle = EffectHandle;
+	Command.Value = Priority;
+	Command.Effect = Effect;
+	Enqueue(MoveTemp(Command));
+
+	return EffectHandle;
+}
+
+bool FJoystickHapticThread::Enqueue(FJoystickHapticCommand&& Command)
+{
+	if (Command.Backend == nullptr)
+	{
+		return false;
+	}
+
+	const bool IsEffectCommand = Command.Type == EJoystickHapticCommandType::UpdateEffect
+		|| Command.Type == EJoystickHapticCommandType::RunEffect
+		|| Command.Type == EJoystickHapticCommandType::StopEffect
+		|| Command.Type == EJoystickHapticCommandType::DestroyEffect;
+	if (IsEffectCommand && !HasEffect(Command.EffectHandle))
+	{
+		return false;
+	}
+
+	if (Command.Type == EJoystickHapticCommandType::RunEffect)
+	{
+		// Assumed playing until the worker says otherwise, so a second start in the same frame is skipped
+		SetEffectStatus(Command.EffectHandle, 1);
+	}
+	else if (Command.Type == EJoystickHapticCommandType::DestroyEffect)
+	{
+		EffectOwners.Remove(Command.EffectHandle);
+	}
+
+	if (HasEffectData(Command.Type) && Command.Effect.type == SDL_HAPTIC_CUSTOM && Command.Effect.custom.data != nullptr)
+	{
+		Command.CustomData.Append(Command.Effect.custom.data, Command.Effect.custom.samples * Command.Effect.custom.channels);
+	}
+
+	PendingCommands.fetch_add(1, std::memory_order_relaxed);
+	Commands.Enqueue(MoveTemp(Command));
+	WakeEvent->Trigger();
+	return true;
+}
+
+bool FJoystickHapticThread::HasEffect(const int EffectHandle) const
+{
+	FScopeLock Lock(&EffectsLock);
+	return Effects.Contains(EffectHandle);
+}
+
+int FJoystickHapticThread::GetEffectStatus(const int EffectHandle) const
+{
+	FScopeLock Lock(&EffectsLock);
+	const FEffectSlot* Slot = Effects.Find(EffectHandle);
+	return Slot != nullptr ? Slot->Status : -1;
+}
+
+void FJoystickHapticThread::Flush()
+{
+	if (Thread == nullptr)
+	{
+		return;
+	}
+
+	// Rate limited updates are sent straight away while flushing
+	FlushRequested.store(true, std::memory_order_release);
+	WakeEvent->Trigger();
+	while (PendingCommands.load(std::memory_order_acquire) > 0)
+	{
+		FPlatformProcess::SleepNoStats(0.0001f);
+	}
+	FlushRequested.store(false, std::memory_order_release);
+}
+
+void FJoystickHapticThread::SetForceFeedbackLoop(FJoystickForceFeedbackLoop* InForceFeedbackLoop)
+{
+	FScopeLock Lock(&ForceFeedbackLoopLock);
+	ForceFeedbackLoop = InForceFeedbackLoop;
+}
+
+uint64 FJoystickHapticThread::GetCoalescedUpdateCount() const
+{
+	return CoalescedUpdates.load(std::memory_order_relaxed);
+}
+
+void FJoystickHapticThread::RemoveBackend(IJoystickBackend& Backend)
+{
+	// The mixers and pools destroy their effects while the backend can still take them
+	FJoystickHapticCommand Command;
+	Command.Type = EJoystickHapticCommandType::RemoveBackend;
+	Command.Backend = &Backend;
+	Enqueue(MoveTemp(Command));
+	Flush();
+
+	FScopeLock Lock(&EffectsLock);
+	for (auto It = Effects.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Backend == &Backend)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FJoystickHapticThread::RemoveDevice(IJoystickBackend& Backend, const int DeviceId)
+{
+	FJoystickHapticCommand Command;
+	Command.Type = EJoystickHapticCommandType::RemoveDevice;
+	Command.Backend = &Backend;
+	Command.DeviceId = DeviceId;
+	Enqueue(MoveTemp(Command));
+	Flush();
+
+	FScopeLock Lock(&EffectsLock);
+	for (auto It = Effects.CreateIterator(); It; ++It)
+	{
+		if (It.Value().Backend == &Backend && It.Value().DeviceId == DeviceId)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+bool FJoystickHapticThread::GetEffectPoolStats(const int DeviceId, FJoystickEffectPoolStats& OutStats) const
+{
+	FScopeLock Lock(&PoolStatsLock);
+	const FJoystickEffectPoolStats* Stats = PoolStats.Find(DeviceId);
+	if (Stats == nullptr)
+	{
+		return false;
+	}
+
+	OutStats = *Stats;
+	return true;
+}
+
+void FJoystickHapticThread::ProcessResults()
+{
+	int EffectHandle;
+	while (FailedCreations.Dequeue(EffectHandle))
+	{
+		TWeakObjectPtr<UForceFeedbackEffectBase> Owner;
+		if (!EffectOwners.RemoveAndCopyValue(EffectHandle, Owner) || !Owner.IsValid())
+		{
+			continue;
+		}
+
+		Owner->HandleEffectCreationFailed(EffectHandle);
+	}
+
+	while (EvictedEffects.Dequeue(EffectHandle))
+	{
+		TWeakObjectPtr<UForceFeedbackEffectBase> Owner;
+		if (!EffectOwners.RemoveAndCopyValue(EffectHandle, Owner) || !Owner.IsValid())
+		{
+			continue;
+		}
+
+		Owner->HandleEffectEvicted(EffectHandle);
+	}
+}
+
+uint32 FJoystickHapticThread::Run()
+{
+	bool EffectsPlaying = false;
+	double LastStatusPoll = 0.0;
+	uint32 WaitTime = MAX_uint32;
+
+	while (!StopRequested)
+	{
+		WakeEvent->Wait(WaitTime);
+
+		FJoystickHapticCommand Command;
+		while (Commands.Dequeue(Command))
+		{
+			// Updates held back by the rate limit stay pending until they are uploaded
+			if (Execute(Command))
+			{
+				PendingCommands.fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		const double Now = FPlatformTime::Seconds();
+		UploadPendingUpdates(Now, FlushRequested.load(std::memory_order_acquire));
+
+		if (IsMixing && Now >= NextMixTime)
+		{
+			NextMixTime = Now + MixerInterval;
+			MixEffects(Now);
+		}
+
+		if (Now - LastStatusPoll >= StatusPollIntervalMs / 1000.0)
+		{
+			LastStatusPoll = Now;
+			EffectsPlaying = PollEffectStatus();
+		}
+		else
+		{
+			EffectsPlaying = true;
+		}
+
+		WaitTime = EffectsPlaying ? StatusPollIntervalMs : MAX_uint32;
+		if (PendingUpdateOrder.Num() > 0)
+		{
+			WaitTime = FMath::Min(WaitTime, GetTimeUntilNextUpload(Now));
+		}
+
+		if (IsMixing)
+		{
+			WaitTime = FMath::Min(WaitTime, static_cast<uint32>(FMath::Max(0, FMath::CeilToInt(static_cast<float>((NextMixTime - Now) * 1000.0)))));
+		}
+	}
+
+	return 0;
+}
+
+void FJoystickHapticThread::Stop()
+{
+	StopRequested = true;
+	WakeEvent->Trigger();
+}
+
+bool FJoystickHapticThread::Execute(FJoystickHapticCommand& Command)
+{
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickHapticCommand);
+
+	if (Command.CustomData.Num() > 0)
+	{
+		Command.Effect.custom.data = Command.CustomData.GetData();
+	}
+
+	IJoystickBackend* Backend = Command.Backend;
+	int DeviceId = Command.DeviceId;
+
+	switch (Command.Type)
+	{
+		case EJoystickHapticCommandType::SetGain:
+			Backend->SetGain(DeviceId, Command.Value);
+			return true;
+		case EJoystickHapticCommandType::SetAutoCenter:
+			Backend->SetAutoCenter(DeviceId, Command.Value);
+			return true;
+		case EJoystickHapticCommandType::PauseHaptics:
+			Backend->PauseHaptics(DeviceId);
+			return true;
+		case EJoystickHapticCommandType::UnpauseHaptics:
+			Backend->UnpauseHaptics(DeviceId);
+			return true;
+		case EJoystickHapticCommandType::StopAllEffects:
+			Backend->StopAllEffects(DeviceId);
+			if (const TUniquePtr<FJoystickHapticMixer>* Mixer = Mixers.Find(DeviceId))
+			{
+				(*Mixer)->StopAllEffects();
+			}
+
+			{
+				FScopeLock Lock(&ForceFeedbackLoopLock);
+				if (ForceFeedbackLoop != nullptr)
+				{
+					ForceFeedbackLoop->RestartStream(DeviceId);
+				}
+			}
+			return true;
+		case EJoystickHapticCommandType::PlayRumble:
+			Backend->PlayRumble(DeviceId, Command.LowFrequency, Command.HighFrequency, Command.Duration);
+			return true;
+		case EJoystickHapticCommandType::StopRumble:
+			Backend->StopRumble(DeviceId);
+			return true;
+		case EJoystickHapticCommandType::RemoveBackend:
+			RemoveMixers(*Backend, -1);
+			RemovePools(*Backend, -1);
+			return true;
+		case EJoystickHapticCommandType::RemoveDevice:
+			RemoveMixers(*Backend, DeviceId);
+			RemovePools(*Backend, DeviceId);
+			return true;
+		case EJoystickHapticCommandType::RunTask:
+			Command.Task();
+			return true;
+		default:
+			break;
+	}
+
+	if (ExecuteMixed(Command))
+	{
+		return true;
+	}
+
+	// An update held back by the rate limit goes out before anything else the effect does
+	if (Command.Type != EJoystickHapticCommandType::UpdateEffect)
+	{
+		FinishPendingUpdate(Command.EffectHandle, Command.Type != EJoystickHapticCommandType::DestroyEffect);
+	}
+
+	int EffectId = -1;
+	if (!ResolveEffect(Command.EffectHandle, Backend, DeviceId, EffectId))
+	{
+		return true;
+	}
+
+	switch (Command.Type)
+	{
+		case EJoystickHapticCommandType::CreateEffect:
+		{
+			FJoystickHapticEffectPool& Pool = GetPool(*Backend, DeviceId);
+
+			const auto IsPlaying = [this](const int EffectHandle) { return GetEffectStatus(EffectHandle) == 1; };
+
+			int EvictedHandle = -1;
+			EffectId = Pool.Acquire(Command.EffectHandle, Command.Effect, Command.Value, IsPlaying, EvictedHandle);
+			PublishPoolStats(DeviceId, Pool);
+
+			if (EvictedHandle != -1)
+			{
+				EvictEffect(EvictedHandle);
+			}
+
+			FScopeLock Lock(&EffectsLock);
+			if (EffectId == -1)
+			{
+				Effects.Remove(Command.EffectHandle);
+				FailedCreations.Enqueue(Command.EffectHandle);
+				FJoystickLogManager::Get()->LogWarning(TEXT("Failed to create a haptic effect on device %d"), DeviceId);
+				return true;
+			}
+
+			if (FEffectSlot* Slot = Effects.Find(Command.EffectHandle))
+			{
+				Slot->EffectId = EffectId;
+			}
+			return true;
+		}
+		case EJoystickHapticCommandType::UpdateEffect:
+			return ScheduleUpdate(Command);
+		case EJoystickHapticCommandType::RunEffect:
+			if (EffectId == -1 || !Backend->RunEffect(DeviceId, EffectId, Command.Value))
+			{
+				SetEffectStatus(Command.EffectHandle, 0);
+			}
+			return true;
+		case EJoystickHapticCommandType::StopEffect:
+			if (EffectId != -1 && Backend->StopEffect(DeviceId, EffectId))
+			{
+				SetEffectStatus(Command.EffectHandle, 0);
+			}
+			return true;
+		case EJoystickHapticCommandType::DestroyEffect:
+		{
+			// The slot stays on the device for the next effect of the same type
+			if (const TUniquePtr<FJoystickHapticEffectPool>* Pool = Pools.Find(DeviceId))
+			{
+				(*Pool)->Release(Command.EffectHandle);
+				PublishPoolStats(DeviceId, **Pool);
+			}
+
+			FScopeLock Lock(&EffectsLock);
+			Effects.Remove(Command.EffectHandle);
+			return true;
+		}
+		default:
+			return true;
+	}
+}
+
+bool FJoystickHapticThread::ScheduleUpdate(FJoystickHapticCommand& Command)
+{
+	if (UploadInterval <= 0.0)
+	{
+		UploadEffect(Command);
+		return true;
+	}
+
+	// Latest value wins, the update it replaces is never sent
+	if (FJoystickHapticCommand* PendingUpdate = PendingUpdates.Find(Command.EffectHandle))
+	{
+		*PendingUpdate = MoveTemp(Command);
+		CoalescedUpdates.fetch_add(1, std::memory_order_relaxed);
+		INC_DWORD_STAT(STAT_JoystickHapticUpdatesCoalesced);
+		return true;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	double& NextUpload = NextUploadTimes.FindOrAdd(Command.DeviceId);
+	if (Now >= NextUpload)
+	{
+		NextUpload = Now + UploadInterval;
+		UploadEffect(Command);
+		return true;
+	}
+
+	PendingUpdateOrder.Add(Command.EffectHandle);
+	PendingUpdates.Add(Command.EffectHandle, MoveTemp(Command));
+	return false;
+}
+
+void FJoystickHapticThread::UploadPendingUpdates(const double Now, const bool Force)
+{
+	// In the order they were first held back, so one busy effect cannot starve the others on its device
+	for (int Index = 0; Index < PendingUpdateOrder.Num();)
+	{
+		const int EffectHandle = PendingUpdateOrder[Index];
+		FJoystickHapticCommand& PendingUpdate = PendingUpdates.FindChecked(EffectHandle);
+
+		double& NextUpload = NextUploadTimes.FindOrAdd(PendingUpdate.DeviceId);
+		if (!Force && Now < NextUpload)
+		{
+			Index++;
+			continue;
+		}
+
+		NextUpload = Now + UploadInterval;
+		UploadEffect(PendingUpdate);
+
+		PendingUpdates.Remove(EffectHandle);
+		PendingUpdateOrder.RemoveAt(Index);
+		PendingCommands.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void FJoystickHapticThread::FinishPendingUpdate(const int EffectHandle, const bool Upload)
+{
+	FJoystickHapticCommand PendingUpdate;
+	if (!PendingUpdates.RemoveAndCopyValue(EffectHandle, PendingUpdate))
+	{
+		return;
+	}
+
+	PendingUpdateOrder.Remove(EffectHandle);
+	if (Upload)
+	{
+		NextUploadTimes.FindOrAdd(PendingUpdate.DeviceId) = FPlatformTime::Seconds() + UploadInterval;
+		UploadEffect(PendingUpdate);
+	}
+
+	PendingCommands.fetch_sub(1, std::memory_order_release);
+}
+
+void FJoystickHapticThread::UploadEffect(FJoystickHapticCommand& Command)
+{
+	IJoystickBackend* Backend = nullptr;
+	int DeviceId = -1;
+	int EffectId = -1;
+	if (!ResolveEffect(Command.EffectHandle, Backend, DeviceId, EffectId) || EffectId == -1)
+	{
+		return;
+	}
+
+	if (Command.CustomData.Num() > 0)
+	{
+		Command.Effect.custom.data = Command.CustomData.GetData();
+	}
+
+	Backend->UpdateEffect(DeviceId, EffectId, Command.Effect);
+}
+
+uint32 FJoystickHapticThread::GetTimeUntilNextUpload(const double Now) const
+{
+	double NextUpload = MAX_dbl;
+	for (const int EffectHandle : PendingUpdateOrder)
+	{
+		const double* DeviceNextUpload = NextUploadTimes.Find(PendingUpdates.FindChecked(EffectHandle).DeviceId);
+		NextUpload = FMath::Min(NextUpload, DeviceNextUpload != nullptr ? *DeviceNextUpload : Now);
+	}
+
+	return static_cast<uint32>(FMath::Max(0, FMath::CeilToInt(static_cast<float>((NextUpload - Now) * 1000.0))));
+}
+
+bool FJoystickHapticThread::ExecuteMixed(FJoystickHapticCommand& Command)
+{
+	if (Command.Type == EJoystickHapticCommandType::CreateEffect)
+	{
+		if (MixerInterval <= 0.0 || !FJoystickHapticMixer::CanMix(Command.Effect))
+		{
+			return false;
+		}
+
+		TUniquePtr<FJoystickHapticMixer>& Mixer = Mixers.FindOrAdd(Command.DeviceId);
+		if (!Mixer.IsValid())
+		{
+			Mixer = MakeUnique<FJoystickHapticMixer>(*Command.Backend, Command.DeviceId);
+		}
+
+		Mixer->AddEffect(Command.EffectHandle, Command.Effect);
+		MixedEffects.Add(Command.EffectHandle, Command.DeviceId);
+		return true;
+	}
+
+	const int* DeviceId = MixedEffects.Find(Command.EffectHandle);
+	if (DeviceId == nullptr)
+	{
+		return false;
+	}
+
+	const int MixerDeviceId = *DeviceId;
+	TUniquePtr<FJoystickHapticMixer>* Mixer = Mixers.Find(MixerDeviceId);
+	if (Mixer == nullptr)
+	{
+		return true;
+	}
+
+	switch (Command.Type)
+	{
+		case EJoystickHapticCommandType::UpdateEffect:
+			(*Mixer)->UpdateEffect(Command.EffectHandle, Command.Effect);
+			break;
+		case EJoystickHapticCommandType::RunEffect:
+			(*Mixer)->RunEffect(Command.EffectHandle, Command.Value, FPlatformTime::Seconds());
+			break;
+		case EJoystickHapticCommandType::StopEffect:
+			(*Mixer)->StopEffect(Command.EffectHandle);
+			SetEffectStatus(Command.EffectHandle, 0);
+			break;
+		case EJoystickHapticCommandType::DestroyEffect:
+		{
+			(*Mixer)->RemoveEffect(Command.EffectHandle);
+			MixedEffects.Remove(Command.EffectHandle);
+
+			// The streaming effect only holds a hardware slot while the device has mixed effects
+			if ((*Mixer)->IsEmpty())
+			{
+				(*Mixer)->Shutdown();
+				Mixers.Remove(MixerDeviceId);
+			}
+
+			FScopeLock Lock(&EffectsLock);
+			Effects.Remove(Command.EffectHandle);
+			break;
+		}
+		default:
+			break;
+	}
+
+	IsMixing = Mixers.Num() > 0;
+	return true;
+}
+
+void FJoystickHapticThread::MixEffects(const double Now)
+{
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickHapticMix);
+
+	TArray<int> FinishedEffects;
+	bool NeedsMixing = false;
+	for (const TPair<int, TUniquePtr<FJoystickHapticMixer>>& Pair : Mixers)
+	{
+		NeedsMixing |= Pair.Value->Mix(Now, NextUploadTimes.FindOrAdd(Pair.Key), UploadInterval, FinishedEffects);
+	}
+
+	for (const int EffectHandle : FinishedEffects)
+	{
+		SetEffectStatus(EffectHandle, 0);
+	}
+
+	// Idle mixers are left alone until the next mixed command
+	IsMixing = NeedsMixing;
+}
+
+void FJoystickHapticThread::RemoveMixers(const IJoystickBackend& Backend, const int DeviceId)
+{
+	for (auto It = Mixers.CreateIterator(); It; ++It)
+	{
+		if (&It.Value()->GetBackend() != &Backend || (DeviceId != -1 && It.Key() != DeviceId))
+		{
+			continue;
+		}
+
+		It.Value()->Shutdown();
+		It.RemoveCurrent();
+	}
+
+	for (auto It = MixedEffects.CreateIterator(); It; ++It)
+	{
+		if (!Mixers.Contains(It.Value()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	IsMixing = Mixers.Num() > 0;
+}
+
+void FJoystickHapticThread::RemovePools(const IJoystickBackend& Backend, const int DeviceId)
+{
+	// Held back updates would otherwise be sent to the destroyed effects by the flush that follows
+	TArray<int, TInlineAllocator<16>> DroppedUpdates;
+	for (const TPair<int, FJoystickHapticCommand>& Pair : PendingUpdates)
+	{
+		if (Pair.Value.Backend == &Backend && (DeviceId == -1 || Pair.Value.DeviceId == DeviceId))
+		{
+			DroppedUpdates.Add(Pair.Key);
+		}
+	}
+
+	for (const int EffectHandle : DroppedUpdates)
+	{
+		FinishPendingUpdate(EffectHandle, false);
+	}
+
+	for (auto It = Pools.CreateIterator(); It; ++It)
+	{
+		if (&It.Value()->GetBackend() != &Backend || (DeviceId != -1 && It.Key() != DeviceId))
+		{
+			continue;
+		}
+
+		It.Value()->Shutdown();
+
+		{
+			FScopeLock Lock(&PoolStatsLock);
+			PoolStats.Remove(It.Key());
+		}
+
+		It.RemoveCurrent();
+	}
+}
+
+FJoystickHapticEffectPool& FJoystickHapticThread::GetPool(IJoystickBackend& Backend, const int DeviceId)
+{
+	TUniquePtr<FJoystickHapticEffectPool>& Pool = Pools.FindOrAdd(DeviceId);
+	if (!Pool.IsValid())
+	{
+		Pool = MakeUnique<FJoystickHapticEffectPool>(Backend, DeviceId, MaxFreeEffectSlots);
+	}
+
+	return *Pool;
+}
+
+void FJoystickHapticThread::PublishPoolStats(const int DeviceId, const FJoystickHapticEffectPool& Pool)
+{
+	FScopeLock Lock(&PoolStatsLock);
+	PoolStats.FindOrAdd(DeviceId) = Pool.GetStats();
+}
+
+void FJoystickHapticThread::EvictEffect(const int EffectHandle)
+{
+	// Its held back update would land in the slot's new effect
+	FinishPendingUpdate(EffectHandle, false);
+
+	{
+		FScopeLock Lock(&EffectsLock);
+		Effects.Remove(EffectHandle);
+	}
+
+	EvictedEffects.Enqueue(EffectHandle);
+}
+
+bool FJoystickHapticThread::PollEffectStatus()
+{
+	struct FPlayingEffect
+	{
+		int EffectHandle;
+		IJoystickBackend* Backend;
+		int DeviceId;
+		int EffectId;
+	};
+
+	// Copied out so the lock is not held while the device answers
+	TArray<FPlayingEffect, TInlineAllocator<16>> PlayingEffects;
+	{
+		FScopeLock Lock(&EffectsLock);
+		for (const TPair<int, FEffectSlot>& Pair : Effects)
+		{
+			if (Pair.Value.Status == 1 && Pair.Value.EffectId != -1)
+			{
+				PlayingEffects.Add({Pair.Key, Pair.Value.Backend, Pair.Value.DeviceId, Pair.Value.EffectId});
+			}
+		}
+	}
+
+	bool EffectsPlaying = false;
+	for (const FPlayingEffect& PlayingEffect : PlayingEffects)
+	{
+		// -1 when the device cannot report status, the effect then stops being polled
+		const int Status = PlayingEffect.Backend->GetEffectStatus(PlayingEffect.DeviceId, PlayingEffect.EffectId);
+		SetEffectStatus(PlayingEffect.EffectHandle, Status);
+		EffectsPlaying |= Status == 1;
+	}
+
+	return EffectsPlaying;
+}
+
+bool FJoystickHapticThread::ResolveEffect(const int EffectHandle, IJoystickBackend*& Backend, int& DeviceId, int& EffectId) const
+{
+	FScopeLock Lock(&EffectsLock);
+	const FEffectSlot* Slot = Effects.Find(EffectHandle);
+	if (Slot == nullptr)
+	{
+		return false;
+	}
+
+	Backend = Slot->Backend;
+	DeviceId = Slot->DeviceId;
+	EffectId = Slot->EffectId;
+	return true;
+}
+
+void FJoystickHapticThread::SetEffectStatus(const int EffectHandle, const int Status)
+{
+	FScopeLock Lock(&EffectsLock);
+	if (FEffectSlot* Slot = Effects.Find(EffectHandle))
+	{
+		Slot->Status = Status;
+	}
+}
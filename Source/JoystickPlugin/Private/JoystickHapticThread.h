@@ -0,0 +1,216 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "JoystickHapticEffectPool.h"
+#include "JoystickHapticMixer.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+#include <atomic>
+
+class FEvent;
+class FJoystickForceFeedbackLoop;
+class FRunnableThread;
+class IJoystickBackend;
+class UForceFeedbackEffectBase;
+
+enum class EJoystickHapticCommandType : uint8
+{
+	CreateEffect,
+	UpdateEffect,
+	RunEffect,
+	StopEffect,
+	DestroyEffect,
+	SetGain,
+	SetAutoCenter,
+	PauseHaptics,
+	UnpauseHaptics,
+	StopAllEffects,
+	PlayRumble,
+	StopRumble,
+	RemoveBackend,
+	RemoveDevice,
+	RunTask
+};
+
+struct FJoystickHapticCommand
+{
+	EJoystickHapticCommandType Type = EJoystickHapticCommandType::RunEffect;
+
+	// Resolved on the game thread, the backend outlives its commands because it is flushed before it is shut down
+	IJoystickBackend* Backend = nullptr;
+	int DeviceId = -1;
+
+	// A handle from FJoystickHapticThread::CreateEffect, not the backend's effect id
+	int EffectHandle = -1;
+
+	// Iterations, gain, auto center or the priority of a new effect depending on the command
+	int Value = 0;
+
+	float LowFrequency = 0.f;
+	float HighFrequency = 0.f;
+	float Duration = 0.f;
+
+	SDL_HapticEffect Effect;
+
+	// Owned copy of Effect.custom.data, the effect may rebuild its buffer before the command runs
+	TArray<Uint16> CustomData;
+
+	// Work that calls the backend on behalf of another thread, such as the force feedback loop's streaming effects
+	TFunction<void()> Task;
+};
+
+/**
+ * Runs haptic commands on a dedicated thread so that force feedback never blocks the game thread. On Linux every
+ * effect call is an ioctl to the driver and some wheels take milliseconds to answer.
+ *
+ * Effects are identified by handles handed out on the game thread as soon as they are created; the worker maps them
+ * to the backend's effect ids once the creation has run. Effect status is cached and refreshed by the worker while an
+ * effect is playing, so reading it never reaches the device. Failed creations are reported back to the owning effect
+ * from ProcessResults on the game thread.
+ *
+ * Effect updates are rate limited per device. An update that arrives before its device's next upload slot is held
+ * back, and a newer update for the same effect replaces it. Any other command for the effect sends it first.
+ *
+ * With the mixer enabled, constant, periodic and ramp effects never reach the device on their own. They are summed
+ * per device by FJoystickHapticMixer at the mixer rate and only the result is uploaded, within the same per device
+ * update rate limit.
+ *
+ * Every other effect gets its hardware slot from its device's FJoystickHapticEffectPool. Destroying an effect returns
+ * its slot to the pool, and an effect that loses its slot to one with a higher priority is told from ProcessResults.
+ */
+class FJoystickHapticThread final : public FRunnable
+{
+public:
+	/* MaxUpdateRate caps effect updates per device per second, 0 sends every update as it comes. MixerRate is how
+	 * often mixed effects are summed and sent, 0 disables the mixer. InMaxFreeEffectSlots is how many stopped slots
+	 * each device keeps for reuse. */
+	FJoystickHapticThread(const int MaxUpdateRate, const int MixerRate, const int InMaxFreeEffectSlots);
+	virtual ~FJoystickHapticThread() override;
+
+	/* Queues the creation and returns the effect's handle straight away */
+	int CreateEffect(IJoystickBackend& Backend, const int DeviceId, const SDL_HapticEffect& Effect, const int Priority, UForceFeedbackEffectBase* Owner);
+
+	/* Game thread. Queues a command, effect commands for an unknown handle are dropped */
+	bool Enqueue(FJoystickHapticCommand&& Command);
+
+	bool IsRunning() const { return Thread != nullptr; }
+
+	bool HasEffect(const int EffectHandle) const;
+
+	/* The last known status of an effect, -1 when the handle is unknown or the device cannot report it */
+	int GetEffectStatus(const int EffectHandle) const;
+
+	/* Blocks until every queued command has run */
+	void Flush();
+
+	/* Runs the backend's queued commands and forgets its effects, call before the backend shuts down */
+	void RemoveBackend(IJoystickBackend& Backend);
+
+	/* The same for a single device, call before the device is closed */
+	void RemoveDevice(IJoystickBackend& Backend, const int DeviceId);
+
+	/* Returns false when the device has no slot pool yet */
+	bool GetEffectPoolStats(const int DeviceId, FJoystickEffectPoolStats& OutStats) const;
+
+	/* Game thread. Force streams are restarted after their device stops all of its effects, pass nullptr before the
+	 * loop is destroyed. */
+	void SetForceFeedbackLoop(FJoystickForceFeedbackLoop* InForceFeedbackLoop);
+
+	/* Updates replaced by a newer one for the same effect before they were uploaded */
+	uint64 GetCoalescedUpdateCount() const;
+
+	/* Game thread, tells effects whose creation failed or whose slot was taken */
+	void ProcessResults();
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	struct FEffectSlot
+	{
+		IJoystickBackend* Backend = nullptr;
+		int DeviceId = -1;
+		int EffectId = -1;
+		int Status = 0;
+	};
+
+	/* Returns false when the command was held back and is still pending */
+	bool Execute(FJoystickHapticCommand& Command);
+
+	bool ScheduleUpdate(FJoystickHapticCommand& Command);
+	void UploadPendingUpdates(const double Now, const bool Force);
+	void FinishPendingUpdate(const int EffectHandle, const bool Upload);
+	void UploadEffect(FJoystickHapticCommand& Command);
+	uint32 GetTimeUntilNextUpload(const double Now) const;
+
+	/* Returns false when the effect is not mixed */
+	bool ExecuteMixed(FJoystickHapticCommand& Command);
+	void MixEffects(const double Now);
+
+	/* DeviceId -1 removes every device of the backend */
+	void RemoveMixers(const IJoystickBackend& Backend, const int DeviceId);
+	void RemovePools(const IJoystickBackend& Backend, const int DeviceId);
+
+	FJoystickHapticEffectPool& GetPool(IJoystickBackend& Backend, const int DeviceId);
+	void PublishPoolStats(const int DeviceId, const FJoystickHapticEffectPool& Pool);
+	void EvictEffect(const int EffectHandle);
+
+	/* Returns true while any effect is still playing */
+	bool PollEffectStatus();
+
+	bool ResolveEffect(const int EffectHandle, IJoystickBackend*& Backend, int& DeviceId, int& EffectId) const;
+	void SetEffectStatus(const int EffectHandle, const int Status);
+
+	TQueue<FJoystickHapticCommand, EQueueMode::Mpsc> Commands;
+	std::atomic<int> PendingCommands;
+	std::atomic<bool> FlushRequested;
+	FEvent* WakeEvent;
+
+	// Written by both threads, never held across a backend call
+	TMap<int, FEffectSlot> Effects;
+	mutable FCriticalSection EffectsLock;
+
+	// Game thread only
+	int NextEffectHandle;
+	TMap<int, TWeakObjectPtr<UForceFeedbackEffectBase>> EffectOwners;
+
+	TQueue<int, EQueueMode::Spsc> FailedCreations;
+	TQueue<int, EQueueMode::Spsc> EvictedEffects;
+
+	// Worker only. Updates waiting for their device's next upload slot, by effect handle, and when each device may
+	// next be sent an update.
+	double UploadInterval;
+	TMap<int, FJoystickHapticCommand> PendingUpdates;
+	TArray<int> PendingUpdateOrder;
+	TMap<int, double> NextUploadTimes;
+	std::atomic<uint64> CoalescedUpdates;
+
+	// Worker only. One mixer per device with mixed effects, and the device each mixed effect handle plays on.
+	double MixerInterval;
+	double NextMixTime;
+	bool IsMixing;
+	TMap<int, TUniquePtr<FJoystickHapticMixer>> Mixers;
+	TMap<int, int> MixedEffects;
+
+	// Worker only. One slot pool per device, with a copy of each pool's stats for the game thread.
+	int MaxFreeEffectSlots;
+	TMap<int, TUniquePtr<FJoystickHapticEffectPool>> Pools;
+	TMap<int, FJoystickEffectPoolStats> PoolStats;
+	mutable FCriticalSection PoolStatsLock;
+
+	// Held while the worker restarts force streams, so the loop is never used once it has been cleared
+	FJoystickForceFeedbackLoop* ForceFeedbackLoop;
+	FCriticalSection ForceFeedbackLoopLock;
+
+	FThreadSafeBool StopRequested;
+	FRunnableThread* Thread;
+};
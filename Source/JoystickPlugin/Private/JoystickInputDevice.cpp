@@ -2,16 +2,39 @@
 // Copyright Jayden Maalouf. All Rights Reserved.
 
 #include "JoystickInputDevice.h"
+#include "JoystickAxisKernel.h"
+#include "JoystickDeviceCache.h"
 #include "JoystickFunctionLibrary.h"
 #include "JoystickHapticDeviceManager.h"
 #include "JoystickInputSettings.h"
 #include "JoystickLogManager.h"
+#include "JoystickStats.h"
 #include "JoystickSubsystem.h"
 #include "GameFramework/InputSettings.h"
 #include "Runtime/Launch/Resources/Version.h"
 
-FJoystickInputDevice::FJoystickInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler) : MessageHandler(InMessageHandler)
+UE_TRACE_EVENT_BEGIN(Joystick, DeviceAdded)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(int32, DeviceId)
+	UE_TRACE_EVENT_FIELD(int32, AxisCount)
+	UE_TRACE_EVENT_FIELD(int32, ButtonCount)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(Joystick, DeviceRemoved)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(int32, DeviceId)
+UE_TRACE_EVENT_END()
+
+FJoystickInputDevice::FJoystickInputDevice(const TSharedRef<FGenericApplicationMessageHandler>& InMessageHandler)
+	: OnlyDispatchChangedAnalogValues(false)
+	  , SuppressedAnalogDispatches(0)
+	  , DroppedInputEvents(0)
+	  , MessageHandler(InMessageHandler)
 {
+	for (std::atomic<FJoystickInputEventQueue*>& EventQueue : PublishedEventQueues)
+	{
+		EventQueue.store(nullptr, std::memory_order_relaxed);
+	}
 }
 
 void FJoystickInputDevice::Tick(float DeltaTime)
@@ -65,138 +88,249 @@ void FJoystickInputDevice::SetMessageHandler(const TSharedRef<FGenericApplicatio
 
 #define LOCTEXT_NAMESPACE "JoystickNamespace"
 
-void FJoystickInputDevice::InitialiseAxis(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName)
-{
-	DeviceAxisKeys.Emplace(DeviceId);
-
-	const int AxisCount = JoystickState.Axes.Num();
-	DeviceAxisKeys[DeviceId].SetNum(AxisCount);
-	for (int AxisKeyIndex = 0; AxisKeyIndex < AxisCount; AxisKeyIndex++)
-	{
-		FString AxisKeyName = FString::Printf(TEXT("%s_Axis%d"), *BaseKeyName, AxisKeyIndex);
-		FString AxisDisplayName = FString::Printf(TEXT("%s Axis %d"), *BaseDisplayName, AxisKeyIndex);
-
-		FKey AxisKey = FKey(FName(*AxisKeyName));
 #if (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26 || ENGINE_MAJOR_VERSION > 4)
-		FKeyDetails AxisKeyDetails = FKeyDetails(AxisKey, FText::FromString(AxisDisplayName), FKeyDetails::GamepadKey | FKeyDetails::Axis1D);
+static const uint32 JoystickAnalogKeyFlags = FKeyDetails::GamepadKey | FKeyDetails::Axis1D;
 #else
-		FKeyDetails AxisKeyDetails = FKeyDetails(AxisKey, FText::FromString(AxisDisplayName), FKeyDetails::GamepadKey | FKeyDetails::FloatAxis);
+static const uint32 JoystickAnalogKeyFlags = FKeyDetails::GamepadKey | FKeyDetails::FloatAxis;
 #endif
 
-		if (!EKeys::GetKeyDetails(AxisKey).IsValid())
-		{
-			EKeys::AddKey(AxisKeyDetails);
-			FJoystickLogManager::Get()->LogDebug(TEXT("Added Key %s (%s) %i"), *AxisKeyName, *AxisDisplayName, DeviceId);
-		}
+void FJoystickInputDevice::InitialiseAxis(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName)
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
+	{
+		return;
+	}
 
-		const FKey& MappedKey = AxisKeyDetails.GetKey();
-		DeviceAxisKeys[DeviceId][AxisKeyIndex] = MappedKey;
-		DeviceKeys[DeviceId].Add(MappedKey);
+	for (int AxisKeyIndex = 0; AxisKeyIndex < Device->AxisCount; AxisKeyIndex++)
+	{
+		KeyNameBuffer.Reset();
+		KeyNameBuffer += BaseKeyName;
+		KeyNameBuffer += TEXT("_Axis");
+		KeyNameBuffer.AppendInt(AxisKeyIndex);
+
+		DisplayNameBuffer.Reset();
+		DisplayNameBuffer += BaseDisplayName;
+		DisplayNameBuffer += TEXT(" Axis ");
+		DisplayNameBuffer.AppendInt(AxisKeyIndex);
+
+		QueueKey(FJoystickKeyInfo(DeviceId, EJoystickInputEventType::Axis, AxisKeyIndex, 0), JoystickAnalogKeyFlags);
 	}
 }
 
-void FJoystickInputDevice::InitialiseButtons(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName)
+void FJoystickInputDevice::InitialiseButtons(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName)
 {
-	DeviceButtonKeys.Emplace(DeviceId);
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
+	{
+		return;
+	}
 
-	const int ButtonCount = JoystickState.Buttons.Num();
-	DeviceButtonKeys[DeviceId].SetNum(ButtonCount);
-	for (int ButtonKeyIndex = 0; ButtonKeyIndex < ButtonCount; ButtonKeyIndex++)
+	for (int ButtonKeyIndex = 0; ButtonKeyIndex < Device->ButtonCount; ButtonKeyIndex++)
 	{
-		FString ButtonKeyName = FString::Printf(TEXT("%s_Button%d"), *BaseKeyName, ButtonKeyIndex);
-		FString ButtonDisplayName = FString::Printf(TEXT("%s Button %d"), *BaseDisplayName, ButtonKeyIndex);
+		KeyNameBuffer.Reset();
+		KeyNameBuffer += BaseKeyName;
+		KeyNameBuffer += TEXT("_Button");
+		KeyNameBuffer.AppendInt(ButtonKeyIndex);
 
-		const FKey ButtonKey = FKey(FName(*ButtonKeyName));
-		FKeyDetails ButtonKeyDetails = FKeyDetails(ButtonKey, FText::FromString(ButtonDisplayName), FKeyDetails::GamepadKey);
+		DisplayNameBuffer.Reset();
+		DisplayNameBuffer += BaseDisplayName;
+		DisplayNameBuffer += TEXT(" Button ");
+		DisplayNameBuffer.AppendInt(ButtonKeyIndex);
 
-		if (!EKeys::GetKeyDetails(ButtonKey).IsValid())
+		QueueKey(FJoystickKeyInfo(DeviceId, EJoystickInputEventType::Button, ButtonKeyIndex, 0), FKeyDetails::GamepadKey);
+	}
+}
+
+void FJoystickInputDevice::InitialiseHats(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName)
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
+	{
+		return;
+	}
+
+	for (int HatIndex = 0; HatIndex < 2; HatIndex++)
+	{
+		const FString& HatAxisName = AxisNames[HatIndex];
+		for (int HatKeyIndex = 0; HatKeyIndex < Device->HatCount; HatKeyIndex++)
 		{
-			EKeys::AddKey(ButtonKeyDetails);
-			FJoystickLogManager::Get()->LogDebug(TEXT("Added Button %s (%s) %i"), *ButtonKeyName, *ButtonDisplayName, DeviceId);
+			KeyNameBuffer.Reset();
+			KeyNameBuffer += BaseKeyName;
+			KeyNameBuffer += TEXT("_Hat");
+			KeyNameBuffer.AppendInt(HatKeyIndex);
+			KeyNameBuffer += TEXT("_");
+			KeyNameBuffer += HatAxisName;
+
+			DisplayNameBuffer.Reset();
+			DisplayNameBuffer += BaseDisplayName;
+			DisplayNameBuffer += TEXT(" Hat ");
+			DisplayNameBuffer.AppendInt(HatIndex);
+			DisplayNameBuffer += TEXT(" ");
+			DisplayNameBuffer += HatAxisName;
+
+			QueueKey(FJoystickKeyInfo(DeviceId, EJoystickInputEventType::Hat, HatKeyIndex, HatIndex), JoystickAnalogKeyFlags);
 		}
-
-		const FKey& MappedKey = ButtonKeyDetails.GetKey();
-		DeviceButtonKeys[DeviceId][ButtonKeyIndex] = MappedKey;
-		DeviceKeys[DeviceId].Add(MappedKey);
 	}
 }
 
-void FJoystickInputDevice::InitialiseHats(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName)
+void FJoystickInputDevice::InitialiseBalls(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName)
 {
-	for (int HatIndex = 0; HatIndex < 2; HatIndex++)
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
 	{
-		FString HatAxisName = *AxisNames[HatIndex];
-		DeviceHatKeys[HatIndex].Emplace(DeviceId);
+		return;
+	}
 
-		int HatCount = JoystickState.Hats.Num();
-		DeviceHatKeys[HatIndex][DeviceId].SetNum(HatCount);
-		for (int HatKeyIndex = 0; HatKeyIndex < HatCount; HatKeyIndex++)
+	for (int BallIndex = 0; BallIndex < 2; BallIndex++)
+	{
+		const FString& BallAxisName = AxisNames[BallIndex];
+		for (int BallKeyIndex = 0; BallKeyIndex < Device->BallCount; BallKeyIndex++)
 		{
-			FString HatKeyName = FString::Printf(TEXT("%s_Hat%d_%s"), *BaseKeyName, HatKeyIndex, *HatAxisName);
-			FString HatDisplayName = FString::Printf(TEXT("%s Hat %d %s"), *BaseDisplayName, HatIndex, *HatAxisName);
+			KeyNameBuffer.Reset();
+			KeyNameBuffer += BaseKeyName;
+			KeyNameBuffer += TEXT("_Ball");
+			KeyNameBuffer.AppendInt(BallKeyIndex);
+			KeyNameBuffer += TEXT("_");
+			KeyNameBuffer += BallAxisName;
+
+			DisplayNameBuffer.Reset();
+			DisplayNameBuffer += BaseDisplayName;
+			DisplayNameBuffer += TEXT(" Ball ");
+			DisplayNameBuffer.AppendInt(BallIndex);
+			DisplayNameBuffer += TEXT(" ");
+			DisplayNameBuffer += BallAxisName;
+
+			QueueKey(FJoystickKeyInfo(DeviceId, EJoystickInputEventType::Ball, BallKeyIndex, BallIndex), JoystickAnalogKeyFlags);
+		}
+	}
+}
 
-			FKey HatKey = FKey(FName(*HatKeyName));
-#if (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26 || ENGINE_MAJOR_VERSION > 4)
-			FKeyDetails HatKeyDetails = FKeyDetails(HatKey, FText::FromString(HatDisplayName), FKeyDetails::GamepadKey | FKeyDetails::Axis1D);
-#else
-			FKeyDetails HatKeyDetails = FKeyDetails(HatKey, FText::FromString(HatDisplayName), FKeyDetails::GamepadKey | FKeyDetails::FloatAxis);
-#endif
+void FJoystickInputDevice::QueueKey(const FJoystickKeyInfo& KeyInfo, const uint32 KeyFlags)
+{
+	const FKey Key = FKey(FName(*KeyNameBuffer));
+	PendingKeys.Emplace(FKeyDetails(Key, FText::FromString(DisplayNameBuffer), KeyFlags), KeyInfo, KeyFlags);
+}
 
-			if (!EKeys::GetKeyDetails(HatKey).IsValid())
-			{
-				EKeys::AddKey(HatKeyDetails);
-				FJoystickLogManager::Get()->LogDebug(TEXT("Added Hat %s (%s) %i"), *HatKeyName, *HatDisplayName, DeviceId);
-			}
+void FJoystickInputDevice::QueueCachedKey(const FJoystickCachedKey& CachedKey, const int DeviceId)
+{
+	const FKey Key = FKey(FName(*CachedKey.Name));
+	const FJoystickKeyInfo KeyInfo(DeviceId, CachedKey.Type, CachedKey.Index, CachedKey.Component);
+	PendingKeys.Emplace(FKeyDetails(Key, FText::FromString(CachedKey.DisplayName), CachedKey.Flags), KeyInfo, CachedKey.Flags);
+}
 
-			const FKey& MappedKey = HatKeyDetails.GetKey();
-			DeviceHatKeys[HatIndex][DeviceId][HatKeyIndex] = HatKeyDetails.GetKey();
-			DeviceKeys[DeviceId].Add(MappedKey);
+void FJoystickInputDevice::RegisterCachedKeys(const FJoystickDeviceCache& DeviceCache)
+{
+	for (const FJoystickCachedDevice& CachedDevice : DeviceCache.GetDevices())
+	{
+		// No device owns these yet, they are only registered with the engine until it attaches
+		for (const FJoystickCachedKey& CachedKey : CachedDevice.Keys)
+		{
+			QueueCachedKey(CachedKey, -1);
 		}
 	}
 }
 
-void FJoystickInputDevice::InitialiseBalls(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName)
+void FJoystickInputDevice::AssignKey(const FJoystickKeyInfo& KeyInfo, const FName& KeyName)
 {
-	for (int BallIndex = 0; BallIndex < 2; BallIndex++)
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(KeyInfo.DeviceId);
+	if (Device == nullptr)
 	{
-		FString BallAxisName = *AxisNames[BallIndex];
-		DeviceBallKeys[BallIndex].Emplace(DeviceId);
+		return;
+	}
 
-		int BallCount = JoystickState.Balls.Num();
-		DeviceBallKeys[BallIndex][DeviceId].SetNum(BallCount);
-		for (int BallKeyIndex = 0; BallKeyIndex < BallCount; BallKeyIndex++)
-		{
-			FString BallKeyName = FString::Printf(TEXT("%s_Ball%d_%s"), *BaseKeyName, BallKeyIndex, *BallAxisName);
-			FString BallDisplayName = FString::Printf(TEXT("%s Ball %d %s"), *BaseDisplayName, BallIndex, *BallAxisName);
+	switch (KeyInfo.Type)
+	{
+		case EJoystickInputEventType::Axis:
+			DeviceStore.AxisKeys[Device->AxisOffset + KeyInfo.Index] = KeyName;
+			break;
+		case EJoystickInputEventType::Button:
+			DeviceStore.ButtonKeys[Device->ButtonOffset + KeyInfo.Index] = KeyName;
+			break;
+		case EJoystickInputEventType::Hat:
+			DeviceStore.HatKeys[(Device->HatOffset + KeyInfo.Index) * 2 + KeyInfo.Component] = KeyName;
+			break;
+		case EJoystickInputEventType::Ball:
+			DeviceStore.BallKeys[(Device->BallOffset + KeyInfo.Index) * 2 + KeyInfo.Component] = KeyName;
+			break;
+		default:
+			return;
+	}
 
-			FKey BallKey = FKey(FName(*BallKeyName));
-#if (ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 26 || ENGINE_MAJOR_VERSION > 4)
-			FKeyDetails BallKeyDetails = FKeyDetails(BallKey, FText::FromString(BallDisplayName), FKeyDetails::GamepadKey | FKeyDetails::Axis1D);
-#else
-			FKeyDetails BallKeyDetails = FKeyDetails(BallKey, FText::FromString(BallDisplayName), FKeyDetails::GamepadKey | FKeyDetails::FloatAxis);
-#endif
+	KeyInfos.Add(KeyName, KeyInfo);
+}
 
-			if (!EKeys::GetKeyDetails(BallKey).IsValid())
-			{
-				EKeys::AddKey(BallKeyDetails);
-				FJoystickLogManager::Get()->LogDebug(TEXT("Added Ball %s (%s) %i"), *BallKeyName, *BallDisplayName, DeviceId);
-			}
+void FJoystickInputDevice::RegisterPendingKeys()
+{
+	if (PendingKeys.Num() == 0)
+	{
+		return;
+	}
+
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickRegisterKeys);
+
+	const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
+	const double Budget = IsValid(JoystickInputSettings) ? JoystickInputSettings->KeyRegistrationBudget / 1000.0 : 0.0;
+	const double StartTime = FPlatformTime::Seconds();
 
-			const FKey& MappedKey = BallKeyDetails.GetKey();
-			DeviceBallKeys[BallIndex][DeviceId][BallKeyIndex] = BallKeyDetails.GetKey();
-			DeviceKeys[DeviceId].Add(MappedKey);
+	while (PendingKeyIndex < PendingKeys.Num())
+	{
+		const FJoystickPendingKey& PendingKey = PendingKeys[PendingKeyIndex++];
+		const FKey& Key = PendingKey.Details.GetKey();
+		if (!EKeys::GetKeyDetails(Key).IsValid())
+		{
+			EKeys::AddKey(PendingKey.Details);
+			PendingKeysAdded = true;
+			FJoystickLogManager::Get()->LogDebug(TEXT("Added Key %s (%s) %i"), *Key.ToString(), *PendingKey.Details.GetDisplayName().ToString(), PendingKey.KeyInfo.DeviceId);
 		}
+
+		AssignKey(PendingKey.KeyInfo, Key.GetFName());
+
+		// Checking the clock every few keys is enough, a single AddKey is cheap
+		if (Budget > 0.0 && PendingKeyIndex % 16 == 0 && FPlatformTime::Seconds() - StartTime >= Budget)
+		{
+			return;
+		}
+	}
+
+	PendingKeys.Reset();
+	PendingKeyIndex = 0;
+
+	// Rebuilt once for the whole batch instead of once per connected device, and not at all when every key was known
+	UInputSettings* InputSettings = UInputSettings::GetInputSettings();
+	if (PendingKeysAdded && IsValid(InputSettings))
+	{
+		InputSettings->PostInitProperties();
 	}
+	PendingKeysAdded = false;
+
+	UpdateAxisProperties();
 }
 
-void FJoystickInputDevice::InitialiseInputDevice(const FDeviceInfoSDL& Device)
+void FJoystickInputDevice::InitialiseEventQueue(const int DeviceId)
 {
-	UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
-	if (!IsValid(JoystickSubsystem))
+	if (DeviceEventQueues.Contains(DeviceId))
 	{
 		return;
 	}
 
+	const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
+	const int QueueSize = IsValid(JoystickInputSettings) ? FMath::Max(JoystickInputSettings->InputEventQueueSize, 16) : 1024;
+
+	const TSharedPtr<FJoystickInputEventQueue> EventQueue = MakeShared<FJoystickInputEventQueue>(QueueSize);
+	{
+		FScopeLock Lock(&DeviceEventQueuesLock);
+		DeviceEventQueues.Emplace(DeviceId, EventQueue);
+	}
+
+	if (DeviceId >= 0 && DeviceId < MaxPublishedEventQueues)
+	{
+		PublishedEventQueues[DeviceId].store(EventQueue.Get(), std::memory_order_release);
+	}
+}
+
+void FJoystickInputDevice::InitialiseInputDevice(const FDeviceInfoSDL& Device)
+{
 	int DeviceId = Device.DeviceId;
 	FJoystickInfo DeviceInfo;
 
@@ -206,15 +340,19 @@ void FJoystickInputDevice::InitialiseInputDevice(const FDeviceInfoSDL& Device)
 	DeviceInfo.IsGamepad = Device.IsGamepad;
 	DeviceInfo.HasRumble = Device.HasRumble;
 
-	JoystickSubsystem->GetDeviceIndexGuid(Device.DeviceIndex, DeviceInfo.ProductId);
+	DeviceInfo.ProductId = Device.ProductId;
 	DeviceInfo.ProductName = Device.DeviceName.Replace(TEXT("."), TEXT("")).Replace(TEXT(","), TEXT(""));
 	DeviceInfo.DeviceName = DeviceInfo.ProductName.Replace(TEXT(" "), TEXT(""));
 
 	FJoystickLogManager::Get()->LogInformation(TEXT("Added device %s %i"), *DeviceInfo.DeviceName, DeviceId);
 	JoystickDeviceInfo.Emplace(DeviceId, DeviceInfo);
 
-	const FJoystickDeviceData InitialState = JoystickSubsystem->CreateInitialDeviceState(DeviceId);
-	const FJoystickDeviceData& JoystickState = JoystickDeviceData.Emplace(DeviceId, InitialState);
+	const int Slot = DeviceStore.AddDevice(DeviceId, Device.AxisCount, Device.ButtonCount, Device.HatCount, Device.BallCount);
+	DeviceStore.Slots[Slot].Connected = true;
+	DeviceStore.Slots[Slot].Player = DeviceInfo.Player;
+	DeviceStore.DeviceNames[Slot] = DeviceInfo.DeviceName;
+	InitialiseEventQueue(DeviceId);
+
 	UJoystickInputSettings* JoystickInputSettings = GetMutableDefault<UJoystickInputSettings>();
 	if (!IsValid(JoystickInputSettings))
 	{
@@ -239,29 +377,64 @@ void FJoystickInputDevice::InitialiseInputDevice(const FDeviceInfoSDL& Device)
 		}
 	}
 
-	DeviceKeys.Emplace(DeviceId);
+	// A device seen on a previous run reuses its key names, as long as the device and the naming still match
+	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
+	FJoystickDeviceCache* DeviceCache = IsValid(JoystickSubsystem) && !Device.IsReplayed ? JoystickSubsystem->GetDeviceCache() : nullptr;
+	FJoystickCachedDevice* CachedDevice = DeviceCache != nullptr ? DeviceCache->Find(Device.ProductId, Device.DeviceName, DeviceId) : nullptr;
+	if (CachedDevice != nullptr
+		&& CachedDevice->DeviceId == DeviceId
+		&& CachedDevice->AxisCount == Device.AxisCount
+		&& CachedDevice->ButtonCount == Device.ButtonCount
+		&& CachedDevice->HatCount == Device.HatCount
+		&& CachedDevice->BallCount == Device.BallCount
+		&& CachedDevice->BaseKeyName == BaseKeyName
+		&& CachedDevice->BaseDisplayName == BaseDisplayName)
+	{
+		for (const FJoystickCachedKey& CachedKey : CachedDevice->Keys)
+		{
+			QueueCachedKey(CachedKey, DeviceId);
+		}
 
-	// create FKeyDetails for axis
-	InitialiseAxis(DeviceId, JoystickState, BaseKeyName, BaseDisplayName);
+		DeviceCache->MarkAttached(*CachedDevice);
+	}
+	else
+	{
+		const int FirstPendingKey = PendingKeys.Num();
 
-	// create FKeyDetails for buttons
-	InitialiseButtons(DeviceId, JoystickState, BaseKeyName, BaseDisplayName);
+		// create FKeyDetails for axis
+		InitialiseAxis(DeviceId, BaseKeyName, BaseDisplayName);
 
-	// create FKeyDetails for hats
-	InitialiseHats(DeviceId, JoystickState, BaseKeyName, BaseDisplayName);
+		// create FKeyDetails for buttons
+		InitialiseButtons(DeviceId, BaseKeyName, BaseDisplayName);
 
-	// create FKeyDetails for balls
-	InitialiseBalls(DeviceId, JoystickState, BaseKeyName, BaseDisplayName);
+		// create FKeyDetails for hats
+		InitialiseHats(DeviceId, BaseKeyName, BaseDisplayName);
 
-	JoystickInputSettings->DeviceAdded(FJoystickInputDeviceInformation(DeviceInfo));
+		// create FKeyDetails for balls
+		InitialiseBalls(DeviceId, BaseKeyName, BaseDisplayName);
 
-	UInputSettings* InputSettings = UInputSettings::GetInputSettings();
-	if (IsValid(InputSettings))
-	{
-		InputSettings->PostInitProperties();
+		if (DeviceCache != nullptr)
+		{
+			TArray<FJoystickCachedKey> CachedKeys;
+			CachedKeys.Reserve(PendingKeys.Num() - FirstPendingKey);
+			for (int i = FirstPendingKey; i < PendingKeys.Num(); i++)
+			{
+				const FJoystickPendingKey& PendingKey = PendingKeys[i];
+
+				FJoystickCachedKey& CachedKey = CachedKeys.AddDefaulted_GetRef();
+				CachedKey.Name = PendingKey.Details.GetKey().ToString();
+				CachedKey.DisplayName = PendingKey.Details.GetDisplayName().ToString();
+				CachedKey.Flags = PendingKey.KeyFlags;
+				CachedKey.Type = PendingKey.KeyInfo.Type;
+				CachedKey.Index = PendingKey.KeyInfo.Index;
+				CachedKey.Component = PendingKey.KeyInfo.Component;
+			}
+
+			DeviceCache->Store(Device, BaseKeyName, BaseDisplayName, MoveTemp(CachedKeys));
+		}
 	}
 
-	UpdateAxisProperties();
+	JoystickInputSettings->DeviceAdded(FJoystickInputDeviceInformation(DeviceInfo));
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -272,14 +445,39 @@ void FJoystickInputDevice::JoystickPluggedIn(const FDeviceInfoSDL& Device)
 {
 	FJoystickLogManager::Get()->LogDebug(TEXT("FJoystickPlugin::JoystickPluggedIn() %i"), Device.DeviceId);
 
+	UE_TRACE_LOG(Joystick, DeviceAdded, JoystickChannel)
+		<< DeviceAdded.Cycle(FPlatformTime::Cycles64())
+		<< DeviceAdded.DeviceId(Device.DeviceId)
+		<< DeviceAdded.AxisCount(Device.AxisCount)
+		<< DeviceAdded.ButtonCount(Device.ButtonCount);
+	INC_DWORD_STAT(STAT_JoystickConnectedDevices);
+
 	InitialiseInputDevice(Device);
 }
 
 void FJoystickInputDevice::JoystickUnplugged(const int DeviceId)
 {
 	FJoystickInfo& InputDevice = JoystickDeviceInfo[DeviceId];
+	if (InputDevice.Connected)
+	{
+		UE_TRACE_LOG(Joystick, DeviceRemoved, JoystickChannel)
+			<< DeviceRemoved.Cycle(FPlatformTime::Cycles64())
+			<< DeviceRemoved.DeviceId(DeviceId);
+		DEC_DWORD_STAT(STAT_JoystickConnectedDevices);
+	}
+
 	InputDevice.Connected = false;
 
+	if (FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId))
+	{
+		Device->Connected = false;
+	}
+
+	if (FJoystickDeviceLatency* Latency = DeviceLatencies.Find(DeviceId))
+	{
+		Latency->PendingSamples.Reset();
+	}
+
 	UJoystickInputSettings* JoystickInputSettings = GetMutableDefault<UJoystickInputSettings>();
 	if (!IsValid(JoystickInputSettings))
 	{
@@ -291,84 +489,249 @@ void FJoystickInputDevice::JoystickUnplugged(const int DeviceId)
 
 void FJoystickInputDevice::JoystickButton(const int DeviceId, const int Button, const bool Pressed)
 {
-	if (!JoystickDeviceData.Contains(DeviceId))
+	const int Slot = DeviceStore.FindSlot(DeviceId);
+	if (Slot == INDEX_NONE)
+	{
+		return;
+	}
+
+	FJoystickDeviceSlot& Device = DeviceStore.Slots[Slot];
+	if (Button < 0 || Button >= Device.ButtonCount)
 	{
 		return;
 	}
 
-	FJoystickDeviceData& DeviceData = JoystickDeviceData[DeviceId];
-	if (!DeviceData.Buttons.IsValidIndex(Button))
+	const int WordIndex = Device.ButtonWordOffset + (Button >> 6);
+	const uint64 ButtonBit = FJoystickDeviceStore::GetButtonBit(Button);
+	uint64& ButtonWord = DeviceStore.ButtonWords[WordIndex];
+	if (((ButtonWord & ButtonBit) != 0) == Pressed)
 	{
 		return;
 	}
 
-	FButtonData& State = DeviceData.Buttons[Button];
-	State.PreviousButtonState = State.ButtonState;
-	State.ButtonState = Pressed;
+	// Already changed since the last dispatch, so it is toggling back and diffing the masks would miss both edges
+	if (((ButtonWord ^ DeviceStore.PreviousButtonWords[WordIndex]) & ButtonBit) != 0)
+	{
+		Device.ReplayButtonEdges = true;
+	}
+
+	// PreviousButtonWords keeps the state of the last dispatch, every edge in between is logged
+	ButtonWord ^= ButtonBit;
+	DeviceStore.ButtonEdges[Slot].Emplace(Button, Pressed);
 }
 
-void FJoystickInputDevice::JoystickAxis(const int DeviceId, const int Axis, const float Value)
+void FJoystickInputDevice::JoystickAxis(const int DeviceId, const int Axis, const float Value, const double Timestamp)
 {
-	if (!JoystickDeviceData.Contains(DeviceId))
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr || Axis < 0 || Axis >= Device->AxisCount)
 	{
 		return;
 	}
 
-	FJoystickDeviceData& DeviceData = JoystickDeviceData[DeviceId];
-	if (!DeviceData.Axes.IsValidIndex(Axis))
+	// PreviousAxisValues keeps the value of the last frame, every sample in between is summarised in AxisSamples
+	const int Index = Device->AxisOffset + Axis;
+	const float FilteredValue = DeviceStore.FilterAxisValue(Index, Value, Timestamp);
+	DeviceStore.AxisValues[Index] = FilteredValue;
+	const float MappedValue = DeviceStore.RemapAxisValue(Index, FilteredValue);
+	DeviceStore.AxisSamples[Index].Add(MappedValue);
+	DeviceStore.AxisPredictors[Index].AddSample(MappedValue, Timestamp);
+}
+
+void FJoystickInputDevice::JoystickHat(const int DeviceId, const int Hat, const EJoystickPOVDirection Value)
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr || Hat < 0 || Hat >= Device->HatCount)
 	{
 		return;
 	}
 
-	FAxisData& State = DeviceData.Axes[Axis];
-	State.PreviousValue = State.Value;
-	State.Value = Value;
+	DeviceStore.HatDirections[Device->HatOffset + Hat] = Value;
 }
 
-void FJoystickInputDevice::JoystickHat(const int DeviceId, const int Hat, const EJoystickPOVDirection Value)
+void FJoystickInputDevice::JoystickBall(const int DeviceId, const int Ball, const FVector2D Value)
 {
-	if (!JoystickDeviceData.Contains(DeviceId))
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr || Ball < 0 || Ball >= Device->BallCount)
 	{
 		return;
 	}
 
-	FJoystickDeviceData& DeviceData = JoystickDeviceData[DeviceId];
-	if (!DeviceData.Hats.IsValidIndex(Hat))
+	// Ball motion is relative, so accumulate every delta reported this frame
+	DeviceStore.BallDeltas[Device->BallOffset + Ball] += Value;
+}
+
+void FJoystickInputDevice::QueueInputEvent(const FJoystickInputEvent& Event)
+{
+	const FJoystickInputEvent* QueuedEvent = &Event;
+
+	FJoystickInputEvent TimedEvent;
+	if (JoystickLatency::IsTrackingEnabled())
 	{
+		TimedEvent = Event;
+		TimedEvent.QueueTimestamp = FPlatformTime::Seconds();
+		QueuedEvent = &TimedEvent;
+	}
+
+	// Events of a device whose queue is not published yet are dropped, the device has not been initialised
+	if (Event.DeviceId >= 0 && Event.DeviceId < MaxPublishedEventQueues)
+	{
+		FJoystickInputEventQueue* EventQueue = PublishedEventQueues[Event.DeviceId].load(std::memory_order_acquire);
+		if (EventQueue == nullptr || !EventQueue->Enqueue(*QueuedEvent))
+		{
+			++DroppedInputEvents;
+		}
 		return;
 	}
 
-	FHatData& State = DeviceData.Hats[Hat];
-	State.PreviousDirection = State.Direction;
-	State.Direction = Value;
+	FScopeLock Lock(&DeviceEventQueuesLock);
+
+	const TSharedPtr<FJoystickInputEventQueue>* EventQueue = DeviceEventQueues.Find(Event.DeviceId);
+	if (EventQueue == nullptr || !(*EventQueue)->Enqueue(*QueuedEvent))
+	{
+		++DroppedInputEvents;
+	}
 }
 
-void FJoystickInputDevice::JoystickBall(const int DeviceId, const int Ball, const FVector2D Value)
+bool FJoystickInputDevice::ShouldDispatchAnalog(FJoystickAnalogDispatchState& State, const float Value, const float Epsilon)
 {
-	if (!JoystickDeviceData.Contains(DeviceId))
+	if (!OnlyDispatchChangedAnalogValues)
 	{
-		return;
+		return true;
 	}
 
-	FJoystickDeviceData& DeviceData = JoystickDeviceData[DeviceId];
-	if (!DeviceData.Balls.IsValidIndex(Ball))
+	if (State.ShouldDispatch(Value, Epsilon))
 	{
-		return;
+		return true;
 	}
 
-	FBallData& State = DeviceData.Balls[Ball];
-	State.PreviousDirection = State.Direction;
-	State.Direction = Value;
+	SuppressedAnalogDispatches++;
+	return false;
 }
 
-FJoystickDeviceData* FJoystickInputDevice::GetDeviceData(const int DeviceId)
+void FJoystickInputDevice::BeginFrame()
 {
-	if (!JoystickDeviceData.Contains(DeviceId))
+	DeviceStore.PreviousAxisValues = DeviceStore.AxisValues;
+	for (int Index = 0; Index < DeviceStore.AxisSamples.Num(); Index++)
 	{
-		return nullptr;
+		DeviceStore.AxisSamples[Index].Reset(DeviceStore.MappedAxisValues[Index]);
+	}
+
+	DeviceStore.PreviousHatDirections = DeviceStore.HatDirections;
+
+	for (int Index = 0; Index < DeviceStore.BallDeltas.Num(); Index++)
+	{
+		DeviceStore.PreviousBallDeltas[Index] = DeviceStore.BallDeltas[Index];
+		DeviceStore.BallDeltas[Index] = FVector2D::ZeroVector;
 	}
 
-	return JoystickDeviceData.Find(DeviceId);
+	for (int Slot = 0; Slot < DeviceStore.Slots.Num(); Slot++)
+	{
+		DeviceStore.Slots[Slot].ReplayButtonEdges = false;
+		DeviceStore.ButtonEdges[Slot].Reset();
+	}
+}
+
+void FJoystickInputDevice::DrainInputEvents()
+{
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickDrainInputEvents);
+
+	BeginFrame();
+
+	const uint64 DroppedEvents = DroppedInputEvents.exchange(0);
+	if (DroppedEvents > 0)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Dropped %llu input events, consider increasing InputEventQueueSize."), DroppedEvents);
+	}
+
+	const bool TrackLatency = JoystickLatency::IsTrackingEnabled();
+
+	FJoystickInputEvent Event;
+	for (const TPair<int, TSharedPtr<FJoystickInputEventQueue>>& EventQueue : DeviceEventQueues)
+	{
+		FJoystickDeviceLatency* Latency = TrackLatency ? &DeviceLatencies.FindOrAdd(EventQueue.Key) : nullptr;
+		int EventCount = 0;
+		while (EventQueue.Value->Dequeue(Event))
+		{
+			ApplyInputEvent(Event);
+			EventCount++;
+
+			// Events queued before tracking was enabled have no timestamps
+			if (Latency != nullptr && Event.QueueTimestamp != 0.0)
+			{
+				Latency->PendingSamples.Add({Event.Type, Event.SourceTimestamp, Event.QueueTimestamp});
+			}
+		}
+
+		INC_DWORD_STAT_BY(STAT_JoystickInputEvents, EventCount);
+#if STATS
+		DeviceEventCounts.FindOrAdd(EventQueue.Key) += EventCount;
+#endif
+	}
+
+#if STATS
+	PublishEventRates();
+#endif
+
+	DeviceStore.RemapAxes();
+	DeviceStore.PredictAxes();
+}
+
+void FJoystickInputDevice::ApplyInputEvent(const FJoystickInputEvent& Event)
+{
+	switch (Event.Type)
+	{
+		case EJoystickInputEventType::Axis:
+			JoystickAxis(Event.DeviceId, Event.Index, Event.Value, Event.Timestamp);
+			break;
+		case EJoystickInputEventType::Button:
+			JoystickButton(Event.DeviceId, Event.Index, Event.ButtonPressed);
+			break;
+		case EJoystickInputEventType::Hat:
+			JoystickHat(Event.DeviceId, Event.Index, Event.HatDirection);
+			break;
+		case EJoystickInputEventType::Ball:
+			JoystickBall(Event.DeviceId, Event.Index, Event.BallDelta);
+			break;
+		default:
+			break;
+	}
+}
+
+bool FJoystickInputDevice::GetDeviceData(const int DeviceId, FJoystickDeviceData& DeviceData) const
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
+	{
+		return false;
+	}
+
+	DeviceStore.BuildDeviceData(*Device, DeviceData);
+	return true;
+}
+
+bool FJoystickInputDevice::GetButtonMask(const int DeviceId, TArray<uint64>& ButtonMask) const
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr)
+	{
+		return false;
+	}
+
+	ButtonMask.Reset();
+	ButtonMask.Append(DeviceStore.ButtonWords.GetData() + Device->ButtonWordOffset, FJoystickDeviceStore::GetButtonWordCount(Device->ButtonCount));
+	return true;
+}
+
+bool FJoystickInputDevice::GetAxisFrameData(const int DeviceId, const int Axis, FAxisFrameData& AxisFrameData) const
+{
+	const FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId);
+	if (Device == nullptr || Axis < 0 || Axis >= Device->AxisCount)
+	{
+		return false;
+	}
+
+	AxisFrameData = DeviceStore.AxisSamples[Device->AxisOffset + Axis].ToFrameData();
+	return true;
 }
 
 FJoystickInfo* FJoystickInputDevice::GetDeviceInfo(const int DeviceId)
@@ -401,22 +764,24 @@ static FName JoystickInputInterfaceName = FName("JoystickPluginInput");
 
 void FJoystickInputDevice::SendControllerEvents()
 {
-	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickSendControllerEvents);
+
+	UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
 	if (!IsValid(JoystickSubsystem))
 	{
 		return;
 	}
 
-	for (const TPair<int, FJoystickInfo>& Device : JoystickDeviceInfo)
-	{
-		const int DeviceId = Device.Key;
-		if (!JoystickDeviceInfo.Contains(DeviceId) || !JoystickDeviceData.Contains(DeviceId))
-		{
-			continue;
-		}
+	JoystickSubsystem->Update();
+	RegisterPendingKeys();
+	DrainInputEvents();
 
-		const FJoystickInfo& CurrentDevice = JoystickDeviceInfo[DeviceId];
-		if (!CurrentDevice.Connected)
+	const bool TrackLatency = JoystickLatency::IsTrackingEnabled();
+
+	for (int Slot = 0; Slot < DeviceStore.Slots.Num(); Slot++)
+	{
+		const FJoystickDeviceSlot& Device = DeviceStore.Slots[Slot];
+		if (!Device.Connected)
 		{
 			continue;
 		}
@@ -425,109 +790,231 @@ void FJoystickInputDevice::SendControllerEvents()
 		IPlatformInputDeviceMapper& DeviceMapper = IPlatformInputDeviceMapper::Get();
 		FPlatformUserId PlatformUser = PLATFORMUSERID_NONE;
 		FInputDeviceId InputDevice = INPUTDEVICEID_NONE;
-		DeviceMapper.RemapControllerIdToPlatformUserAndDevice(CurrentDevice.Player, OUT PlatformUser, OUT InputDevice);
+		DeviceMapper.RemapControllerIdToPlatformUserAndDevice(Device.Player, OUT PlatformUser, OUT InputDevice);
 #else
-		const int PlayerId = CurrentDevice.Player;
+		const int PlayerId = Device.Player;
 #endif
 
-		FInputDeviceScope InputScope(this, JoystickInputInterfaceName, DeviceId, CurrentDevice.DeviceName);
-		const FJoystickDeviceData& CurrentDeviceData = JoystickDeviceData[DeviceId];
+		FInputDeviceScope InputScope(this, JoystickInputInterfaceName, Device.DeviceId, DeviceStore.DeviceNames[Slot]);
 
 		//Axis
-		if (DeviceAxisKeys.Contains(DeviceId))
+		for (int AxisIndex = Device.AxisOffset; AxisIndex < Device.AxisOffset + Device.AxisCount; AxisIndex++)
 		{
-			for (int AxisIndex = 0; AxisIndex < CurrentDeviceData.Axes.Num(); AxisIndex++)
+			const FName& AxisKey = DeviceStore.AxisKeys[AxisIndex];
+			const float AxisValue = DeviceStore.GetOutputAxisValue(AxisIndex);
+			if (!AxisKey.IsNone() && ShouldDispatchAnalog(DeviceStore.AxisDispatch[AxisIndex], AxisValue, DeviceStore.AxisConfigs[AxisIndex].DispatchThreshold))
 			{
-				const FKey& AxisKey = DeviceAxisKeys[DeviceId][AxisIndex];
-				if (AxisKey.IsValid())
-				{
+				INC_DWORD_STAT(STAT_JoystickAnalogDispatches);
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
-					MessageHandler->OnControllerAnalog(AxisKey.GetFName(), PlatformUser, InputDevice, CurrentDeviceData.Axes[AxisIndex].GetValue());
+				MessageHandler->OnControllerAnalog(AxisKey, PlatformUser, InputDevice, AxisValue);
 #else
-					MessageHandler->OnControllerAnalog(AxisKey.GetFName(), PlayerId, CurrentDeviceData.Axes[AxisIndex].GetValue());
+				MessageHandler->OnControllerAnalog(AxisKey, PlayerId, AxisValue);
 #endif
-				}
 			}
 		}
 
 		//Hats
-		if (DeviceHatKeys[0].Contains(DeviceId) && DeviceHatKeys[1].Contains(DeviceId))
+		for (int HatIndex = Device.HatOffset; HatIndex < Device.HatOffset + Device.HatCount; HatIndex++)
 		{
-			for (int HatIndex = 0; HatIndex < CurrentDeviceData.Hats.Num(); HatIndex++)
+			const FName& XHatKey = DeviceStore.HatKeys[HatIndex * 2];
+			const FName& YHatKey = DeviceStore.HatKeys[HatIndex * 2 + 1];
+			if (XHatKey.IsNone() || YHatKey.IsNone())
 			{
-				const FKey& XHatKey = DeviceHatKeys[0][DeviceId][HatIndex];
-				const FKey& YHatKey = DeviceHatKeys[1][DeviceId][HatIndex];
-				if (XHatKey.IsValid() && YHatKey.IsValid())
-				{
-					const FVector2D& POVAxis = UJoystickFunctionLibrary::POVAxis(CurrentDeviceData.Hats[HatIndex].Direction);
+				continue;
+			}
+
+			const FVector2D& POVAxis = UJoystickFunctionLibrary::POVAxis(DeviceStore.HatDirections[HatIndex]);
+			if (ShouldDispatchAnalog(DeviceStore.HatDispatch[HatIndex * 2], POVAxis.X, 0.f))
+			{
+				INC_DWORD_STAT(STAT_JoystickAnalogDispatches);
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
-					MessageHandler->OnControllerAnalog(XHatKey.GetFName(), PlatformUser, InputDevice, POVAxis.X);
-					MessageHandler->OnControllerAnalog(YHatKey.GetFName(), PlatformUser, InputDevice, POVAxis.Y);
+				MessageHandler->OnControllerAnalog(XHatKey, PlatformUser, InputDevice, POVAxis.X);
 #else
-					MessageHandler->OnControllerAnalog(XHatKey.GetFName(), PlayerId, POVAxis.X);
-					MessageHandler->OnControllerAnalog(YHatKey.GetFName(), PlayerId, POVAxis.Y);
+				MessageHandler->OnControllerAnalog(XHatKey, PlayerId, POVAxis.X);
+#endif
+			}
+
+			if (ShouldDispatchAnalog(DeviceStore.HatDispatch[HatIndex * 2 + 1], POVAxis.Y, 0.f))
+			{
+				INC_DWORD_STAT(STAT_JoystickAnalogDispatches);
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
+				MessageHandler->OnControllerAnalog(YHatKey, PlatformUser, InputDevice, POVAxis.Y);
+#else
+				MessageHandler->OnControllerAnalog(YHatKey, PlayerId, POVAxis.Y);
 #endif
-				}
 			}
 		}
 
 		//Balls
-		if (DeviceBallKeys[0].Contains(DeviceId) && DeviceBallKeys[1].Contains(DeviceId))
+		for (int BallIndex = Device.BallOffset; BallIndex < Device.BallOffset + Device.BallCount; BallIndex++)
 		{
-			for (int BallIndex = 0; BallIndex < CurrentDeviceData.Balls.Num(); BallIndex++)
+			const FName& XBallKey = DeviceStore.BallKeys[BallIndex * 2];
+			const FName& YBallKey = DeviceStore.BallKeys[BallIndex * 2 + 1];
+			if (XBallKey.IsNone() || YBallKey.IsNone())
 			{
-				const FKey& XBallKey = DeviceBallKeys[0][DeviceId][BallIndex];
-				const FKey& YBallKey = DeviceBallKeys[1][DeviceId][BallIndex];
-				if (XBallKey.IsValid() && YBallKey.IsValid())
-				{
-					const FVector2D& BallAxis = CurrentDeviceData.Balls[BallIndex].Direction;
+				continue;
+			}
+
+			const FVector2D& BallAxis = DeviceStore.BallDeltas[BallIndex];
+			if (ShouldDispatchAnalog(DeviceStore.BallDispatch[BallIndex * 2], BallAxis.X, 0.f))
+			{
+				INC_DWORD_STAT(STAT_JoystickAnalogDispatches);
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
-					MessageHandler->OnControllerAnalog(XBallKey.GetFName(), PlatformUser, InputDevice, BallAxis.X);
-					MessageHandler->OnControllerAnalog(YBallKey.GetFName(), PlatformUser, InputDevice, BallAxis.Y);
+				MessageHandler->OnControllerAnalog(XBallKey, PlatformUser, InputDevice, BallAxis.X);
 #else
-					MessageHandler->OnControllerAnalog(XBallKey.GetFName(), PlayerId, BallAxis.X);
-					MessageHandler->OnControllerAnalog(YBallKey.GetFName(), PlayerId, BallAxis.Y);
+				MessageHandler->OnControllerAnalog(XBallKey, PlayerId, BallAxis.X);
+#endif
+			}
+
+			if (ShouldDispatchAnalog(DeviceStore.BallDispatch[BallIndex * 2 + 1], BallAxis.Y, 0.f))
+			{
+				INC_DWORD_STAT(STAT_JoystickAnalogDispatches);
+#if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
+				MessageHandler->OnControllerAnalog(YBallKey, PlatformUser, InputDevice, BallAxis.Y);
+#else
+				MessageHandler->OnControllerAnalog(YBallKey, PlayerId, BallAxis.Y);
 #endif
-				}
 			}
 		}
 
 		//Buttons
-		if (DeviceButtonKeys.Contains(DeviceId))
+		const auto DispatchButton = [&](const int Button, const bool Pressed)
 		{
-			for (int ButtonIndex = 0; ButtonIndex < CurrentDeviceData.Buttons.Num(); ButtonIndex++)
+			const FName& ButtonKey = DeviceStore.ButtonKeys[Device.ButtonOffset + Button];
+			if (ButtonKey.IsNone())
+			{
+				return;
+			}
+
+			INC_DWORD_STAT(STAT_JoystickButtonEdges);
+
+			if (Pressed)
 			{
-				const FKey& ButtonKey = DeviceButtonKeys[DeviceId][ButtonIndex];
-				if (ButtonKey.IsValid())
-				{
-					FButtonData& ButtonData = JoystickDeviceData[DeviceId].Buttons[ButtonIndex];
-					if (ButtonData.ButtonState != ButtonData.PreviousButtonState)
-					{
-						if (ButtonData.ButtonState)
-						{
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
-							MessageHandler->OnControllerButtonPressed(ButtonKey.GetFName(), PlatformUser, InputDevice, false);
+				MessageHandler->OnControllerButtonPressed(ButtonKey, PlatformUser, InputDevice, false);
 #else
-							MessageHandler->OnControllerButtonPressed(ButtonKey.GetFName(), PlayerId, false);
+				MessageHandler->OnControllerButtonPressed(ButtonKey, PlayerId, false);
 #endif
-						}
-						else
-						{
+			}
+			else
+			{
 #if ENGINE_MAJOR_VERSION == 5 && ENGINE_MINOR_VERSION >= 1
-							MessageHandler->OnControllerButtonReleased(ButtonKey.GetFName(), PlatformUser, InputDevice, false);
+				MessageHandler->OnControllerButtonReleased(ButtonKey, PlatformUser, InputDevice, false);
 #else
-							MessageHandler->OnControllerButtonReleased(ButtonKey.GetFName(), PlayerId, false);
+				MessageHandler->OnControllerButtonReleased(ButtonKey, PlayerId, false);
 #endif
-						}
+			}
+		};
 
-						ButtonData.PreviousButtonState = ButtonData.ButtonState;
-					}
+		const int ButtonWordCount = FJoystickDeviceStore::GetButtonWordCount(Device.ButtonCount);
+		if (Device.ReplayButtonEdges)
+		{
+			// A button toggled within the frame, dispatch every edge in the order it happened so a press and release are both seen
+			for (const FJoystickButtonEdge& ButtonEdge : DeviceStore.ButtonEdges[Slot])
+			{
+				DispatchButton(ButtonEdge.Button, ButtonEdge.Pressed);
+			}
+		}
+		else
+		{
+			for (int WordIndex = 0; WordIndex < ButtonWordCount; WordIndex++)
+			{
+				const uint64 ButtonWord = DeviceStore.ButtonWords[Device.ButtonWordOffset + WordIndex];
+				uint64 ChangedBits = ButtonWord ^ DeviceStore.PreviousButtonWords[Device.ButtonWordOffset + WordIndex];
+				while (ChangedBits != 0)
+				{
+					const int Bit = FMath::CountTrailingZeros64(ChangedBits);
+					ChangedBits &= ChangedBits - 1;
+					DispatchButton(WordIndex * 64 + Bit, ((ButtonWord >> Bit) & 1) != 0);
 				}
 			}
 		}
+
+		for (int WordIndex = Device.ButtonWordOffset; WordIndex < Device.ButtonWordOffset + ButtonWordCount; WordIndex++)
+		{
+			DeviceStore.PreviousButtonWords[WordIndex] = DeviceStore.ButtonWords[WordIndex];
+		}
+
+		if (TrackLatency)
+		{
+			RecordDispatchLatency(Device.DeviceId);
+		}
 	}
+}
 
-	JoystickSubsystem->Update();
+#if STATS
+void FJoystickInputDevice::PublishEventRates()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double Elapsed = Now - EventRateWindowStart;
+	if (Elapsed < 1.0)
+	{
+		return;
+	}
+
+	for (TPair<int, int>& DeviceEventCount : DeviceEventCounts)
+	{
+		FName* StatName = DeviceEventRateStats.Find(DeviceEventCount.Key);
+		if (StatName == nullptr)
+		{
+			const FString Description = FString::Printf(TEXT("Device %d Events/s"), DeviceEventCount.Key);
+			StatName = &DeviceEventRateStats.Add(DeviceEventCount.Key, FDynamicStats::CreateStatIdInt64<FStatGroup_STATGROUP_Joystick>(Description, true).GetName());
+		}
+
+		SET_DWORD_STAT_FName(*StatName, FMath::RoundToInt(DeviceEventCount.Value / Elapsed));
+		DeviceEventCount.Value = 0;
+	}
+
+	EventRateWindowStart = Now;
+}
+#endif
+
+void FJoystickInputDevice::RecordDispatchLatency(const int DeviceId)
+{
+	FJoystickDeviceLatency* Latency = DeviceLatencies.Find(DeviceId);
+	if (Latency == nullptr || Latency->PendingSamples.Num() == 0)
+	{
+		return;
+	}
+
+	const double DispatchTimestamp = FPlatformTime::Seconds();
+	for (const FJoystickLatencySample& Sample : Latency->PendingSamples)
+	{
+		const int Type = static_cast<int>(Sample.Type);
+		Latency->QueueToDispatch[Type].Record(DispatchTimestamp - Sample.QueueTimestamp);
+
+		// Without a device timestamp the event to queue stage is not measured and the total starts at the queue
+		if (Sample.SourceTimestamp == 0.0)
+		{
+			Latency->Total[Type].Record(DispatchTimestamp - Sample.QueueTimestamp);
+			continue;
+		}
+
+		Latency->EventToQueue[Type].Record(Sample.QueueTimestamp - Sample.SourceTimestamp);
+		Latency->Total[Type].Record(DispatchTimestamp - Sample.SourceTimestamp);
+	}
+
+	Latency->PendingSamples.Reset();
+}
+
+bool FJoystickInputDevice::GetInputLatency(const int DeviceId, const EJoystickInputEventType Type, FJoystickInputLatency& Latency) const
+{
+	const FJoystickDeviceLatency* DeviceLatency = DeviceLatencies.Find(DeviceId);
+	if (DeviceLatency == nullptr)
+	{
+		return false;
+	}
+
+	const int TypeIndex = static_cast<int>(Type);
+	DeviceLatency->EventToQueue[TypeIndex].GetPercentiles(Latency.EventToQueue);
+	DeviceLatency->QueueToDispatch[TypeIndex].GetPercentiles(Latency.QueueToDispatch);
+	DeviceLatency->Total[TypeIndex].GetPercentiles(Latency.Total);
+	return true;
+}
+
+void FJoystickInputDevice::ResetInputLatency()
+{
+	DeviceLatencies.Empty();
 }
 
 void FJoystickInputDevice::GetDeviceIds(TArray<int>& DeviceIds) const
@@ -543,30 +1030,27 @@ void FJoystickInputDevice::SetPlayerOwnership(const int DeviceId, const int Play
 	}
 
 	JoystickDeviceInfo[DeviceId].Player = PlayerId;
+
+	if (FJoystickDeviceSlot* Device = DeviceStore.FindDevice(DeviceId))
+	{
+		Device->Player = PlayerId;
+	}
 }
 
 void FJoystickInputDevice::ResetAxisProperties()
 {
-	for (TPair<int, FJoystickDeviceData>& DeviceData : JoystickDeviceData)
+	for (FJoystickAxisConfig& AxisConfig : DeviceStore.AxisConfigs)
 	{
-		for (int i = 0; i < DeviceData.Value.Axes.Num(); i++)
-		{
-			const FAxisData Defaults;
-			FAxisData& AxisKeyData = DeviceData.Value.Axes[i];
-			AxisKeyData.RemappingEnabled = Defaults.RemappingEnabled;
-			AxisKeyData.InputOffset = Defaults.InputOffset;
-			AxisKeyData.InvertInput = Defaults.InvertInput;
-			AxisKeyData.InputRangeMin = Defaults.InputRangeMin;
-			AxisKeyData.InputRangeMax = Defaults.InputRangeMax;
-			AxisKeyData.OutputRangeMin = Defaults.OutputRangeMin;
-			AxisKeyData.OutputRangeMax = Defaults.OutputRangeMax;
-			AxisKeyData.InvertOutput = Defaults.InvertOutput;
-		}
+		AxisConfig = FJoystickAxisConfig();
 	}
+
+	DeviceStore.BuildAxisRemap();
 }
 
 void FJoystickInputDevice::UpdateAxisProperties()
 {
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickUpdateAxisProperties);
+
 	ResetAxisProperties();
 
 	const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
@@ -575,21 +1059,23 @@ void FJoystickInputDevice::UpdateAxisProperties()
 		return;
 	}
 
-	for (const TPair<int, FJoystickInfo>& Device : JoystickDeviceInfo)
+	OnlyDispatchChangedAnalogValues = JoystickInputSettings->OnlyDispatchChangedAnalogValues;
+
+	for (const FJoystickDeviceSlot& Device : DeviceStore.Slots)
 	{
-		FJoystickDeviceData* DeviceData = JoystickDeviceData.Find(Device.Key);
-		if (DeviceData == nullptr)
+		const FJoystickInfo* DeviceInfo = JoystickDeviceInfo.Find(Device.DeviceId);
+		if (DeviceInfo == nullptr)
 		{
 			continue;
 		}
 
-		const FJoystickInputDeviceConfiguration* DeviceConfig = JoystickInputSettings->GetInputDeviceConfiguration(Device.Value);
+		const FJoystickInputDeviceConfiguration* DeviceConfig = JoystickInputSettings->GetInputDeviceConfiguration(*DeviceInfo);
 		if (DeviceConfig == nullptr)
 		{
 			continue;
 		}
 
-		for (int i = 0; i < DeviceData->Axes.Num(); i++)
+		for (int i = 0; i < Device.AxisCount; i++)
 		{
 			const FJoystickInputDeviceAxisProperties* AxisProperties = DeviceConfig->AxisProperties.FindByPredicate([&](const FJoystickInputDeviceAxisProperties& AxisProperty)
 			{
@@ -600,7 +1086,7 @@ void FJoystickInputDevice::UpdateAxisProperties()
 				continue;
 			}
 
-			FAxisData& AxisKeyData = DeviceData->Axes[i];
+			FJoystickAxisConfig& AxisKeyData = DeviceStore.AxisConfigs[Device.AxisOffset + i];
 			AxisKeyData.RemappingEnabled = AxisProperties->RemappingEnabled;
 			AxisKeyData.InputOffset = AxisProperties->InputOffset;
 			AxisKeyData.InvertInput = AxisProperties->InvertInput;
@@ -609,77 +1095,76 @@ void FJoystickInputDevice::UpdateAxisProperties()
 			AxisKeyData.OutputRangeMin = AxisProperties->OutputRangeMin;
 			AxisKeyData.OutputRangeMax = AxisProperties->OutputRangeMax;
 			AxisKeyData.InvertOutput = AxisProperties->InvertOutput;
-		}
-	}
-}
-
-int FJoystickInputDevice::GetDeviceIndexByKey(const FKey& Key) const
-{
-	for (const TPair<int, TArray<FKey>>& Device : DeviceAxisKeys)
-	{
-		for (const FKey& DeviceKey : Device.Value)
-		{
-			if (DeviceKey == Key)
-			{
-				return Device.Key;
-			}
-		}
-	}
-
-	for (const TMap<int, TArray<FKey>>& DeviceBalls : DeviceBallKeys)
-	{
-		for (const TPair<int, TArray<FKey>>& Device : DeviceBalls)
-		{
-			for (const FKey& DeviceKey : Device.Value)
+			AxisKeyData.DispatchThreshold = AxisProperties->DispatchThreshold;
+			AxisKeyData.Centered = AxisProperties->Centered;
+			AxisKeyData.InnerDeadzone = AxisProperties->InnerDeadzone;
+			AxisKeyData.OuterDeadzone = AxisProperties->OuterDeadzone;
+			AxisKeyData.ResponseCurve = AxisProperties->ResponseCurve;
+			AxisKeyData.CurveExponent = AxisProperties->CurveExponent;
+			AxisKeyData.PairedAxisIndex = AxisProperties->PairedAxisIndex;
+			AxisKeyData.RadialDeadzone = AxisProperties->RadialDeadzone;
+			AxisKeyData.Filters = AxisProperties->Filters;
+			AxisKeyData.PredictionMode = AxisProperties->PredictionMode;
+			AxisKeyData.PredictionHorizon = AxisProperties->PredictionHorizon;
+			AxisKeyData.PredictionClamp = AxisProperties->PredictionClamp;
+			AxisKeyData.CurvePoints.Reset();
+
+			if (AxisProperties->ResponseCurve == EJoystickAxisResponseCurve::Custom)
 			{
-				if (DeviceKey == Key)
+				// Curve assets are sampled once here, the points are baked into the response table
+				const UCurveFloat* CurveAsset = AxisProperties->CurveAsset.LoadSynchronous();
+				if (CurveAsset != nullptr)
 				{
-					return Device.Key;
+					AxisKeyData.CurvePoints.SetNum(JoystickAxisKernel::ResponseTableSize);
+					for (int PointIndex = 0; PointIndex < JoystickAxisKernel::ResponseTableSize; PointIndex++)
+					{
+						const float Deflection = static_cast<float>(PointIndex) / (JoystickAxisKernel::ResponseTableSize - 1);
+						AxisKeyData.CurvePoints[PointIndex] = FVector2D(Deflection, CurveAsset->GetFloatValue(Deflection));
+					}
+				}
+				else
+				{
+					AxisKeyData.CurvePoints = AxisProperties->CurvePoints;
+					AxisKeyData.CurvePoints.Sort([](const FVector2D& A, const FVector2D& B)
+					{
+						return A.X < B.X;
+					});
 				}
 			}
 		}
 	}
 
-	for (const TPair<int, TArray<FKey>>& Device : DeviceButtonKeys)
-	{
-		for (const FKey& DeviceKey : Device.Value)
-		{
-			if (DeviceKey == Key)
-			{
-				return Device.Key;
-			}
-		}
-	}
+	DeviceStore.BuildAxisRemap();
+}
 
-	for (const TMap<int, TArray<FKey>>& DeviceHats : DeviceHatKeys)
+const FJoystickKeyInfo* FJoystickInputDevice::GetKeyInfo(const FKey& Key) const
+{
+	return KeyInfos.Find(Key.GetFName());
+}
+
+int FJoystickInputDevice::GetDeviceIndexByKey(const FKey& Key) const
+{
+	const FJoystickKeyInfo* KeyInfo = GetKeyInfo(Key);
+	if (KeyInfo == nullptr)
 	{
-		for (const TPair<int, TArray<FKey>>& Device : DeviceHats)
-		{
-			for (const FKey& DeviceKey : Device.Value)
-			{
-				if (DeviceKey == Key)
-				{
-					return Device.Key;
-				}
-			}
-		}
+		return -1;
 	}
 
-	return -1;
+	return KeyInfo->Index;
+}
+
+uint64 FJoystickInputDevice::GetSuppressedAnalogDispatchCount() const
+{
+	return SuppressedAnalogDispatches;
 }
 
 int FJoystickInputDevice::GetDeviceIdByKey(const FKey& Key) const
 {
-	for (const TPair<int, TArray<FKey>>& Device : DeviceKeys)
+	const FJoystickKeyInfo* KeyInfo = GetKeyInfo(Key);
+	if (KeyInfo == nullptr)
 	{
-		for (const FKey& DeviceKey : Device.Value)
-		{
-			if (DeviceKey == Key)
-			{
-				return Device.Key;
-			}
-		}
+		return -1;
 	}
 
-	return -1;
+	return KeyInfo->DeviceId;
 }
@@ -0,0 +1,314 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickInputRecorder.h"
+#include "JoystickInputRecording.h"
+#include "JoystickLogManager.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	constexpr int ChunkSize = 64 * 1024;
+
+	/* Events waiting to be encoded before new ones start being dropped */
+	constexpr uint32 InputQueueSize = 16 * 1024;
+
+	/* How often the recorder thread picks up queued events */
+	constexpr uint32 EncodeIntervalMs = 10;
+
+	/* Partially filled chunks are written at least this often so a crash loses little */
+	constexpr double FlushInterval = 1.0;
+}
+
+FJoystickInputRecorder::FJoystickInputRecorder(const FString& InPath, const TArray<FDeviceInfoSDL>& Devices)
+	: Path(InPath)
+	  , InputEvents(InputQueueSize)
+	  , LastTimestamp(FPlatformTime::Seconds())
+	  , WakeEvent(nullptr)
+	  , Thread(nullptr)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+	File.Reset(PlatformFile.OpenWrite(*Path));
+	if (!File.IsValid())
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to open %s for recording."), *Path);
+		return;
+	}
+
+	ActiveChunk.Reserve(ChunkSize);
+	ActiveChunk.Add(static_cast<uint8>(JoystickRecording::Magic));
+	ActiveChunk.Add(static_cast<uint8>(JoystickRecording::Magic >> 8));
+	ActiveChunk.Add(static_cast<uint8>(JoystickRecording::Magic >> 16));
+	ActiveChunk.Add(static_cast<uint8>(JoystickRecording::Magic >> 24));
+	ActiveChunk.Add(JoystickRecording::Version);
+
+	JoystickRecording::WriteVarint(ActiveChunk, Devices.Num());
+	for (const FDeviceInfoSDL& Device : Devices)
+	{
+		JoystickRecording::WriteDevice(ActiveChunk, Device);
+	}
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("JoystickInputRecorder"), 0, TPri_BelowNormal);
+	if (Thread == nullptr)
+	{
+		FJoystickLogManager::Get()->LogWarning(TEXT("Failed to create the recorder thread, the recording will be written when it stops."));
+	}
+
+	FJoystickLogManager::Get()->LogInformation(TEXT("Recording joystick input to %s"), *Path);
+}
+
+FJoystickInputRecorder::~FJoystickInputRecorder()
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+	else
+	{
+		EncodeRecords();
+		FlushChunk();
+		File->Flush();
+	}
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+	File.Reset();
+
+	FJoystickLogManager::Get()->LogInformation(TEXT("Stopped recording to %s: %lld records, %lld bytes, %lld dropped"),
+	                                           *Path, RecordCount.GetValue(), BytesWritten.GetValue(), DroppedRecords.GetValue());
+}
+
+bool FJoystickInputRecorder::IsRecording() const
+{
+	return File.IsValid();
+}
+
+const FString& FJoystickInputRecorder::GetPath() const
+{
+	return Path;
+}
+
+void FJoystickInputRecorder::RecordInputEvent(const FJoystickInputEvent& InputEvent)
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	// Never waits, the recorder thread picks it up on its next pass
+	if (!InputEvents.Enqueue(InputEvent))
+	{
+		DroppedRecords.Increment();
+	}
+}
+
+void FJoystickInputRecorder::RecordDeviceAdded(const FDeviceInfoSDL& Device)
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	FDeviceRecord Record;
+	Record.IsAdded = true;
+	Record.DeviceId = Device.DeviceId;
+	Record.Timestamp = FPlatformTime::Seconds();
+	Record.Device = Device;
+	DeviceRecords.Enqueue(MoveTemp(Record));
+}
+
+void FJoystickInputRecorder::RecordDeviceRemoved(const int DeviceId)
+{
+	if (!File.IsValid())
+	{
+		return;
+	}
+
+	FDeviceRecord Record;
+	Record.DeviceId = DeviceId;
+	Record.Timestamp = FPlatformTime::Seconds();
+	DeviceRecords.Enqueue(MoveTemp(Record));
+}
+
+void FJoystickInputRecorder::EncodeRecords()
+{
+	// Both queues are in timestamp order, merge them so device records land between the right input events
+	FJoystickInputEvent InputEvent;
+	FDeviceRecord DeviceRecord;
+	bool HasInputEvent = InputEvents.Peek(InputEvent);
+	bool HasDeviceRecord = DeviceRecords.Peek(DeviceRecord);
+
+	while (HasInputEvent || HasDeviceRecord)
+	{
+		if (HasInputEvent && (!HasDeviceRecord || InputEvent.Timestamp <= DeviceRecord.Timestamp))
+		{
+			InputEvents.Dequeue();
+			EncodeInputEvent(InputEvent);
+			HasInputEvent = InputEvents.Peek(InputEvent);
+		}
+		else
+		{
+			DeviceRecords.Pop();
+			EncodeDeviceRecord(DeviceRecord);
+			HasDeviceRecord = DeviceRecords.Peek(DeviceRecord);
+		}
+	}
+}
+
+void FJoystickInputRecorder::EncodeInputEvent(const FJoystickInputEvent& InputEvent)
+{
+	BeginRecord();
+
+	switch (InputEvent.Type)
+	{
+		case EJoystickInputEventType::Axis:
+			{
+				WriteRecordHeader(static_cast<uint8>(JoystickRecording::ERecordType::Axis), InputEvent.DeviceId, InputEvent.Timestamp);
+				JoystickRecording::WriteVarint(ActiveChunk, InputEvent.Index);
+
+				const int32 RawValue = JoystickRecording::AxisValueToRaw(InputEvent.Value);
+				int32& LastValue = LastAxisValues.FindOrAdd(JoystickRecording::AxisKey(InputEvent.DeviceId, InputEvent.Index));
+				JoystickRecording::WriteVarint(ActiveChunk, JoystickRecording::ZigZagEncode(RawValue - LastValue));
+				LastValue = RawValue;
+				break;
+			}
+		case EJoystickInputEventType::Button:
+			{
+				const uint8 Tag = static_cast<uint8>(JoystickRecording::ERecordType::Button) | (InputEvent.ButtonPressed ? JoystickRecording::ButtonPressedFlag : 0);
+				WriteRecordHeader(Tag, InputEvent.DeviceId, InputEvent.Timestamp);
+				JoystickRecording::WriteVarint(ActiveChunk, InputEvent.Index);
+				break;
+			}
+		case EJoystickInputEventType::Hat:
+			WriteRecordHeader(static_cast<uint8>(JoystickRecording::ERecordType::Hat), InputEvent.DeviceId, InputEvent.Timestamp);
+			JoystickRecording::WriteVarint(ActiveChunk, InputEvent.Index);
+			ActiveChunk.Add(static_cast<uint8>(InputEvent.HatDirection));
+			break;
+		case EJoystickInputEventType::Ball:
+			WriteRecordHeader(static_cast<uint8>(JoystickRecording::ERecordType::Ball), InputEvent.DeviceId, InputEvent.Timestamp);
+			JoystickRecording::WriteVarint(ActiveChunk, InputEvent.Index);
+			JoystickRecording::WriteVarint(ActiveChunk, JoystickRecording::ZigZagEncode(FMath::RoundToInt(InputEvent.BallDelta.X)));
+			JoystickRecording::WriteVarint(ActiveChunk, JoystickRecording::ZigZagEncode(FMath::RoundToInt(InputEvent.BallDelta.Y)));
+			break;
+		default:
+			return;
+	}
+
+	RecordCount.Increment();
+}
+
+void FJoystickInputRecorder::EncodeDeviceRecord(const FDeviceRecord& Record)
+{
+	BeginRecord();
+
+	if (!Record.IsAdded)
+	{
+		WriteRecordHeader(static_cast<uint8>(JoystickRecording::ERecordType::DeviceRemoved), Record.DeviceId, Record.Timestamp);
+		RecordCount.Increment();
+		return;
+	}
+
+	// The descriptor carries the device id
+	ActiveChunk.Add(static_cast<uint8>(JoystickRecording::ERecordType::DeviceAdded));
+	const uint64 DeltaMicroseconds = static_cast<uint64>(FMath::Max(0.0, FMath::RoundToDouble((Record.Timestamp - LastTimestamp) * 1.e6)));
+	JoystickRecording::WriteVarint(ActiveChunk, DeltaMicroseconds);
+	LastTimestamp += DeltaMicroseconds * 1.e-6;
+
+	JoystickRecording::WriteDevice(ActiveChunk, Record.Device);
+	RecordCount.Increment();
+}
+
+void FJoystickInputRecorder::BeginRecord()
+{
+	if (ActiveChunk.Num() + JoystickRecording::MaxRecordSize > ChunkSize)
+	{
+		FlushChunk();
+	}
+}
+
+void FJoystickInputRecorder::WriteRecordHeader(const uint8 Tag, const int DeviceId, const double Timestamp)
+{
+	ActiveChunk.Add(Tag);
+
+	// Events from the input thread and the game thread can interleave slightly out of order, clamp rather than go backwards
+	const uint64 DeltaMicroseconds = static_cast<uint64>(FMath::Max(0.0, FMath::RoundToDouble((Timestamp - LastTimestamp) * 1.e6)));
+	JoystickRecording::WriteVarint(ActiveChunk, DeltaMicroseconds);
+	LastTimestamp += DeltaMicroseconds * 1.e-6;
+
+	JoystickRecording::WriteVarint(ActiveChunk, DeviceId);
+}
+
+void FJoystickInputRecorder::FlushChunk()
+{
+	if (ActiveChunk.Num() == 0)
+	{
+		return;
+	}
+
+	if (File->Write(ActiveChunk.GetData(), ActiveChunk.Num()))
+	{
+		BytesWritten.Add(ActiveChunk.Num());
+	}
+	else
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to write %d bytes to %s"), ActiveChunk.Num(), *Path);
+	}
+
+	ActiveChunk.Reset();
+}
+
+uint32 FJoystickInputRecorder::Run()
+{
+	double LastFlush = FPlatformTime::Seconds();
+
+	while (true)
+	{
+		const bool Stopping = StopRequested;
+		if (!Stopping)
+		{
+			WakeEvent->Wait(EncodeIntervalMs);
+		}
+
+		EncodeRecords();
+
+		const double Now = FPlatformTime::Seconds();
+		if (Stopping || Now - LastFlush >= FlushInterval)
+		{
+			FlushChunk();
+			LastFlush = Now;
+		}
+
+		if (Stopping)
+		{
+			break;
+		}
+	}
+
+	File->Flush();
+	return 0;
+}
+
+void FJoystickInputRecorder::Stop()
+{
+	StopRequested = true;
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+}
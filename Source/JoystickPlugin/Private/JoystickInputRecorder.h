@@ -0,0 +1,83 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Containers/CircularQueue.h"
+#include "Containers/Queue.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Templates/UniquePtr.h"
+
+class FEvent;
+class FRunnableThread;
+class IFileHandle;
+
+/**
+ * Streams raw joystick input to disk in the compact format described in JoystickInputRecording.h.
+ * The input thread only pushes each event into a bounded single producer queue, encoding and writing happen on a
+ * background thread, so memory stays bounded no matter how long the capture runs. If the recorder falls behind,
+ * new events are dropped (and counted) rather than blocking the input thread.
+ */
+class FJoystickInputRecorder final : public FRunnable
+{
+public:
+	FJoystickInputRecorder(const FString& InPath, const TArray<FDeviceInfoSDL>& Devices);
+	virtual ~FJoystickInputRecorder() override;
+
+	bool IsRecording() const;
+	const FString& GetPath() const;
+
+	/* One producer at a time, the subsystem calls it from whichever thread delivers input */
+	void RecordInputEvent(const FJoystickInputEvent& InputEvent);
+
+	/* Game thread */
+	void RecordDeviceAdded(const FDeviceInfoSDL& Device);
+	void RecordDeviceRemoved(const int DeviceId);
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	struct FDeviceRecord
+	{
+		bool IsAdded = false;
+		int DeviceId = -1;
+		double Timestamp = 0.0;
+		FDeviceInfoSDL Device;
+	};
+
+	/* Encodes everything queued so far in timestamp order, on the recorder thread or from the destructor when there is none */
+	void EncodeRecords();
+	void EncodeInputEvent(const FJoystickInputEvent& InputEvent);
+	void EncodeDeviceRecord(const FDeviceRecord& Record);
+
+	void BeginRecord();
+	void WriteRecordHeader(const uint8 Tag, const int DeviceId, const double Timestamp);
+	void FlushChunk();
+
+	FString Path;
+	TUniquePtr<IFileHandle> File;
+
+	// Handed over by the input thread and the game thread
+	TCircularQueue<FJoystickInputEvent> InputEvents;
+	TQueue<FDeviceRecord, EQueueMode::Mpsc> DeviceRecords;
+
+	// Encoder state, recorder thread only
+	TArray<uint8> ActiveChunk;
+	double LastTimestamp;
+	TMap<uint64, int32> LastAxisValues;
+
+	FThreadSafeCounter64 RecordCount;
+	FThreadSafeCounter64 DroppedRecords;
+	FThreadSafeCounter64 BytesWritten;
+
+	FEvent* WakeEvent;
+	FThreadSafeBool StopRequested;
+	FRunnableThread* Thread;
+};
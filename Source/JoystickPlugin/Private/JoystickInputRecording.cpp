@@ -0,0 +1,117 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickInputRecording.h"
+#include "Data/DeviceInfoSDL.h"
+
+namespace JoystickRecording
+{
+	constexpr uint64 GamepadFlag = 0x1;
+
+	void WriteVarint(TArray<uint8>& Buffer, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Buffer.Add(static_cast<uint8>(Value | 0x80));
+			Value >>= 7;
+		}
+
+		Buffer.Add(static_cast<uint8>(Value));
+	}
+
+	bool ReadVarint(const uint8*& Data, const uint8* End, uint64& Value)
+	{
+		Value = 0;
+		for (int Shift = 0; Shift < 64 && Data < End; Shift += 7)
+		{
+			const uint8 Byte = *Data++;
+			Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void WriteDevice(TArray<uint8>& Buffer, const FDeviceInfoSDL& Device)
+	{
+		WriteVarint(Buffer, Device.DeviceId);
+
+		const uint32 GuidWords[4] = {Device.ProductId.A, Device.ProductId.B, Device.ProductId.C, Device.ProductId.D};
+		for (const uint32 GuidWord : GuidWords)
+		{
+			Buffer.Add(static_cast<uint8>(GuidWord));
+			Buffer.Add(static_cast<uint8>(GuidWord >> 8));
+			Buffer.Add(static_cast<uint8>(GuidWord >> 16));
+			Buffer.Add(static_cast<uint8>(GuidWord >> 24));
+		}
+
+		WriteVarint(Buffer, Device.IsGamepad ? GamepadFlag : 0);
+
+		const FTCHARToUTF8 DeviceName(*Device.DeviceName);
+		int NameLength = FMath::Min(DeviceName.Length(), MaxDeviceNameLength);
+		if (NameLength < DeviceName.Length())
+		{
+			// Back up over continuation bytes so the cut does not split a code point
+			const uint8* NameBytes = reinterpret_cast<const uint8*>(DeviceName.Get());
+			while (NameLength > 0 && (NameBytes[NameLength] & 0xC0) == 0x80)
+			{
+				NameLength--;
+			}
+		}
+		WriteVarint(Buffer, NameLength);
+		Buffer.Append(reinterpret_cast<const uint8*>(DeviceName.Get()), NameLength);
+
+		WriteVarint(Buffer, Device.AxisCount);
+		WriteVarint(Buffer, Device.ButtonCount);
+		WriteVarint(Buffer, Device.HatCount);
+		WriteVarint(Buffer, Device.BallCount);
+	}
+
+	bool ReadDevice(const uint8*& Data, const uint8* End, FDeviceInfoSDL& Device)
+	{
+		uint64 DeviceId;
+		if (!ReadVarint(Data, End, DeviceId) || End - Data < 16)
+		{
+			return false;
+		}
+		Device.DeviceId = static_cast<int>(DeviceId);
+
+		uint32 GuidWords[4];
+		for (uint32& GuidWord : GuidWords)
+		{
+			GuidWord = Data[0] | Data[1] << 8 | Data[2] << 16 | static_cast<uint32>(Data[3]) << 24;
+			Data += 4;
+		}
+		Device.ProductId = FGuid(GuidWords[0], GuidWords[1], GuidWords[2], GuidWords[3]);
+
+		uint64 Flags;
+		uint64 NameLength;
+		if (!ReadVarint(Data, End, Flags) || !ReadVarint(Data, End, NameLength) || NameLength > static_cast<uint64>(End - Data))
+		{
+			return false;
+		}
+		Device.IsGamepad = (Flags & GamepadFlag) != 0;
+
+		const FUTF8ToTCHAR DeviceName(reinterpret_cast<const ANSICHAR*>(Data), static_cast<int32>(NameLength));
+		Device.DeviceName = FString(DeviceName.Length(), DeviceName.Get());
+		Data += NameLength;
+
+		uint64 Counts[4];
+		for (uint64& Count : Counts)
+		{
+			if (!ReadVarint(Data, End, Count))
+			{
+				return false;
+			}
+		}
+
+		Device.AxisCount = static_cast<int>(Counts[0]);
+		Device.ButtonCount = static_cast<int>(Counts[1]);
+		Device.HatCount = static_cast<int>(Counts[2]);
+		Device.BallCount = static_cast<int>(Counts[3]);
+		return true;
+	}
+}
@@ -0,0 +1,74 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDeviceInfoSDL;
+
+/**
+ * Binary layout shared by the recorder and the replay.
+ *
+ * Header:  magic, version, varint device count, device descriptors
+ * Records: tag byte, varint microseconds since the previous record, varint device id, payload
+ *
+ * Axis values are delta encoded per axis as zigzag varints of the raw SDL value, so an idle or slowly
+ * moving stick costs 4-5 bytes a sample. Devices that connect mid recording are written as a record.
+ */
+namespace JoystickRecording
+{
+	constexpr uint32 Magic = 0x524F594A; // "JOYR"
+	constexpr uint8 Version = 1;
+
+	enum class ERecordType : uint8
+	{
+		Axis,
+		Button,
+		Hat,
+		Ball,
+		DeviceAdded,
+		DeviceRemoved
+	};
+
+	constexpr uint8 RecordTypeMask = 0x7;
+	constexpr uint8 ButtonPressedFlag = 0x8;
+
+	/* Longest device name written to a descriptor */
+	constexpr int MaxDeviceNameLength = 255;
+
+	/* Upper bound on the encoded size of any record, the replay keeps at least this much buffered */
+	constexpr int MaxRecordSize = 1 + 10 * 8 + 16 + MaxDeviceNameLength;
+
+	void WriteVarint(TArray<uint8>& Buffer, uint64 Value);
+	bool ReadVarint(const uint8*& Data, const uint8* End, uint64& Value);
+
+	FORCEINLINE uint64 ZigZagEncode(const int64 Value)
+	{
+		return (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63);
+	}
+
+	FORCEINLINE int64 ZigZagDecode(const uint64 Value)
+	{
+		return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+	}
+
+	/* Exact inverse of the normalisation in FJoystickBackendSDL::HandleSDLEvent */
+	FORCEINLINE int32 AxisValueToRaw(const float Value)
+	{
+		return FMath::RoundToInt(Value * (Value < 0.f ? 32768.0f : 32767.0f));
+	}
+
+	FORCEINLINE float RawToAxisValue(const int32 Value)
+	{
+		return Value / (Value < 0 ? 32768.0f : 32767.0f);
+	}
+
+	FORCEINLINE uint64 AxisKey(const int DeviceId, const int Axis)
+	{
+		return static_cast<uint64>(static_cast<uint32>(DeviceId)) << 32 | static_cast<uint32>(Axis);
+	}
+
+	void WriteDevice(TArray<uint8>& Buffer, const FDeviceInfoSDL& Device);
+	bool ReadDevice(const uint8*& Data, const uint8* End, FDeviceInfoSDL& Device);
+}
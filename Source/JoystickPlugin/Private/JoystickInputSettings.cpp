@@ -3,12 +3,27 @@
 
 #include "JoystickInputSettings.h"
 #include "JoystickInputDevice.h"
+#include "JoystickLogManager.h"
 #include "JoystickSubsystem.h"
 
 UJoystickInputSettings::UJoystickInputSettings()
 {
 	UseDeviceName = false;
 	IgnoreGameControllers = false;
+	OnlyDispatchChangedAnalogValues = false;
+	UseInputThread = false;
+	InputThreadPollRate = 1000;
+	OpenDevicesAsynchronously = true;
+	UseEvdevBackend = false;
+	InputEventQueueSize = 1024;
+	KeyRegistrationBudget = 0.f;
+	UseDeviceCache = true;
+	UseHapticThread = true;
+	MaxEffectUpdateRate = 250;
+	UseForceFeedbackMixer = false;
+	ForceFeedbackMixerRate = 1000;
+	MaxFreeEffectSlots = 4;
+	ForceFeedbackLoopRate = 1000;
 #if WITH_EDITOR
 	EnableLogs = true;
 #else
@@ -16,6 +31,16 @@ UJoystickInputSettings::UJoystickInputSettings()
 #endif
 }
 
+void UJoystickInputSettings::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		FJoystickLogManager::Get()->SetEnabled(EnableLogs);
+	}
+}
+
 void UJoystickInputSettings::DeviceAdded(const FJoystickInputDeviceInformation JoystickInfo)
 {
 	if (ConnectedDevices.ContainsByPredicate([&](const FJoystickInputDeviceInformation& Device)
@@ -62,21 +87,21 @@ bool UJoystickInputSettings::SetIgnoreGameControllers(const bool NewIgnoreGameCo
 	return OldIgnoreGameControllers != NewIgnoreGameControllers;
 }
 
-int UJoystickInputSettings::GetDeviceIndexByKey(const FKey& Key) const
+const FJoystickKeyInfo* UJoystickInputSettings::GetKeyInfo(const FKey& Key) const
 {
 	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
 	if (!IsValid(JoystickSubsystem))
 	{
-		return -1;
+		return nullptr;
 	}
 
 	const FJoystickInputDevice* InputDevice = JoystickSubsystem->GetInputDevice();
 	if (InputDevice == nullptr)
 	{
-		return -1;
+		return nullptr;
 	}
 
-	return InputDevice->GetDeviceIndexByKey(Key);
+	return InputDevice->GetKeyInfo(Key);
 }
 
 const FJoystickInputDeviceConfiguration* UJoystickInputSettings::GetInputDeviceConfigurationByKey(const FKey& Key) const
@@ -87,9 +112,14 @@ const FJoystickInputDeviceConfiguration* UJoystickInputSettings::GetInputDeviceC
 		return nullptr;
 	}
 
+	const FJoystickKeyInfo* KeyInfo = GetKeyInfo(Key);
+	if (KeyInfo == nullptr)
+	{
+		return nullptr;
+	}
+
 	FJoystickInfo DeviceInfo;
-	const int DeviceIndex = GetDeviceIndexByKey(Key);
-	const bool Result = JoystickSubsystem->GetJoystickInfo(DeviceIndex, DeviceInfo);
+	const bool Result = JoystickSubsystem->GetJoystickInfo(KeyInfo->DeviceId, DeviceInfo);
 	if (Result == false)
 	{
 		return nullptr;
@@ -99,18 +129,20 @@ const FJoystickInputDeviceConfiguration* UJoystickInputSettings::GetInputDeviceC
 
 const FJoystickInputDeviceAxisProperties* UJoystickInputSettings::GetAxisPropertiesByKey(const FKey& AxisKey) const
 {
-	const FJoystickInputDeviceConfiguration* DeviceConfiguration = GetInputDeviceConfigurationByKey(AxisKey);
-	if (DeviceConfiguration == nullptr)
+	const FJoystickKeyInfo* KeyInfo = GetKeyInfo(AxisKey);
+	if (KeyInfo == nullptr || KeyInfo->Type != EJoystickInputEventType::Axis)
 	{
 		return nullptr;
 	}
 
-	const int KeyIndex = GetDeviceIndexByKey(AxisKey);
-	if (KeyIndex == -1)
+	const FJoystickInputDeviceConfiguration* DeviceConfiguration = GetInputDeviceConfigurationByKey(AxisKey);
+	if (DeviceConfiguration == nullptr)
 	{
 		return nullptr;
 	}
 
+	const int KeyIndex = KeyInfo->Index;
+
 	return DeviceConfiguration->AxisProperties.FindByPredicate([&](const FJoystickInputDeviceAxisProperties& AxisProperty)
 	{
 		return AxisProperty.AxisIndex != -1 && AxisProperty.AxisIndex == KeyIndex;
@@ -122,6 +154,8 @@ void UJoystickInputSettings::PostEditChangeChainProperty(FPropertyChangedChainEv
 {
 	Super::PostEditChangeChainProperty(PropertyChangedEvent);
 
+	FJoystickLogManager::Get()->SetEnabled(EnableLogs);
+
 	const UJoystickSubsystem* JoystickSubsystem = GEngine->GetEngineSubsystem<UJoystickSubsystem>();
 	if (!IsValid(JoystickSubsystem))
 	{
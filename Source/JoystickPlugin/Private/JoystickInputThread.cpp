@@ -0,0 +1,57 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickInputThread.h"
+#include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformProcess.h"
+#include "Interfaces/JoystickBackend.h"
+
+FJoystickInputThread::FJoystickInputThread(const TSharedRef<IJoystickBackend>& InBackend, const int InPollRate)
+	: Backend(InBackend)
+	  , PollInterval(1.0 / FMath::Max(InPollRate, 1))
+	  , Thread(nullptr)
+{
+	Thread = FRunnableThread::Create(this, TEXT("JoystickInputThread"), 0, TPri_AboveNormal);
+	if (Thread == nullptr)
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to create the joystick input thread."));
+	}
+}
+
+FJoystickInputThread::~FJoystickInputThread()
+{
+	if (Thread != nullptr)
+	{
+		Thread->Kill(true);
+		delete Thread;
+		Thread = nullptr;
+	}
+}
+
+uint32 FJoystickInputThread::Run()
+{
+	while (!StopRequested)
+	{
+		const double FrameStart = FPlatformTime::Seconds();
+
+		{
+			JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickPollInput);
+			Backend->PollInput();
+		}
+
+		const double Remaining = PollInterval - (FPlatformTime::Seconds() - FrameStart);
+		if (Remaining > 0.0 && !Backend->WaitForInput(Remaining))
+		{
+			FPlatformProcess::SleepNoStats(Remaining);
+		}
+	}
+
+	return 0;
+}
+
+void FJoystickInputThread::Stop()
+{
+	StopRequested = true;
+}
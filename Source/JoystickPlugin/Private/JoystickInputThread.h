@@ -0,0 +1,34 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+
+class FRunnableThread;
+class IJoystickBackend;
+
+/**
+ * Polls a backend at a fixed rate so that joystick samples are captured between game frames.
+ * Events are delivered to the subsystem on this thread and queued per device; the game thread only
+ * drains the queues and never waits on the backend.
+ */
+class FJoystickInputThread final : public FRunnable
+{
+public:
+	FJoystickInputThread(const TSharedRef<IJoystickBackend>& InBackend, const int InPollRate);
+	virtual ~FJoystickInputThread() override;
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	TSharedRef<IJoystickBackend> Backend;
+	double PollInterval;
+
+	FThreadSafeBool StopRequested;
+	FRunnableThread* Thread;
+};
@@ -2,90 +2,146 @@
 // Copyright Jayden Maalouf. All Rights Reserved.
 
 #include "JoystickLogManager.h"
-#include "JoystickInputSettings.h"
+#include "Async/Async.h"
 
 DEFINE_LOG_CATEGORY(LogJoystickPlugin);
 
-static TSharedPtr<FJoystickLogManager> LogManager;
-
-FJoystickLogManager* FJoystickLogManager::Get()
+FJoystickLogManager::FJoystickLogManager()
+	// Matches the EnableLogs default until the settings push the configured value
+	: Enabled(WITH_EDITOR != 0)
+	  , Slots(new FSlot[Capacity])
+	  , WritePosition(0)
+	  , ReadPosition(0)
+	  , DroppedCount(0)
+	  , FlushScheduled(false)
 {
-	if (!LogManager.IsValid())
+	for (uint32 Index = 0; Index < Capacity; Index++)
 	{
-		LogManager = MakeShareable(new FJoystickLogManager());
+		Slots[Index].Sequence.store(Index, std::memory_order_relaxed);
 	}
-
-	return LogManager.Get();
 }
 
-template <typename FmtType, typename... Types>
-void FJoystickLogManager::Log(const ELogVerbosity::Type Level, const FmtType& Fmt, Types... Args)
+FJoystickLogManager* FJoystickLogManager::Get()
 {
-	switch (Level)
-	{
-		case ELogVerbosity::Error:
-			LogError(Fmt, Args...);
-			break;
-		case ELogVerbosity::Log:
-			LogDebug(Fmt, Args...);
-			break;
-		default:
-			LogInformation(Fmt, Args...);
-			break;
-	}
+	// Logging can start on the input thread, so construction has to be thread safe
+	static FJoystickLogManager LogManager;
+	return &LogManager;
 }
 
-template <typename FmtType, typename... Types>
-void FJoystickLogManager::LogWarning(const FmtType& Fmt, Types... Args)
+void FJoystickLogManager::SetEnabled(const bool InEnabled)
 {
-	if (!CanLog())
-	{
-		return;
-	}
+	Enabled.store(InEnabled, std::memory_order_relaxed);
+}
 
-	UE_LOG(LogJoystickPlugin, Warning, TEXT("%s"), *FString::Printf(Fmt, Args...));
+bool FJoystickLogManager::IsEnabled() const
+{
+	return Enabled.load(std::memory_order_relaxed);
 }
 
-template <typename FmtType, typename... Types>
-void FJoystickLogManager::LogError(const FmtType& Fmt, Types... Args)
+FJoystickLogRecord* FJoystickLogManager::BeginWrite(uint32& Position)
 {
-	if (!CanLog())
+	Position = WritePosition.load(std::memory_order_relaxed);
+	for (;;)
 	{
-		return;
+		FSlot& Slot = Slots[Position & (Capacity - 1)];
+		const int32 Difference = static_cast<int32>(Slot.Sequence.load(std::memory_order_acquire) - Position);
+		if (Difference == 0)
+		{
+			if (WritePosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+			{
+				return &Slot.Record;
+			}
+		}
+		else if (Difference < 0)
+		{
+			DroppedCount.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		else
+		{
+			Position = WritePosition.load(std::memory_order_relaxed);
+		}
 	}
-
-	UE_LOG(LogJoystickPlugin, Error, TEXT("%s"), *FString::Printf(Fmt, Args...));
 }
 
-template <typename FmtType, typename... Types>
-void FJoystickLogManager::LogDebug(const FmtType& Fmt, Types... Args)
+void FJoystickLogManager::EndWrite(const uint32 Position)
 {
-	if (!CanLog())
+	Slots[Position & (Capacity - 1)].Sequence.store(Position + 1, std::memory_order_release);
+
+	if (FlushScheduled.exchange(true, std::memory_order_acq_rel))
 	{
 		return;
 	}
 
-	UE_LOG(LogJoystickPlugin, Log, TEXT("%s"), *FString::Printf(Fmt, Args...));
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [this]()
+	{
+		// Cleared first so messages queued while flushing schedule another task
+		FlushScheduled.store(false, std::memory_order_release);
+		Flush();
+	});
 }
 
-template <typename FmtType, typename... Types>
-void FJoystickLogManager::LogInformation(const FmtType& Fmt, Types... Args)
+void FJoystickLogManager::Flush()
 {
-	if (!CanLog())
+	for (;;)
 	{
-		return;
+		uint32 Position = ReadPosition.load(std::memory_order_relaxed);
+		FSlot* Slot = nullptr;
+		for (;;)
+		{
+			FSlot& Candidate = Slots[Position & (Capacity - 1)];
+			const int32 Difference = static_cast<int32>(Candidate.Sequence.load(std::memory_order_acquire) - (Position + 1));
+			if (Difference == 0)
+			{
+				if (ReadPosition.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+				{
+					Slot = &Candidate;
+					break;
+				}
+			}
+			else if (Difference < 0)
+			{
+				break;
+			}
+			else
+			{
+				Position = ReadPosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		if (Slot == nullptr)
+		{
+			break;
+		}
+
+		Write(Slot->Record);
+		Slot->Sequence.store(Position + Capacity, std::memory_order_release);
 	}
 
-	UE_LOG(LogJoystickPlugin, Display, TEXT("%s"), *FString::Printf(Fmt, Args...));
+	const uint32 Dropped = DroppedCount.exchange(0, std::memory_order_relaxed);
+	if (Dropped > 0)
+	{
+		UE_LOG(LogJoystickPlugin, Warning, TEXT("%u log messages were dropped, the log ring was full"), Dropped);
+	}
 }
 
-bool FJoystickLogManager::CanLog() const
+void FJoystickLogManager::Write(const FJoystickLogRecord& Record) const
 {
-	const UJoystickInputSettings* JoystickInputSettings = GetMutableDefault<UJoystickInputSettings>();
-	if (!IsValid(JoystickInputSettings))
+	const FString Message = Record.Formatter(Record.Fmt, Record.Arguments);
+
+	switch (Record.Verbosity)
 	{
-		return false;
+		case ELogVerbosity::Error:
+			UE_LOG(LogJoystickPlugin, Error, TEXT("%s"), *Message);
+			break;
+		case ELogVerbosity::Warning:
+			UE_LOG(LogJoystickPlugin, Warning, TEXT("%s"), *Message);
+			break;
+		case ELogVerbosity::Log:
+			UE_LOG(LogJoystickPlugin, Log, TEXT("%s"), *Message);
+			break;
+		default:
+			UE_LOG(LogJoystickPlugin, Display, TEXT("%s"), *Message);
+			break;
 	}
-
-	return JoystickInputSettings->EnableLogs;
 }
@@ -3,13 +3,95 @@
 
 #pragma once
 
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+#include <atomic>
+#include <type_traits>
+
 DECLARE_LOG_CATEGORY_EXTERN(LogJoystickPlugin, Log, All);
 
+// Debug messages are compiled out of shipping builds unless JOYSTICK_LOG_DEBUG=1 is defined by the build
+#ifndef JOYSTICK_LOG_DEBUG
+#define JOYSTICK_LOG_DEBUG !UE_BUILD_SHIPPING
+#endif
+
+/* Fixed size copy of a string argument, queued messages must not point at memory the caller may free */
+struct FJoystickLogString
+{
+	static constexpr int32 MaxLength = 64;
+
+	TCHAR Text[MaxLength];
+};
+
+namespace JoystickLog
+{
+	/* How an argument is stored while its message waits in the ring */
+	template <typename T>
+	struct TArgument
+	{
+		using Type = T;
+
+		static T Capture(const T Value) { return Value; }
+		static T Pass(const T& Value) { return Value; }
+	};
+
+	template <>
+	struct TArgument<const TCHAR*>
+	{
+		using Type = FJoystickLogString;
+
+		static FJoystickLogString Capture(const TCHAR* Value)
+		{
+			FJoystickLogString String;
+			FCString::Strncpy(String.Text, Value != nullptr ? Value : TEXT(""), FJoystickLogString::MaxLength);
+			return String;
+		}
+
+		static const TCHAR* Pass(const FJoystickLogString& Value) { return Value.Text; }
+	};
+
+	template <>
+	struct TArgument<TCHAR*> : TArgument<const TCHAR*>
+	{
+	};
+}
+
+/**
+ * A message logged off the game thread. Only the format pointer and the raw arguments are kept,
+ * formatting happens when the ring is flushed.
+ */
+struct FJoystickLogRecord
+{
+	static constexpr int32 ArgumentSize = 256;
+
+	using FFormatter = FString(*)(const void* Fmt, const uint8* Arguments);
+
+	ELogVerbosity::Type Verbosity = ELogVerbosity::Log;
+	const void* Fmt = nullptr;
+	FFormatter Formatter = nullptr;
+
+	alignas(16) uint8 Arguments[ArgumentSize];
+};
+
+/**
+ * Messages from the game thread go straight to UE_LOG. Messages from the input and haptic threads are pushed into a
+ * bounded lock-free ring, then formatted and written by a background task. When the ring is full messages are dropped
+ * and the count is reported on the next flush.
+ */
 class JOYSTICKPLUGIN_API FJoystickLogManager
 {
 public:
+	FJoystickLogManager();
+
 	static FJoystickLogManager* Get();
 
+	/* Mirrors UJoystickInputSettings::EnableLogs, kept here so log calls never touch the settings object */
+	void SetEnabled(const bool InEnabled);
+	bool IsEnabled() const;
+
+	/* Formats and writes every queued message on the calling thread */
+	void Flush();
+
 	template <class FmtType, class... Types>
 	void Log(ELogVerbosity::Type Level, const FmtType& Fmt, Types... Args);
 
@@ -26,5 +108,143 @@ public:
 	void LogInformation(const FmtType& Fmt, Types... Args);
 
 private:
-	bool CanLog() const;
+	struct FSlot
+	{
+		std::atomic<uint32> Sequence;
+		FJoystickLogRecord Record;
+	};
+
+	static constexpr uint32 Capacity = 256;
+
+	bool CanLog(const ELogVerbosity::Type Verbosity) const;
+
+	template <class FmtType, class... Types>
+	bool Defer(const ELogVerbosity::Type Verbosity, const FmtType& Fmt, Types... Args);
+
+	template <class FmtType, class... Types>
+	static FString Format(const void* Fmt, const uint8* Arguments);
+
+	FJoystickLogRecord* BeginWrite(uint32& Position);
+	void EndWrite(const uint32 Position);
+	void Write(const FJoystickLogRecord& Record) const;
+
+	std::atomic<bool> Enabled;
+
+	TUniquePtr<FSlot[]> Slots;
+	std::atomic<uint32> WritePosition;
+	std::atomic<uint32> ReadPosition;
+	std::atomic<uint32> DroppedCount;
+	std::atomic<bool> FlushScheduled;
 };
+
+template <class FmtType, class... Types>
+void FJoystickLogManager::Log(const ELogVerbosity::Type Level, const FmtType& Fmt, Types... Args)
+{
+	switch (Level)
+	{
+		case ELogVerbosity::Error:
+			LogError(Fmt, Args...);
+			break;
+		case ELogVerbosity::Log:
+			LogDebug(Fmt, Args...);
+			break;
+		default:
+			LogInformation(Fmt, Args...);
+			break;
+	}
+}
+
+template <class FmtType, class... Types>
+void FJoystickLogManager::LogWarning(const FmtType& Fmt, Types... Args)
+{
+	if (!CanLog(ELogVerbosity::Warning) || Defer(ELogVerbosity::Warning, Fmt, Args...))
+	{
+		return;
+	}
+
+	UE_LOG(LogJoystickPlugin, Warning, TEXT("%s"), *FString::Printf(Fmt, Args...));
+}
+
+template <class FmtType, class... Types>
+void FJoystickLogManager::LogError(const FmtType& Fmt, Types... Args)
+{
+	if (!CanLog(ELogVerbosity::Error) || Defer(ELogVerbosity::Error, Fmt, Args...))
+	{
+		return;
+	}
+
+	UE_LOG(LogJoystickPlugin, Error, TEXT("%s"), *FString::Printf(Fmt, Args...));
+}
+
+template <class FmtType, class... Types>
+void FJoystickLogManager::LogDebug(const FmtType& Fmt, Types... Args)
+{
+#if JOYSTICK_LOG_DEBUG
+	if (!CanLog(ELogVerbosity::Log) || Defer(ELogVerbosity::Log, Fmt, Args...))
+	{
+		return;
+	}
+
+	UE_LOG(LogJoystickPlugin, Log, TEXT("%s"), *FString::Printf(Fmt, Args...));
+#endif
+}
+
+template <class FmtType, class... Types>
+void FJoystickLogManager::LogInformation(const FmtType& Fmt, Types... Args)
+{
+	if (!CanLog(ELogVerbosity::Display) || Defer(ELogVerbosity::Display, Fmt, Args...))
+	{
+		return;
+	}
+
+	UE_LOG(LogJoystickPlugin, Display, TEXT("%s"), *FString::Printf(Fmt, Args...));
+}
+
+inline bool FJoystickLogManager::CanLog(const ELogVerbosity::Type Verbosity) const
+{
+	return Enabled.load(std::memory_order_relaxed) && !LogJoystickPlugin.IsSuppressed(Verbosity);
+}
+
+template <class FmtType, class... Types>
+bool FJoystickLogManager::Defer(const ELogVerbosity::Type Verbosity, const FmtType& Fmt, Types... Args)
+{
+	if (IsInGameThread())
+	{
+		return false;
+	}
+
+	using FArguments = TTuple<typename JoystickLog::TArgument<Types>::Type...>;
+	static_assert(sizeof(FArguments) <= FJoystickLogRecord::ArgumentSize, "Too many log arguments to queue");
+	static_assert(alignof(FArguments) <= 16, "Log argument alignment too large to queue");
+	static_assert((std::is_trivially_destructible<typename JoystickLog::TArgument<Types>::Type>::value && ...), "Queued log arguments must be trivially destructible");
+
+	uint32 Position;
+	FJoystickLogRecord* Record = BeginWrite(Position);
+	if (Record == nullptr)
+	{
+		return true;
+	}
+
+	Record->Verbosity = Verbosity;
+	Record->Fmt = &Fmt;
+	Record->Formatter = &FJoystickLogManager::Format<FmtType, Types...>;
+	new(Record->Arguments) FArguments(JoystickLog::TArgument<Types>::Capture(Args)...);
+
+	EndWrite(Position);
+	return true;
+}
+
+template <class FmtType, class... Types>
+FString FJoystickLogManager::Format(const void* Fmt, const uint8* Arguments)
+{
+	using FArguments = TTuple<typename JoystickLog::TArgument<Types>::Type...>;
+
+	// Format strings are literals, so the pointer taken when the message was queued is still valid
+	const FmtType& Format = *static_cast<const FmtType*>(Fmt);
+	const FArguments& Captured = *reinterpret_cast<const FArguments*>(Arguments);
+
+	return Captured.ApplyAfter([&Format](const auto&... Values)
+	{
+		return FString::Printf(Format, JoystickLog::TArgument<Types>::Pass(Values)...);
+	});
+}
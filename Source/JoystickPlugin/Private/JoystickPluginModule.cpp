@@ -4,6 +4,7 @@
 #include "JoystickPluginModule.h"
 #include "Misc/Paths.h"
 #include "JoystickInputDevice.h"
+#include "JoystickLogManager.h"
 #include "JoystickSubsystem.h"
 #include "Interfaces/IPluginManager.h"
 
@@ -42,6 +43,8 @@ void FJoystickPluginModule::ShutdownModule()
 
 	IJoystickPlugin::ShutdownModule();
 
+	FJoystickLogManager::Get()->Flush();
+
 	if (JoystickInputDevice.IsValid())
 	{
 		JoystickInputDevice.Reset();
@@ -0,0 +1,28 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickStats.h"
+
+DEFINE_STAT(STAT_JoystickSendControllerEvents);
+DEFINE_STAT(STAT_JoystickDrainInputEvents);
+DEFINE_STAT(STAT_JoystickBackendUpdate);
+DEFINE_STAT(STAT_JoystickPollInput);
+DEFINE_STAT(STAT_JoystickHandleSDLEvent);
+DEFINE_STAT(STAT_JoystickUpdateAxisProperties);
+DEFINE_STAT(STAT_JoystickRegisterKeys);
+DEFINE_STAT(STAT_JoystickHapticCall);
+DEFINE_STAT(STAT_JoystickHapticCommand);
+DEFINE_STAT(STAT_JoystickHapticMix);
+DEFINE_STAT(STAT_JoystickForceFeedbackLoop);
+
+DEFINE_STAT(STAT_JoystickInputEvents);
+DEFINE_STAT(STAT_JoystickAnalogDispatches);
+DEFINE_STAT(STAT_JoystickButtonEdges);
+DEFINE_STAT(STAT_JoystickHapticCalls);
+DEFINE_STAT(STAT_JoystickHapticUpdatesSkipped);
+DEFINE_STAT(STAT_JoystickHapticUpdatesCoalesced);
+DEFINE_STAT(STAT_JoystickHapticSlotsReused);
+DEFINE_STAT(STAT_JoystickHapticSlotsEvicted);
+DEFINE_STAT(STAT_JoystickConnectedDevices);
+
+UE_TRACE_CHANNEL_DEFINE(JoystickChannel);
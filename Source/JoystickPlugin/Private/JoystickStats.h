@@ -0,0 +1,47 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+DECLARE_STATS_GROUP(TEXT("Joystick"), STATGROUP_Joystick, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Send Controller Events"), STAT_JoystickSendControllerEvents, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Drain Input Events"), STAT_JoystickDrainInputEvents, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Backend Update"), STAT_JoystickBackendUpdate, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Poll Input"), STAT_JoystickPollInput, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Handle SDL Event"), STAT_JoystickHandleSDLEvent, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Axis Properties"), STAT_JoystickUpdateAxisProperties, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Register Keys"), STAT_JoystickRegisterKeys, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Haptic Call"), STAT_JoystickHapticCall, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Haptic Command"), STAT_JoystickHapticCommand, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Haptic Mix"), STAT_JoystickHapticMix, STATGROUP_Joystick, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Force Feedback Loop"), STAT_JoystickForceFeedbackLoop, STATGROUP_Joystick, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Input Events"), STAT_JoystickInputEvents, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Analog Dispatches"), STAT_JoystickAnalogDispatches, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Button Edges"), STAT_JoystickButtonEdges, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Haptic Calls"), STAT_JoystickHapticCalls, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Haptic Updates Skipped"), STAT_JoystickHapticUpdatesSkipped, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Haptic Updates Coalesced"), STAT_JoystickHapticUpdatesCoalesced, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Haptic Slots Reused"), STAT_JoystickHapticSlotsReused, STATGROUP_Joystick, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Haptic Slots Evicted"), STAT_JoystickHapticSlotsEvicted, STATGROUP_Joystick, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Connected Devices"), STAT_JoystickConnectedDevices, STATGROUP_Joystick, );
+
+/* Device changes, dispatch cost and haptic timing in Unreal Insights, enable with -trace=cpu,joystick */
+UE_TRACE_CHANNEL_EXTERN(JoystickChannel);
+
+/* Stats are compiled out of Test and Shipping, the trace scope keeps the timing visible there */
+#define JOYSTICK_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, JoystickChannel)
+
+/* Counts the call and times it both as a stat and as a per command trace scope. Used by the backend haptic methods so
+ * calls from the haptic thread, the mixer, the effect pools and the force stream are all counted where they reach SDL. */
+#define JOYSTICK_HAPTIC_SCOPE(Command) \
+	INC_DWORD_STAT(STAT_JoystickHapticCalls); \
+	SCOPE_CYCLE_COUNTER(STAT_JoystickHapticCall); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(JoystickHaptic_##Command, JoystickChannel)
@@ -4,21 +4,171 @@
 #include "JoystickSubsystem.h"
 #include "JoystickFunctionLibrary.h"
 #include "JoystickInputDevice.h"
+#include "JoystickInputRecorder.h"
 #include "JoystickInputSettings.h"
+#include "JoystickInputThread.h"
+#include "JoystickHapticThread.h"
+#include "JoystickForceFeedbackLoop.h"
+#include "JoystickVirtualDevices.h"
+#include "JoystickDeviceCache.h"
 #include "JoystickLogManager.h"
+#include "JoystickStats.h"
+#include "Backend/JoystickBackendEvdev.h"
+#include "Backend/JoystickBackendReplay.h"
+#include "Backend/JoystickBackendSDL.h"
+#include "Data/JoystickLatencyHistogram.h"
+#include "Engine/Engine.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
 #include "Runtime/Launch/Resources/Version.h"
 
-THIRD_PARTY_INCLUDES_START
+namespace
+{
+	UJoystickSubsystem* GetJoystickSubsystem()
+	{
+		return GEngine != nullptr ? GEngine->GetEngineSubsystem<UJoystickSubsystem>() : nullptr;
+	}
+
+	FAutoConsoleCommand StartRecordingCommand(
+		TEXT("Joystick.Record"),
+		TEXT("Records raw joystick input. Joystick.Record [Path], defaults to Saved/Joystick."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem())
+			{
+				JoystickSubsystem->StartRecording(Args.Num() > 0 ? Args[0] : FString());
+			}
+		}));
+
+	FAutoConsoleCommand StopRecordingCommand(
+		TEXT("Joystick.StopRecording"),
+		TEXT("Stops the joystick input recording and flushes it to disk."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem())
+			{
+				JoystickSubsystem->StopRecording();
+			}
+		}));
+
+	FAutoConsoleCommand StartReplayCommand(
+		TEXT("Joystick.Replay"),
+		TEXT("Replays a joystick input recording. Joystick.Replay <Path> [Fast]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem();
+			if (JoystickSubsystem == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+
+			JoystickSubsystem->StartReplay(Args[0], Args.Num() > 1 && Args[1].Equals(TEXT("Fast"), ESearchCase::IgnoreCase));
+		}));
+
+	FAutoConsoleCommand CreateVirtualDevicesCommand(
+		TEXT("Joystick.CreateVirtualDevices"),
+		TEXT("Attaches SDL virtual joysticks. Joystick.CreateVirtualDevices <Count> [Axes] [Buttons] [Hats] [ScriptPath]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem();
+			if (JoystickSubsystem == nullptr || Args.Num() == 0)
+			{
+				return;
+			}
+
+			JoystickSubsystem->CreateVirtualDevices(FCString::Atoi(*Args[0]),
+			                                        Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 6,
+			                                        Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 32,
+			                                        Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 1,
+			                                        Args.Num() > 4 ? Args[4] : FString());
+		}));
+
+	FAutoConsoleCommand DestroyVirtualDevicesCommand(
+		TEXT("Joystick.DestroyVirtualDevices"),
+		TEXT("Detaches the SDL virtual joysticks."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem())
+			{
+				JoystickSubsystem->DestroyVirtualDevices();
+			}
+		}));
+
+	void PrintLatencyStage(FOutputDevice& Ar, const TCHAR* Stage, const FJoystickLatencyPercentiles& Percentiles)
+	{
+		if (Percentiles.SampleCount == 0)
+		{
+			Ar.Logf(TEXT("    %-16s not measured"), Stage);
+			return;
+		}
+
+		Ar.Logf(TEXT("    %-16s p50 %7.3f  p95 %7.3f  p99 %7.3f  max %7.3f  mean %7.3f ms"), Stage, Percentiles.P50, Percentiles.P95, Percentiles.P99, Percentiles.Max, Percentiles.Mean);
+	}
+
+	FAutoConsoleCommand LatencyCommand(
+		TEXT("Joystick.Latency"),
+		TEXT("Joystick input latency tracking. Joystick.Latency [On|Off|Reset], prints the histograms without arguments."),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+		{
+			UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem();
+			if (JoystickSubsystem == nullptr)
+			{
+				return;
+			}
+
+			if (Args.Num() > 0)
+			{
+				if (Args[0].Equals(TEXT("Reset"), ESearchCase::IgnoreCase))
+				{
+					JoystickSubsystem->ResetInputLatency();
+				}
+				else
+				{
+					JoystickSubsystem->SetLatencyTrackingEnabled(Args[0].Equals(TEXT("On"), ESearchCase::IgnoreCase) || Args[0] == TEXT("1"));
+				}
+
+				return;
+			}
 
-#include "SDL.h"
-#include "SDL_haptic.h"
-#include "SDL_joystick.h"
+			Ar.Logf(TEXT("Joystick latency tracking is %s"), JoystickSubsystem->IsLatencyTrackingEnabled() ? TEXT("on") : TEXT("off"));
 
-THIRD_PARTY_INCLUDES_END
+			static const TCHAR* InputTypeNames[] = {TEXT("Axis"), TEXT("Button"), TEXT("Hat"), TEXT("Ball")};
+
+			TArray<int> DeviceIds;
+			JoystickSubsystem->GetDeviceIds(DeviceIds);
+			for (const int DeviceId : DeviceIds)
+			{
+				for (int InputType = 0; InputType < UE_ARRAY_COUNT(InputTypeNames); InputType++)
+				{
+					FJoystickInputLatency Latency;
+					if (!JoystickSubsystem->GetInputLatency(DeviceId, static_cast<EJoystickLatencyInputType>(InputType), Latency) || Latency.Total.SampleCount == 0)
+					{
+						continue;
+					}
+
+					Ar.Logf(TEXT("  Device %d %s, %lld samples"), DeviceId, InputTypeNames[InputType], Latency.Total.SampleCount);
+					PrintLatencyStage(Ar, TEXT("Event to queue"), Latency.EventToQueue);
+					PrintLatencyStage(Ar, TEXT("Queue to dispatch"), Latency.QueueToDispatch);
+					PrintLatencyStage(Ar, TEXT("Total"), Latency.Total);
+				}
+			}
+		}));
+
+	FAutoConsoleCommand StopReplayCommand(
+		TEXT("Joystick.StopReplay"),
+		TEXT("Stops the joystick input replay and unplugs the replayed devices."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			if (UJoystickSubsystem* JoystickSubsystem = GetJoystickSubsystem())
+			{
+				JoystickSubsystem->StopReplay();
+			}
+		}));
+}
 
 UJoystickSubsystem::UJoystickSubsystem()
-	: OwnsSDL(false)
-	  , IsInitialised(false)
+	: IsInitialised(false)
 {
 }
 
@@ -32,19 +182,37 @@ void UJoystickSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 		JoystickInputSettings->ResetDevices();
 	}
 
-	FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL Starting"));
+	if (IsValid(JoystickInputSettings) && JoystickInputSettings->UseDeviceCache)
+	{
+		DeviceCache = MakeShared<FJoystickDeviceCache>(FJoystickDeviceCache::GetDefaultPath());
+		DeviceCache->Load();
+	}
 
-	if (SDL_WasInit(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC) != 0)
+	if (IsValid(JoystickInputSettings) && JoystickInputSettings->UseHapticThread)
 	{
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL already loaded"));
-		OwnsSDL = false;
+		const int MixerRate = JoystickInputSettings->UseForceFeedbackMixer ? JoystickInputSettings->ForceFeedbackMixerRate : 0;
+		HapticThread = MakeShared<FJoystickHapticThread>(JoystickInputSettings->MaxEffectUpdateRate, MixerRate, JoystickInputSettings->MaxFreeEffectSlots);
+		if (!HapticThread->IsRunning())
+		{
+			HapticThread.Reset();
+		}
 	}
-	else
+
+#if PLATFORM_LINUX
+	if (IsValid(JoystickInputSettings) && JoystickInputSettings->UseEvdevBackend)
 	{
-		FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL::InitSDL() SDL init 0"));
-		SDL_Init(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER | SDL_INIT_HAPTIC);
-		OwnsSDL = true;
+		FJoystickLogManager::Get()->LogInformation(TEXT("Reading joysticks through evdev"));
+		InputBackend = MakeShared<FJoystickBackendEvdev>();
 	}
+#endif
+
+	if (!InputBackend.IsValid())
+	{
+		SDLBackend = MakeShared<FJoystickBackendSDL>();
+		InputBackend = SDLBackend;
+	}
+
+	RegisterBackend(InputBackend.ToSharedRef());
 
 	if (JoystickSubsystemReady.IsBound())
 	{
@@ -58,18 +226,35 @@ void UJoystickSubsystem::Deinitialize()
 {
 	Super::Deinitialize();
 
-	FJoystickLogManager::Get()->LogDebug(TEXT("DeviceSDL Closing"));
+	// Stop polling before the devices are closed underneath the input thread
+	InputThread.Reset();
 
-	for (const TTuple<int, FDeviceInfoSDL>& Device : Devices)
+	if (HapticThread.IsValid())
+	{
+		HapticThread->SetForceFeedbackLoop(nullptr);
+	}
+
+	ForceFeedbackLoop.Reset();
+
+	StopRecording();
+	StopReplay();
+	VirtualDevices.Reset();
+
+	// Backends detach their devices as they shut down
+	const TArray<TSharedRef<IJoystickBackend>> RegisteredBackends = Backends;
+	for (const TSharedRef<IJoystickBackend>& Backend : RegisteredBackends)
 	{
-		RemoveDevice(Device.Key);
+		UnregisterBackend(Backend);
 	}
 
-	SDL_DelEventWatch(HandleSDLEvent, this);
+	HapticThread.Reset();
+	InputBackend.Reset();
+	SDLBackend.Reset();
 
-	if (OwnsSDL)
+	if (DeviceCache.IsValid())
 	{
-		SDL_Quit();
+		DeviceCache->Save();
+		DeviceCache.Reset();
 	}
 
 	IsInitialised = false;
@@ -84,24 +269,39 @@ void UJoystickSubsystem::InitialiseInputDevice(const TSharedPtr<FJoystickInputDe
 
 	InputDevicePtr = NewInputDevice;
 
-	const int Result = SDL_WasInit(SDL_INIT_JOYSTICK);
-	if (Result == 0)
+	// Known devices get their keys before any of them has finished opening
+	if (DeviceCache.IsValid())
 	{
-		return;
+		NewInputDevice->RegisterCachedKeys(*DeviceCache);
+	}
+
+	for (const TSharedRef<IJoystickBackend>& Backend : Backends)
+	{
+		Backend->EnumerateDevices();
 	}
 
-	const int JoystickCount = GetJoystickCount();
-	for (int i = 0; i < JoystickCount; i++)
+	if (!InputBackend.IsValid())
 	{
-		AddDevice(i);
+		return;
 	}
 
-	SDL_AddEventWatch(HandleSDLEvent, this);
+	const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
+	if (IsValid(JoystickInputSettings) && JoystickInputSettings->UseInputThread)
+	{
+		FJoystickLogManager::Get()->LogDebug(TEXT("Starting input thread at %d Hz"), JoystickInputSettings->InputThreadPollRate);
+		InputThread = MakeShared<FJoystickInputThread>(InputBackend.ToSharedRef(), JoystickInputSettings->InputThreadPollRate);
+	}
 }
 
 int UJoystickSubsystem::GetJoystickCount() const
 {
-	return SDL_NumJoysticks();
+	int JoystickCount = 0;
+	for (const TSharedRef<IJoystickBackend>& Backend : Backends)
+	{
+		JoystickCount += Backend->GetDeviceCount();
+	}
+
+	return JoystickCount;
 }
 
 int UJoystickSubsystem::GetRegisteredDeviceCount() const
@@ -123,14 +323,41 @@ bool UJoystickSubsystem::GetJoystickData(const int DeviceId, FJoystickDeviceData
 		return false;
 	}
 
+	return InputDevice->GetDeviceData(DeviceId, JoystickDeviceData);
+}
 
-	if (const FJoystickDeviceData* DeviceData = InputDevice->GetDeviceData(DeviceId))
+bool UJoystickSubsystem::GetButtonMask(const int DeviceId, TArray<int64>& ButtonMask) const
+{
+	const FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
 	{
-		JoystickDeviceData = *DeviceData;
-		return true;
+		return false;
 	}
 
-	return false;
+	TArray<uint64> ButtonWords;
+	if (!InputDevice->GetButtonMask(DeviceId, ButtonWords))
+	{
+		return false;
+	}
+
+	ButtonMask.Reset(ButtonWords.Num());
+	for (const uint64 ButtonWord : ButtonWords)
+	{
+		ButtonMask.Add(static_cast<int64>(ButtonWord));
+	}
+
+	return true;
+}
+
+bool UJoystickSubsystem::GetAxisFrameData(const int DeviceId, const int Axis, FAxisFrameData& AxisFrameData) const
+{
+	const FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
+	{
+		return false;
+	}
+
+	return InputDevice->GetAxisFrameData(DeviceId, Axis, AxisFrameData);
 }
 
 bool UJoystickSubsystem::GetJoystickInfo(const int DeviceId, FJoystickInfo& JoystickInfo) const
@@ -174,7 +401,7 @@ void UJoystickSubsystem::SetIgnoreGameControllers(const bool IgnoreControllers)
 	{
 		for (const TTuple<int, FDeviceInfoSDL>& Device : Devices)
 		{
-			if (DeviceMapping.Contains(Device.Value.InstanceId) && SDL_IsGameController(Device.Value.DeviceIndex))
+			if (Device.Value.Backend != nullptr && Device.Value.IsGamepad)
 			{
 				RemoveDevice(Device.Key);
 			}
@@ -182,12 +409,15 @@ void UJoystickSubsystem::SetIgnoreGameControllers(const bool IgnoreControllers)
 	}
 	else if (ChangedValue && !IgnoreControllers)
 	{
-		const int JoystickCount = GetJoystickCount();
-		for (int i = 0; i < JoystickCount; i++)
+		for (const TSharedRef<IJoystickBackend>& Backend : Backends)
 		{
-			if (SDL_IsGameController(i))
+			const int JoystickCount = Backend->GetDeviceCount();
+			for (int i = 0; i < JoystickCount; i++)
 			{
-				AddDevice(i);
+				if (Backend->IsGamepad(i))
+				{
+					AddDevice(*Backend, i);
+				}
 			}
 		}
 	}
@@ -204,243 +434,390 @@ void UJoystickSubsystem::GetDeviceIds(TArray<int>& DeviceIds) const
 	InputDevice->GetDeviceIds(DeviceIds);
 }
 
-void UJoystickSubsystem::AddHapticDevice(FDeviceInfoSDL& Device) const
+int64 UJoystickSubsystem::GetSuppressedAnalogDispatchCount() const
 {
-	Device.Haptic = SDL_HapticOpenFromJoystick(Device.Joystick);
-	if (Device.Haptic != nullptr)
+	const FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
 	{
-		FJoystickLogManager::Get()->LogDebug(TEXT("Haptic Device detected"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("Number of Haptic Axis: %i"), SDL_HapticNumAxes(Device.Haptic));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_CONSTANT support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_CONSTANT) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SINE support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_SINE) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_TRIANGLE support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_TRIANGLE) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SAWTOOTHUP support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_SAWTOOTHUP) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SAWTOOTHDOWN support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_SAWTOOTHDOWN) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_RAMP support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_RAMP) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_SPRING support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_SPRING) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_DAMPER support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_DAMPER) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_INERTIA support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_INERTIA) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_FRICTION support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_FRICTION) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_CUSTOM support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_CUSTOM) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_GAIN support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_GAIN) == 1 ? TEXT("true") : TEXT("false"));
-		FJoystickLogManager::Get()->LogDebug(TEXT("SDL_HAPTIC_AUTOCENTER support: %s"), (SDL_HapticQuery(Device.Haptic) & SDL_HAPTIC_AUTOCENTER) == 1 ? TEXT("true") : TEXT("false"));
+		return 0;
 	}
+
+	return InputDevice->GetSuppressedAnalogDispatchCount();
 }
 
-bool UJoystickSubsystem::AddDevice(const int DeviceIndex)
+void UJoystickSubsystem::SetLatencyTrackingEnabled(const bool Enabled)
 {
-	const UJoystickInputSettings* JoystickInputSettings = GetMutableDefault<UJoystickInputSettings>();
-	if (!IsValid(JoystickInputSettings))
+	JoystickLatency::TrackingEnabled.store(Enabled, std::memory_order_relaxed);
+}
+
+bool UJoystickSubsystem::IsLatencyTrackingEnabled() const
+{
+	return JoystickLatency::IsTrackingEnabled();
+}
+
+bool UJoystickSubsystem::GetInputLatency(const int DeviceId, const EJoystickLatencyInputType InputType, FJoystickInputLatency& Latency) const
+{
+	const FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
 	{
 		return false;
 	}
 
-	const bool IsGamepad = SDL_IsGameController(DeviceIndex) == SDL_TRUE;
-	if (IsGamepad && JoystickInputSettings->GetIgnoreGameControllers())
+	return InputDevice->GetInputLatency(DeviceId, static_cast<EJoystickInputEventType>(InputType), Latency);
+}
+
+void UJoystickSubsystem::ResetInputLatency()
+{
+	FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
+	{
+		return;
+	}
+
+	InputDevice->ResetInputLatency();
+}
+
+bool UJoystickSubsystem::StartRecording(const FString& Path)
+{
+	StopRecording();
+
+	const FString RecordingPath = Path.IsEmpty()
+		                              ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("Joystick"), FString::Printf(TEXT("Recording-%s.joyrec"), *FDateTime::Now().ToString()))
+		                              : Path;
+
+	TArray<FDeviceInfoSDL> ConnectedDevices;
+	for (const TTuple<int, FDeviceInfoSDL>& Device : Devices)
+	{
+		if (Device.Value.Backend != nullptr && !Device.Value.IsReplayed)
+		{
+			ConnectedDevices.Add(Device.Value);
+		}
+	}
+
+	const TSharedPtr<FJoystickInputRecorder> NewRecorder = MakeShared<FJoystickInputRecorder>(RecordingPath, ConnectedDevices);
+	if (!NewRecorder->IsRecording())
 	{
-		// Let UE handle it
 		return false;
 	}
 
-	FDeviceInfoSDL Device;
-	Device.DeviceIndex = DeviceIndex;
-	Device.IsGamepad = IsGamepad;
+	FScopeLock Lock(&RecorderLock);
+	Recorder = NewRecorder;
+	RecordingInput = true;
+	return true;
+}
 
-	Device.Joystick = SDL_JoystickOpen(DeviceIndex);
-	if (Device.Joystick == nullptr)
+void UJoystickSubsystem::StopRecording()
+{
+	TSharedPtr<FJoystickInputRecorder> FinishedRecorder;
+	{
+		FScopeLock Lock(&RecorderLock);
+		RecordingInput = false;
+		FinishedRecorder = MoveTemp(Recorder);
+	}
+
+	// Flushing waits on the disk, keep it outside the lock so the input thread is not held up
+	FinishedRecorder.Reset();
+}
+
+bool UJoystickSubsystem::IsRecording() const
+{
+	return RecordingInput;
+}
+
+bool UJoystickSubsystem::StartReplay(const FString& Path, const bool AsFastAsPossible)
+{
+	StopReplay();
+
+	const TSharedPtr<FJoystickBackendReplay> NewReplay = MakeShared<FJoystickBackendReplay>(Path, AsFastAsPossible);
+	if (!NewReplay->IsValid())
 	{
 		return false;
 	}
 
-	Device.InstanceId = SDL_JoystickInstanceID(Device.Joystick);
-	GetDeviceIndexGuid(DeviceIndex, Device.ProductId);
+	FJoystickLogManager::Get()->LogInformation(TEXT("Replaying %s%s"), *Path, AsFastAsPossible ? TEXT(" as fast as possible") : TEXT(""));
+	ReplayBackend = NewReplay;
+	RegisterBackend(ReplayBackend.ToSharedRef());
+	return true;
+}
+
+void UJoystickSubsystem::StopReplay()
+{
+	if (!ReplayBackend.IsValid())
+	{
+		return;
+	}
 
-	// DEBUG
-	Device.DeviceName = FString(ANSI_TO_TCHAR(SDL_JoystickName(Device.Joystick)));
-	FJoystickLogManager::Get()->LogDebug(TEXT("%s:"), *Device.DeviceName);
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tInstance ID: %d"), Device.InstanceId);
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tDevice Index: %d"), Device.DeviceIndex);
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Axis %i"), SDL_JoystickNumAxes(Device.Joystick));
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Balls %i"), SDL_JoystickNumBalls(Device.Joystick));
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Buttons %i"), SDL_JoystickNumButtons(Device.Joystick));
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tNumber of Hats %i"), SDL_JoystickNumHats(Device.Joystick));
+	UnregisterBackend(ReplayBackend.ToSharedRef());
+	ReplayBackend.Reset();
+}
 
-#if ENGINE_MAJOR_VERSION == 5
-	const bool HasRumble = SDL_JoystickHasRumble(Device.Joystick) == SDL_TRUE;
-#else
-	const bool HasRumble = false;
-#endif
-	FJoystickLogManager::Get()->LogDebug(TEXT("\tRumble Support: %s"), HasRumble ? TEXT("true") : TEXT("false"));
-	Device.HasRumble = HasRumble;
+bool UJoystickSubsystem::IsReplaying() const
+{
+	return ReplayBackend.IsValid();
+}
+
+bool UJoystickSubsystem::CreateVirtualDevices(const int Count, const int AxisCount, const int ButtonCount, const int HatCount, const FString& ScriptPath)
+{
+	if (!SDLBackend.IsValid())
+	{
+		return false;
+	}
+
+	if (!VirtualDevices.IsValid())
+	{
+		VirtualDevices = MakeShared<FJoystickVirtualDevices>();
+	}
+
+	// The devices arrive through SDL_JOYDEVICEADDED and are added on the next update like any other device
+	return VirtualDevices->Create(Count, AxisCount, ButtonCount, HatCount, ScriptPath);
+}
+
+void UJoystickSubsystem::DestroyVirtualDevices()
+{
+	if (VirtualDevices.IsValid())
+	{
+		VirtualDevices->Destroy();
+	}
+}
+
+void UJoystickSubsystem::RegisterBackend(const TSharedRef<IJoystickBackend>& Backend)
+{
+	if (!Backend->Initialise(*this))
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to initialise the %s joystick backend."), *Backend->GetName().ToString());
+		return;
+	}
 
-	if (SDL_JoystickIsHaptic(Device.Joystick))
+	Backends.Add(Backend);
+
+	// Backends registered after start up enumerate straight away, the rest wait for the input device
+	if (InputDevicePtr.IsValid())
 	{
-		AddHapticDevice(Device);
+		Backend->EnumerateDevices();
 	}
+}
 
-	for (auto& ExistingDevice : Devices)
+void UJoystickSubsystem::UnregisterBackend(const TSharedRef<IJoystickBackend>& Backend)
+{
+	if (Backends.Remove(Backend) == 0)
 	{
-		if (ExistingDevice.Value.Joystick == nullptr && ExistingDevice.Value.DeviceName == Device.DeviceName)
+		return;
+	}
+
+	if (ForceFeedbackLoop.IsValid())
+	{
+		ForceFeedbackLoop->RemoveBackend(Backend.Get());
+	}
+
+	// Commands already queued for the backend have to run before it closes its devices
+	if (HapticThread.IsValid())
+	{
+		HapticThread->RemoveBackend(Backend.Get());
+	}
+
+	Backend->Shutdown();
+}
+
+void UJoystickSubsystem::OnDeviceAttached(IJoystickBackend& Backend, const int DeviceIndex)
+{
+	AddDevice(Backend, DeviceIndex);
+}
+
+void UJoystickSubsystem::OnDeviceDetached(IJoystickBackend& Backend, const int DeviceId)
+{
+	RemoveDevice(DeviceId);
+}
+
+void UJoystickSubsystem::OnInputEvent(const IJoystickBackend& Backend, const FJoystickInputEvent& InputEvent)
+{
+	FJoystickInputDevice* InputDevice = GetInputDevice();
+	if (InputDevice == nullptr)
+	{
+		return;
+	}
+
+	InputDevice->QueueInputEvent(InputEvent);
+
+	if (RecordingInput && !Backend.IsReplay())
+	{
+		FScopeLock Lock(&RecorderLock);
+		if (Recorder.IsValid())
+		{
+			Recorder->RecordInputEvent(InputEvent);
+		}
+	}
+}
+
+bool UJoystickSubsystem::AddDevice(IJoystickBackend& Backend, const int DeviceIndex)
+{
+	const UJoystickInputSettings* JoystickInputSettings = GetMutableDefault<UJoystickInputSettings>();
+	if (!IsValid(JoystickInputSettings))
+	{
+		return false;
+	}
+
+	if (Backend.IsGamepad(DeviceIndex) && JoystickInputSettings->GetIgnoreGameControllers())
+	{
+		// Let UE handle it
+		return false;
+	}
+
+	FDeviceInfoSDL Device;
+	if (!Backend.OpenDevice(DeviceIndex, Device))
+	{
+		return false;
+	}
+
+	Device.Backend = &Backend;
+	Device.DeviceId = -1;
+
+	// A device that comes back keeps its id, so its keys and player mapping survive the reconnect
+	for (const TTuple<int, FDeviceInfoSDL>& ExistingDevice : Devices)
+	{
+		if (ExistingDevice.Value.Backend == nullptr && ExistingDevice.Value.IsReplayed == Device.IsReplayed && ExistingDevice.Value.DeviceName == Device.DeviceName)
 		{
 			Device.DeviceId = ExistingDevice.Key;
-			Devices[Device.DeviceId] = Device;
+			break;
+		}
+	}
 
-			DeviceMapping.Add(Device.InstanceId, Device.DeviceId);
-			JoystickPluggedIn(Device);
-			return true;
+	// Likewise across runs, as long as nothing else took the id first
+	if (Device.DeviceId == -1 && DeviceCache.IsValid() && !Device.IsReplayed)
+	{
+		const FJoystickCachedDevice* CachedDevice = DeviceCache->Find(Device.ProductId, Device.DeviceName);
+		if (CachedDevice != nullptr && CachedDevice->DeviceId != -1 && !Devices.Contains(CachedDevice->DeviceId))
+		{
+			Device.DeviceId = CachedDevice->DeviceId;
+		}
+	}
+
+	if (Device.DeviceId == -1)
+	{
+		Device.DeviceId = Devices.Num();
+		while (Devices.Contains(Device.DeviceId) || (DeviceCache.IsValid() && DeviceCache->IsDeviceIdReserved(Device.DeviceId)))
+		{
+			Device.DeviceId++;
 		}
 	}
 
-	Device.DeviceId = Devices.Num();
 	Devices.Add(Device.DeviceId, Device);
+	Backend.BindDevice(Device);
 
-	DeviceMapping.Add(Device.InstanceId, Device.DeviceId);
 	JoystickPluggedIn(Device);
 	return true;
 }
 
 bool UJoystickSubsystem::RemoveDevice(const int DeviceId)
 {
-	JoystickUnplugged(DeviceId);
-
-	FDeviceInfoSDL* DeviceInfo = GetDeviceInfo(DeviceId);
-	if (DeviceInfo == nullptr)
+	FDeviceInfoSDL* DeviceInfo = Devices.Find(DeviceId);
+	if (DeviceInfo == nullptr || DeviceInfo->Backend == nullptr)
 	{
 		return false;
 	}
 
-	if (DeviceInfo->Haptic != nullptr)
+	// Only once per device, a device already closed has been reported as unplugged
+	JoystickUnplugged(DeviceId);
+
+	if (ForceFeedbackLoop.IsValid())
 	{
-		FJoystickLogManager::Get()->LogDebug(TEXT("Closing Haptic Device for %d"), DeviceId);
-		SDL_HapticClose(DeviceInfo->Haptic);
-		DeviceInfo->Haptic = nullptr;
+		ForceFeedbackLoop->StopStream(DeviceId);
 	}
-	if (DeviceInfo->Joystick != nullptr)
+
+	if (HapticThread.IsValid())
 	{
-		FJoystickLogManager::Get()->LogDebug(TEXT("Closing Joystick Device for %d"), DeviceId);
-		SDL_JoystickClose(DeviceInfo->Joystick);
-		DeviceInfo->Joystick = nullptr;
+		HapticThread->RemoveDevice(*DeviceInfo->Backend, DeviceId);
 	}
 
+	DeviceInfo->Backend->CloseDevice(*DeviceInfo);
+	DeviceInfo->Backend = nullptr;
+
 	FJoystickLogManager::Get()->LogInformation(TEXT("Device Removed %d"), DeviceId);
-	DeviceMapping.Remove(DeviceInfo->InstanceId);
 	return true;
 }
 
-void UJoystickSubsystem::Update() const
+IJoystickBackend* UJoystickSubsystem::GetDeviceBackend(const int DeviceId) const
 {
-	if (OwnsSDL)
+	const FDeviceInfoSDL* DeviceInfo = Devices.Find(DeviceId);
+	if (DeviceInfo == nullptr)
 	{
-		SDL_Event Event;
-		while (SDL_PollEvent(&Event))
-		{
-			// The event watcher handles it
-		}
+		return nullptr;
 	}
+
+	return DeviceInfo->Backend;
 }
 
-int UJoystickSubsystem::HandleSDLEvent(void* UserData, SDL_Event* Event)
+void UJoystickSubsystem::Update()
 {
-	UJoystickSubsystem& JoystickSubsystem = *static_cast<UJoystickSubsystem*>(UserData);
-	FJoystickInputDevice* InputDevice = JoystickSubsystem.GetInputDevice();
-	if (InputDevice == nullptr)
+	JOYSTICK_SCOPE_CYCLE_COUNTER(STAT_JoystickBackendUpdate);
+
+	// Iterate a copy, a backend can register or unregister others through the listener
+	const TArray<TSharedRef<IJoystickBackend>> RegisteredBackends = Backends;
+	for (const TSharedRef<IJoystickBackend>& Backend : RegisteredBackends)
 	{
-		return -1;
+		const bool PolledByInputThread = InputThread.IsValid() && &Backend.Get() == InputBackend.Get();
+		Backend->Update(!PolledByInputThread);
 	}
 
-	switch (Event->type)
+	if (HapticThread.IsValid())
 	{
-		case SDL_JOYDEVICEADDED:
-			JoystickSubsystem.AddDevice(Event->cdevice.which);
-			break;
-		/*case SDL_CONTROLLERDEVICEADDED:
-		{
-			if (Self.bIgnoreGameControllers)
-			{
-				// Since JOYSTICK is inited before GAMECONTROLLER (by GAMECONTROLLER), 
-				// a controller can be added as a joystick before we can check that it is a controller.
-				// Remove it again and let UE handle it.
-				FDeviceIndex DeviceIndex = FDeviceIndex(Event->cdevice.which);
-				for (auto &Device : Self.Devices)
-				{
-					if (Device.Value.DeviceIndex == DeviceIndex && Self.DeviceMapping.Contains(Device.Value.InstanceId))
-					{
-						Self.DeviceMapping.Remove(Device.Value.InstanceId);
-						Self.EventInterface->JoystickUnplugged(Device.Value.DeviceId);
-					}
-				}
-			}
-			break;
-		}*/
-		case SDL_JOYDEVICEREMOVED:
-			{
-				const int InstanceId = Event->cdevice.which;
-				if (JoystickSubsystem.DeviceMapping.Contains(InstanceId))
-				{
-					const int DeviceId = JoystickSubsystem.DeviceMapping[InstanceId];
-					JoystickSubsystem.RemoveDevice(DeviceId);
-				}
-				break;
-			}
-		case SDL_JOYBUTTONDOWN:
-		case SDL_JOYBUTTONUP:
-			if (JoystickSubsystem.DeviceMapping.Contains(Event->jbutton.which))
-			{
-				const int DeviceId = JoystickSubsystem.DeviceMapping[Event->jbutton.which];
-				InputDevice->JoystickButton(DeviceId, Event->jbutton.button, Event->jbutton.state == SDL_PRESSED);
-
-				FJoystickLogManager::Get()->LogDebug(TEXT("Event JoystickButton Device=%d Button=%d State=%d"), DeviceId, Event->jbutton.button, Event->jbutton.state);
-			}
-			break;
-		case SDL_JOYAXISMOTION:
-			if (JoystickSubsystem.DeviceMapping.Contains(Event->jaxis.which))
-			{
-				const int DeviceId = JoystickSubsystem.DeviceMapping[Event->jaxis.which];
-				InputDevice->JoystickAxis(DeviceId, Event->jaxis.axis, Event->jaxis.value / (Event->jaxis.value < 0 ? 32768.0f : 32767.0f));
-			}
-			break;
-		case SDL_JOYHATMOTION:
-			if (JoystickSubsystem.DeviceMapping.Contains(Event->jhat.which))
-			{
-				const int DeviceId = JoystickSubsystem.DeviceMapping[Event->jhat.which];
-				InputDevice->JoystickHat(DeviceId, Event->jhat.hat, UJoystickFunctionLibrary::HatValueToDirection(Event->jhat.value));
-			}
-			break;
-		case SDL_JOYBALLMOTION:
-			if (JoystickSubsystem.DeviceMapping.Contains(Event->jball.which))
-			{
-				const int DeviceId = JoystickSubsystem.DeviceMapping[Event->jball.which];
-				InputDevice->JoystickBall(DeviceId, Event->jball.ball, FVector2D(Event->jball.xrel, Event->jball.yrel));
-			}
-			break;
-		default:
-			break;
+		HapticThread->ProcessResults();
 	}
 
-	return 0;
+	if (ReplayBackend.IsValid() && ReplayBackend->IsFinished())
+	{
+		FJoystickLogManager::Get()->LogInformation(TEXT("Finished replaying %s"), *ReplayBackend->GetPath());
+		StopReplay();
+	}
 }
 
 FJoystickDeviceData UJoystickSubsystem::CreateInitialDeviceState(const int DeviceId)
 {
 	const FDeviceInfoSDL* DeviceInfo = GetDeviceInfo(DeviceId);
-	if (DeviceInfo == nullptr || DeviceInfo->Joystick == nullptr)
+	if (DeviceInfo == nullptr)
 	{
 		return FJoystickDeviceData();
 	}
 
 	FJoystickDeviceData DeviceState = FJoystickDeviceData();
-	const int AxesCount = SDL_JoystickNumAxes(DeviceInfo->Joystick);
-	const int ButtonCount = SDL_JoystickNumButtons(DeviceInfo->Joystick);
-	const int HatsCount = SDL_JoystickNumHats(DeviceInfo->Joystick);
-	const int BallsCount = SDL_JoystickNumBalls(DeviceInfo->Joystick);
-
-	DeviceState.Axes.SetNumZeroed(AxesCount);
-	DeviceState.Buttons.SetNumZeroed(ButtonCount);
-	DeviceState.Hats.SetNumZeroed(HatsCount);
-	DeviceState.Balls.SetNumZeroed(BallsCount);
+	DeviceState.Axes.SetNumZeroed(DeviceInfo->AxisCount);
+	DeviceState.Buttons.SetNumZeroed(DeviceInfo->ButtonCount);
+	DeviceState.Hats.SetNumZeroed(DeviceInfo->HatCount);
+	DeviceState.Balls.SetNumZeroed(DeviceInfo->BallCount);
 	return DeviceState;
 }
 
+FJoystickDeviceCache* UJoystickSubsystem::GetDeviceCache() const
+{
+	return DeviceCache.Get();
+}
+
+FJoystickHapticThread* UJoystickSubsystem::GetHapticThread() const
+{
+	return HapticThread.Get();
+}
+
+FJoystickForceFeedbackLoop* UJoystickSubsystem::GetForceFeedbackLoop(const bool CreateIfNeeded)
+{
+	if (!ForceFeedbackLoop.IsValid() && CreateIfNeeded && IsInitialised)
+	{
+		const UJoystickInputSettings* JoystickInputSettings = GetDefault<UJoystickInputSettings>();
+		const int LoopRate = IsValid(JoystickInputSettings) ? JoystickInputSettings->ForceFeedbackLoopRate : 1000;
+
+		FJoystickLogManager::Get()->LogDebug(TEXT("Starting force feedback loop at %d Hz"), LoopRate);
+		ForceFeedbackLoop = MakeShared<FJoystickForceFeedbackLoop>(LoopRate, HapticThread.Get());
+		if (!ForceFeedbackLoop->IsRunning())
+		{
+			ForceFeedbackLoop.Reset();
+		}
+		else if (HapticThread.IsValid())
+		{
+			HapticThread->SetForceFeedbackLoop(ForceFeedbackLoop.Get());
+		}
+	}
+
+	return ForceFeedbackLoop.Get();
+}
+
 FJoystickInputDevice* UJoystickSubsystem::GetInputDevice() const
 {
 	if (!InputDevicePtr.IsValid())
@@ -456,22 +833,6 @@ bool UJoystickSubsystem::IsReady() const
 	return IsInitialised;
 }
 
-FString UJoystickSubsystem::GetDeviceIndexGuidString(const int DeviceIndex) const
-{
-	char Buffer[32];
-	constexpr int8 SizeBuffer = sizeof(Buffer);
-
-	const SDL_JoystickGUID GUID = SDL_JoystickGetDeviceGUID(DeviceIndex);
-	SDL_JoystickGetGUIDString(GUID, Buffer, SizeBuffer);
-	return ANSI_TO_TCHAR(Buffer);
-}
-
-void UJoystickSubsystem::GetDeviceIndexGuid(const int DeviceIndex, FGuid& Guid) const
-{
-	const SDL_JoystickGUID SDLGuid = SDL_JoystickGetDeviceGUID(DeviceIndex);
-	memcpy(&Guid, &SDLGuid, sizeof(FGuid));
-}
-
 FDeviceInfoSDL* UJoystickSubsystem::GetDeviceInfo(const int DeviceId)
 {
 	const FJoystickInputDevice* InputDevice = GetInputDevice();
@@ -497,6 +858,16 @@ void UJoystickSubsystem::JoystickPluggedIn(const FDeviceInfoSDL& Device) const
 	}
 
 	InputDevice->JoystickPluggedIn(Device);
+
+	if (RecordingInput && !Device.IsReplayed)
+	{
+		FScopeLock Lock(&RecorderLock);
+		if (Recorder.IsValid())
+		{
+			Recorder->RecordDeviceAdded(Device);
+		}
+	}
+
 	if (JoystickPluggedInDelegate.IsBound())
 	{
 		JoystickPluggedInDelegate.Broadcast(Device.DeviceId);
@@ -512,6 +883,17 @@ void UJoystickSubsystem::JoystickUnplugged(const int DeviceId) const
 	}
 
 	InputDevice->JoystickUnplugged(DeviceId);
+
+	const FDeviceInfoSDL* DeviceInfo = Devices.Find(DeviceId);
+	if (RecordingInput && DeviceInfo != nullptr && !DeviceInfo->IsReplayed)
+	{
+		FScopeLock Lock(&RecorderLock);
+		if (Recorder.IsValid())
+		{
+			Recorder->RecordDeviceRemoved(DeviceId);
+		}
+	}
+
 	if (JoystickUnpluggedDelegate.IsBound())
 	{
 		JoystickUnpluggedDelegate.Broadcast(DeviceId);
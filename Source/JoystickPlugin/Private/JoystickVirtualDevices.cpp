@@ -0,0 +1,316 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "JoystickVirtualDevices.h"
+#include "JoystickLogManager.h"
+#include "Misc/FileHelper.h"
+
+THIRD_PARTY_INCLUDES_START
+
+#include "SDL.h"
+#include "SDL_version.h"
+
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	constexpr int HatSequence[] = {SDL_HAT_CENTERED, SDL_HAT_UP, SDL_HAT_RIGHTUP, SDL_HAT_RIGHT, SDL_HAT_RIGHTDOWN, SDL_HAT_DOWN, SDL_HAT_LEFTDOWN, SDL_HAT_LEFT, SDL_HAT_LEFTUP};
+}
+
+FJoystickVirtualDevices::FJoystickVirtualDevices()
+	: StartTime(0.0)
+	  , ScriptDuration(0.0)
+	  , UseScript(false)
+{
+}
+
+FJoystickVirtualDevices::~FJoystickVirtualDevices()
+{
+	Destroy();
+}
+
+bool FJoystickVirtualDevices::Create(const int Count, const int AxisCount, const int ButtonCount, const int HatCount, const FString& ScriptPath)
+{
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+	Destroy();
+
+	for (int i = 0; i < Count; i++)
+	{
+		TUniquePtr<FVirtualDevice> Device = MakeUnique<FVirtualDevice>();
+		Device->Owner = this;
+		Device->Number = i;
+		Device->AxisCount = FMath::Clamp(AxisCount, 0, static_cast<int>(MAX_uint16));
+		Device->ButtonCount = FMath::Clamp(ButtonCount, 0, static_cast<int>(MAX_uint16));
+		Device->HatCount = FMath::Clamp(HatCount, 0, static_cast<int>(MAX_uint16));
+
+		// Unique names keep the reconnect matching in AddDevice from folding the devices together
+		const FTCHARToUTF8 Name(*FString::Printf(TEXT("Joystick Virtual %d"), i));
+		Device->Name.Append(Name.Get(), Name.Length());
+		Device->Name.Add('\0');
+
+		Devices.Add(MoveTemp(Device));
+	}
+
+	UseScript = !ScriptPath.IsEmpty();
+	if (UseScript && !LoadScript(ScriptPath))
+	{
+		Devices.Empty();
+		return false;
+	}
+
+	StartTime = FPlatformTime::Seconds();
+
+	int AttachedCount = 0;
+	for (const TUniquePtr<FVirtualDevice>& Device : Devices)
+	{
+		SDL_VirtualJoystickDesc Desc;
+		SDL_zero(Desc);
+		Desc.version = SDL_VIRTUAL_JOYSTICK_DESC_VERSION;
+		Desc.type = SDL_JOYSTICK_TYPE_UNKNOWN;
+		Desc.naxes = static_cast<Uint16>(Device->AxisCount);
+		Desc.nbuttons = static_cast<Uint16>(Device->ButtonCount);
+		Desc.nhats = static_cast<Uint16>(Device->HatCount);
+		Desc.product_id = static_cast<Uint16>(Device->Number);
+		Desc.name = Device->Name.GetData();
+		Desc.userdata = Device.Get();
+		Desc.Update = &FJoystickVirtualDevices::UpdateVirtualDevice;
+
+		Device->DeviceIndex = SDL_JoystickAttachVirtualEx(&Desc);
+		if (Device->DeviceIndex < 0)
+		{
+			FJoystickLogManager::Get()->LogError(TEXT("Failed to attach virtual joystick %d: %s"), Device->Number, ANSI_TO_TCHAR(SDL_GetError()));
+			continue;
+		}
+
+		Device->InstanceId = SDL_JoystickGetDeviceInstanceID(Device->DeviceIndex);
+		AttachedCount++;
+
+		// Keep our own reference so the device can be driven while the subsystem has it open
+		Device->Joystick = SDL_JoystickOpen(Device->DeviceIndex);
+		if (Device->Joystick == nullptr)
+		{
+			FJoystickLogManager::Get()->LogWarning(TEXT("Failed to open virtual joystick %d, it will not be driven: %s"), Device->Number, ANSI_TO_TCHAR(SDL_GetError()));
+		}
+	}
+
+	FJoystickLogManager::Get()->LogInformation(TEXT("Created %d of %d virtual joysticks (%d axes, %d buttons, %d hats) driven by %s"),
+	                                           AttachedCount, Count, AxisCount, ButtonCount, HatCount, UseScript ? *ScriptPath : TEXT("the generator"));
+	return AttachedCount == Count;
+#else
+	FJoystickLogManager::Get()->LogWarning(TEXT("Virtual joysticks need SDL 2.24 or newer."));
+	return false;
+#endif
+}
+
+void FJoystickVirtualDevices::Destroy()
+{
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+	for (const TUniquePtr<FVirtualDevice>& Device : Devices)
+	{
+		if (Device->Joystick != nullptr)
+		{
+			SDL_JoystickClose(Device->Joystick);
+			Device->Joystick = nullptr;
+		}
+
+		if (Device->InstanceId < 0)
+		{
+			continue;
+		}
+
+		// Device indices shift as devices detach, so look it up from the instance id
+		const int JoystickCount = SDL_NumJoysticks();
+		for (int i = 0; i < JoystickCount; i++)
+		{
+			if (SDL_JoystickGetDeviceInstanceID(i) == Device->InstanceId)
+			{
+				SDL_JoystickDetachVirtual(i);
+				break;
+			}
+		}
+
+		Device->InstanceId = -1;
+	}
+#endif
+
+	Devices.Empty();
+	ScriptDuration = 0.0;
+}
+
+int FJoystickVirtualDevices::GetDeviceCount() const
+{
+	int AttachedCount = 0;
+	for (const TUniquePtr<FVirtualDevice>& Device : Devices)
+	{
+		if (Device->InstanceId >= 0)
+		{
+			AttachedCount++;
+		}
+	}
+
+	return AttachedCount;
+}
+
+void FJoystickVirtualDevices::UpdateVirtualDevice(void* UserData)
+{
+	// Called by SDL_JoystickUpdate on whichever thread polls SDL, with the joysticks locked
+	FVirtualDevice& Device = *static_cast<FVirtualDevice*>(UserData);
+	if (Device.Joystick == nullptr)
+	{
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds() - Device.Owner->StartTime;
+	if (Device.Owner->UseScript)
+	{
+		Device.Owner->PlayScript(Device, Time);
+	}
+	else
+	{
+		Device.Owner->Generate(Device, Time);
+	}
+}
+
+bool FJoystickVirtualDevices::LoadScript(const FString& ScriptPath)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *ScriptPath))
+	{
+		FJoystickLogManager::Get()->LogError(TEXT("Failed to load virtual joystick script %s"), *ScriptPath);
+		return false;
+	}
+
+	for (int LineNumber = 0; LineNumber < Lines.Num(); LineNumber++)
+	{
+		const FString Line = Lines[LineNumber].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")))
+		{
+			continue;
+		}
+
+		TArray<FString> Tokens;
+		Line.ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() != 5)
+		{
+			FJoystickLogManager::Get()->LogWarning(TEXT("%s:%d expected <Seconds> <Device> <Axis|Button|Hat> <Index> <Value>"), *ScriptPath, LineNumber + 1);
+			continue;
+		}
+
+		FScriptEvent Event;
+		Event.Time = FCString::Atod(*Tokens[0]);
+		Event.Index = FCString::Atoi(*Tokens[3]);
+
+		const int DeviceNumber = FCString::Atoi(*Tokens[1]);
+		if (!Devices.IsValidIndex(DeviceNumber))
+		{
+			continue;
+		}
+
+		if (Tokens[2].Equals(TEXT("Axis"), ESearchCase::IgnoreCase))
+		{
+			const float Value = FMath::Clamp(FCString::Atof(*Tokens[4]), -1.f, 1.f);
+			Event.Type = EJoystickInputEventType::Axis;
+			Event.Value = FMath::RoundToInt(Value * (Value < 0.f ? 32768.0f : 32767.0f));
+		}
+		else if (Tokens[2].Equals(TEXT("Button"), ESearchCase::IgnoreCase))
+		{
+			Event.Type = EJoystickInputEventType::Button;
+			Event.Value = FCString::Atoi(*Tokens[4]) != 0 ? SDL_PRESSED : SDL_RELEASED;
+		}
+		else if (Tokens[2].Equals(TEXT("Hat"), ESearchCase::IgnoreCase))
+		{
+			Event.Type = EJoystickInputEventType::Hat;
+			Event.Value = FCString::Atoi(*Tokens[4]);
+		}
+		else
+		{
+			FJoystickLogManager::Get()->LogWarning(TEXT("%s:%d unknown input type %s"), *ScriptPath, LineNumber + 1, *Tokens[2]);
+			continue;
+		}
+
+		Devices[DeviceNumber]->Script.Add(Event);
+		ScriptDuration = FMath::Max(ScriptDuration, Event.Time);
+	}
+
+	for (const TUniquePtr<FVirtualDevice>& Device : Devices)
+	{
+		Device->Script.StableSort([](const FScriptEvent& A, const FScriptEvent& B)
+		{
+			return A.Time < B.Time;
+		});
+	}
+
+	return true;
+}
+
+void FJoystickVirtualDevices::Generate(FVirtualDevice& Device, const double Time) const
+{
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+	// Each input gets its own phase and rate so every sample differs from the last
+	for (int Axis = 0; Axis < Device.AxisCount; Axis++)
+	{
+		const double Frequency = 0.5 + 0.1 * Axis;
+		const double Phase = Device.Number * 0.37 + Axis * 0.73;
+		SDL_JoystickSetVirtualAxis(Device.Joystick, Axis, static_cast<Sint16>(FMath::Sin(2.0 * PI * Frequency * Time + Phase) * 32767.0));
+	}
+
+	const int64 Step = static_cast<int64>(Time * 8.0);
+	for (int Button = 0; Button < Device.ButtonCount; Button++)
+	{
+		SDL_JoystickSetVirtualButton(Device.Joystick, Button, ((Step + Button + Device.Number) & 1) != 0 ? SDL_PRESSED : SDL_RELEASED);
+	}
+
+	for (int Hat = 0; Hat < Device.HatCount; Hat++)
+	{
+		SDL_JoystickSetVirtualHat(Device.Joystick, Hat, static_cast<Uint8>(HatSequence[(Step + Hat) % UE_ARRAY_COUNT(HatSequence)]));
+	}
+#endif
+}
+
+void FJoystickVirtualDevices::PlayScript(FVirtualDevice& Device, const double Time) const
+{
+#if SDL_VERSION_ATLEAST(2, 24, 0)
+	if (Device.Script.Num() == 0)
+	{
+		return;
+	}
+
+	while (true)
+	{
+		if (Device.ScriptCursor == Device.Script.Num())
+		{
+			// Loop once the whole script has played so long runs keep producing input
+			if (ScriptDuration <= 0.0 || Time < Device.ScriptLoopStart + ScriptDuration)
+			{
+				return;
+			}
+
+			Device.ScriptLoopStart += ScriptDuration;
+			Device.ScriptCursor = 0;
+		}
+
+		const FScriptEvent& Event = Device.Script[Device.ScriptCursor];
+		if (Device.ScriptLoopStart + Event.Time > Time)
+		{
+			return;
+		}
+
+		switch (Event.Type)
+		{
+			case EJoystickInputEventType::Axis:
+				SDL_JoystickSetVirtualAxis(Device.Joystick, Event.Index, static_cast<Sint16>(Event.Value));
+				break;
+			case EJoystickInputEventType::Button:
+				SDL_JoystickSetVirtualButton(Device.Joystick, Event.Index, static_cast<Uint8>(Event.Value));
+				break;
+			case EJoystickInputEventType::Hat:
+				SDL_JoystickSetVirtualHat(Device.Joystick, Event.Index, static_cast<Uint8>(Event.Value));
+				break;
+			default:
+				break;
+		}
+
+		Device.ScriptCursor++;
+	}
+#endif
+}
@@ -0,0 +1,79 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/JoystickInputEvent.h"
+
+THIRD_PARTY_INCLUDES_START
+
+#include "SDL_joystick.h"
+
+THIRD_PARTY_INCLUDES_END
+
+/**
+ * Creates SDL virtual joysticks so the whole input path (AddDevice, FJoystickBackendSDL::HandleSDLEvent, SendControllerEvents)
+ * runs without physical hardware, e.g. for automation on a headless build machine or dispatch benchmarks.
+ * The devices are driven from SDL's update callback, so they are sampled at the same rate as real devices:
+ * either from a script file or from a generator that keeps every input moving.
+ *
+ * Script lines are "<Seconds> <Device> <Axis|Button|Hat> <Index> <Value>", axis values in [-1, 1],
+ * button values 0 or 1 and hat values as SDL hat masks. Lines starting with # are ignored and the
+ * script loops once it reaches its last line.
+ */
+class FJoystickVirtualDevices
+{
+public:
+	FJoystickVirtualDevices();
+	~FJoystickVirtualDevices();
+
+	/* Attaches Count devices with the given layout, an empty ScriptPath drives them from the generator. Returns false unless all of them attached */
+	bool Create(const int Count, const int AxisCount, const int ButtonCount, const int HatCount, const FString& ScriptPath);
+	void Destroy();
+
+	/* Number of devices attached to SDL */
+	int GetDeviceCount() const;
+
+private:
+	struct FScriptEvent
+	{
+		double Time;
+		EJoystickInputEventType Type;
+		int Index;
+		int Value;
+	};
+
+	struct FVirtualDevice
+	{
+		FJoystickVirtualDevices* Owner = nullptr;
+		SDL_Joystick* Joystick = nullptr;
+		int DeviceIndex = -1;
+
+		// Set once attached, SDL holds the device as the update callback's userdata until it is detached by this id
+		SDL_JoystickID InstanceId = -1;
+		int Number = 0;
+
+		int AxisCount = 0;
+		int ButtonCount = 0;
+		int HatCount = 0;
+
+		TArray<ANSICHAR> Name;
+
+		TArray<FScriptEvent> Script;
+		int ScriptCursor = 0;
+		double ScriptLoopStart = 0.0;
+	};
+
+	static void UpdateVirtualDevice(void* UserData);
+
+	bool LoadScript(const FString& ScriptPath);
+	void Generate(FVirtualDevice& Device, const double Time) const;
+	void PlayScript(FVirtualDevice& Device, const double Time) const;
+
+	TArray<TUniquePtr<FVirtualDevice>> Devices;
+
+	double StartTime;
+	double ScriptDuration;
+	bool UseScript;
+};
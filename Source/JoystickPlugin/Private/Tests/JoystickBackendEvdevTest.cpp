@@ -0,0 +1,146 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendEvdev.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && PLATFORM_LINUX
+
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+
+#include <unistd.h>
+#include <linux/input.h>
+
+namespace
+{
+	/* Binds every device it is given and keeps the events they send */
+	class FJoystickTestListener final : public IJoystickBackendListener
+	{
+	public:
+		virtual void OnDeviceAttached(IJoystickBackend& Backend, const int DeviceIndex) override
+		{
+			FDeviceInfoSDL Device;
+			if (!Backend.OpenDevice(DeviceIndex, Device))
+			{
+				return;
+			}
+
+			Device.DeviceId = Devices.Num();
+			Device.Backend = &Backend;
+			Backend.BindDevice(Device);
+			Devices.Add(Device);
+		}
+
+		virtual void OnDeviceDetached(IJoystickBackend& Backend, const int DeviceId) override
+		{
+			const int Index = Devices.IndexOfByPredicate([DeviceId](const FDeviceInfoSDL& Device) { return Device.DeviceId == DeviceId; });
+			if (Index != INDEX_NONE)
+			{
+				Backend.CloseDevice(Devices[Index]);
+				Devices.RemoveAt(Index);
+			}
+		}
+
+		virtual void OnInputEvent(const IJoystickBackend& Backend, const FJoystickInputEvent& InputEvent) override
+		{
+			Events.Add(InputEvent);
+		}
+
+		const FJoystickInputEvent* FindLast(const EJoystickInputEventType Type) const
+		{
+			const int Index = Events.FindLastByPredicate([Type](const FJoystickInputEvent& Event) { return Event.Type == Type; });
+			return Index != INDEX_NONE ? &Events[Index] : nullptr;
+		}
+
+		TArray<FDeviceInfoSDL> Devices;
+		TArray<FJoystickInputEvent> Events;
+	};
+
+	input_event MakeEvent(const uint16 Type, const uint16 Code, const int32 Value)
+	{
+		input_event Event = {};
+		Event.type = Type;
+		Event.code = Code;
+		Event.value = Value;
+		return Event;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJoystickBackendEvdevRecordedStreamTest, "JoystickPlugin.Backend.Evdev.RecordedStream",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FJoystickBackendEvdevRecordedStreamTest::RunTest(const FString& Parameters)
+{
+	int Pipe[2];
+	if (!TestEqual(TEXT("Pipe created"), pipe(Pipe), 0))
+	{
+		return false;
+	}
+
+	FJoystickEvdevDeviceDescription Description;
+	Description.Name = TEXT("Recorded Joystick");
+	Description.Axes.Add(FJoystickEvdevAxis(ABS_X, 0, 1023));
+	Description.Buttons.Add(BTN_TRIGGER);
+	Description.HatCount = 1;
+
+	FJoystickTestListener Listener;
+	FJoystickBackendEvdev Backend;
+	Backend.Initialise(Listener);
+
+	const int DeviceId = Backend.AttachDescriptor(Pipe[0], Description);
+	TestEqual(TEXT("Device bound"), DeviceId, 0);
+
+	const input_event Events[] = {
+		MakeEvent(EV_ABS, ABS_X, 1023),
+		MakeEvent(EV_SYN, SYN_REPORT, 0),
+		MakeEvent(EV_KEY, BTN_TRIGGER, 1),
+		MakeEvent(EV_SYN, SYN_REPORT, 0),
+		MakeEvent(EV_ABS, ABS_HAT0X, -1),
+		MakeEvent(EV_ABS, ABS_HAT0Y, -1),
+		MakeEvent(EV_SYN, SYN_REPORT, 0)
+	};
+
+	// Written in pieces smaller than an event, so every read ends part way through one
+	const uint8* Bytes = reinterpret_cast<const uint8*>(Events);
+	constexpr int PieceSize = 7;
+	for (int Offset = 0; Offset < static_cast<int>(sizeof(Events)); Offset += PieceSize)
+	{
+		const int Size = FMath::Min(PieceSize, static_cast<int>(sizeof(Events)) - Offset);
+		TestEqual(TEXT("Piece written"), static_cast<int>(write(Pipe[1], Bytes + Offset, Size)), Size);
+		Backend.PollInput();
+	}
+
+	TestEqual(TEXT("Event count"), Listener.Events.Num(), 4);
+
+	const FJoystickInputEvent* Axis = Listener.FindLast(EJoystickInputEventType::Axis);
+	if (TestNotNull(TEXT("Axis event"), Axis))
+	{
+		TestEqual(TEXT("Axis index"), Axis->Index, 0);
+		TestEqual(TEXT("Axis value"), Axis->Value, 1.f);
+	}
+
+	const FJoystickInputEvent* Button = Listener.FindLast(EJoystickInputEventType::Button);
+	if (TestNotNull(TEXT("Button event"), Button))
+	{
+		TestEqual(TEXT("Button index"), Button->Index, 0);
+		TestTrue(TEXT("Button pressed"), Button->ButtonPressed);
+	}
+
+	const FJoystickInputEvent* Hat = Listener.FindLast(EJoystickInputEventType::Hat);
+	if (TestNotNull(TEXT("Hat event"), Hat))
+	{
+		TestTrue(TEXT("Hat direction"), Hat->HatDirection == EJoystickPOVDirection::Direction_Up_Left);
+	}
+
+	// The end of the stream detaches the device
+	close(Pipe[1]);
+	Backend.PollInput();
+	Backend.Update(false);
+	TestEqual(TEXT("Device detached"), Listener.Devices.Num(), 0);
+
+	Backend.Shutdown();
+	return true;
+}
+
+#endif
@@ -0,0 +1,128 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#include "Backend/JoystickBackendMock.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "SDL_haptic.h"
+THIRD_PARTY_INCLUDES_END
+
+namespace
+{
+	/* Binds every device it is given and keeps the events they send */
+	class FJoystickMockListener final : public IJoystickBackendListener
+	{
+	public:
+		virtual void OnDeviceAttached(IJoystickBackend& Backend, const int DeviceIndex) override
+		{
+			FDeviceInfoSDL Device;
+			if (!Backend.OpenDevice(DeviceIndex, Device))
+			{
+				return;
+			}
+
+			Device.DeviceId = NextDeviceId++;
+			Device.Backend = &Backend;
+			Backend.BindDevice(Device);
+			Devices.Add(Device);
+		}
+
+		virtual void OnDeviceDetached(IJoystickBackend& Backend, const int DeviceId) override
+		{
+			const int Index = Devices.IndexOfByPredicate([DeviceId](const FDeviceInfoSDL& Device) { return Device.DeviceId == DeviceId; });
+			if (Index != INDEX_NONE)
+			{
+				Backend.CloseDevice(Devices[Index]);
+				Devices.RemoveAt(Index);
+			}
+		}
+
+		virtual void OnInputEvent(const IJoystickBackend& Backend, const FJoystickInputEvent& InputEvent) override
+		{
+			Events.Add(InputEvent);
+		}
+
+		TArray<FDeviceInfoSDL> Devices;
+		TArray<FJoystickInputEvent> Events;
+		int NextDeviceId = 0;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FJoystickBackendMockDeviceTest, "JoystickPlugin.Backend.Mock.Device",
+                                 EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FJoystickBackendMockDeviceTest::RunTest(const FString& Parameters)
+{
+	FJoystickMockListener Listener;
+	FJoystickBackendMock Backend;
+	Backend.Initialise(Listener);
+
+	const int DeviceId = Backend.AddDevice(TEXT("Mock Joystick"), 2, 4, 1, 1);
+	TestEqual(TEXT("Device bound"), DeviceId, 0);
+	if (!TestEqual(TEXT("Device opened"), Listener.Devices.Num(), 1))
+	{
+		return false;
+	}
+
+	const FDeviceInfoSDL& Device = Listener.Devices[0];
+	TestEqual(TEXT("Device name"), Device.DeviceName, FString(TEXT("Mock Joystick")));
+	TestEqual(TEXT("Axis count"), Device.AxisCount, 2);
+	TestEqual(TEXT("Button count"), Device.ButtonCount, 4);
+
+	Backend.SetAxis(DeviceId, 1, 2.f);
+	Backend.SetButton(DeviceId, 3, true);
+	Backend.SetHat(DeviceId, 0, EJoystickPOVDirection::Direction_Down);
+	Backend.MoveBall(DeviceId, 0, FVector2D(3.f, -2.f));
+
+	// Inputs for a device that was never bound are dropped
+	Backend.SetAxis(DeviceId + 1, 0, 1.f);
+
+	if (!TestEqual(TEXT("Event count"), Listener.Events.Num(), 4))
+	{
+		return false;
+	}
+
+	const FJoystickInputEvent& Axis = Listener.Events[0];
+	TestTrue(TEXT("Axis type"), Axis.Type == EJoystickInputEventType::Axis);
+	TestEqual(TEXT("Axis device"), Axis.DeviceId, DeviceId);
+	TestEqual(TEXT("Axis index"), Axis.Index, 1);
+	TestEqual(TEXT("Axis value clamped"), Axis.Value, 1.f);
+
+	const FJoystickInputEvent& Button = Listener.Events[1];
+	TestTrue(TEXT("Button type"), Button.Type == EJoystickInputEventType::Button);
+	TestEqual(TEXT("Button index"), Button.Index, 3);
+	TestTrue(TEXT("Button pressed"), Button.ButtonPressed);
+
+	const FJoystickInputEvent& Hat = Listener.Events[2];
+	TestTrue(TEXT("Hat type"), Hat.Type == EJoystickInputEventType::Hat);
+	TestTrue(TEXT("Hat direction"), Hat.HatDirection == EJoystickPOVDirection::Direction_Down);
+
+	const FJoystickInputEvent& Ball = Listener.Events[3];
+	TestTrue(TEXT("Ball type"), Ball.Type == EJoystickInputEventType::Ball);
+	TestTrue(TEXT("Ball delta"), Ball.BallDelta == FVector2D(3.f, -2.f));
+
+	SDL_HapticEffect Effect;
+	FMemory::Memzero(Effect);
+	Effect.type = SDL_HAPTIC_CONSTANT;
+	TestNotEqual(TEXT("Effect created"), Backend.CreateEffect(DeviceId, Effect), -1);
+	TestEqual(TEXT("Haptic calls counted"), Backend.GetHapticCallCount(), 1);
+
+	// Removing the device goes through the listener, which closes it
+	Backend.RemoveDevice(DeviceId);
+	TestEqual(TEXT("Device detached"), Listener.Devices.Num(), 0);
+
+	Backend.SetButton(DeviceId, 0, true);
+	TestEqual(TEXT("No events after removal"), Listener.Events.Num(), 4);
+	TestEqual(TEXT("No effects after removal"), Backend.CreateEffect(DeviceId, Effect), -1);
+
+	Backend.Shutdown();
+	return true;
+}
+
+#endif
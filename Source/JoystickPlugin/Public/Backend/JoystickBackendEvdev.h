@@ -0,0 +1,186 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_LINUX
+
+#include "Containers/Queue.h"
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "HAL/CriticalSection.h"
+#include "Interfaces/JoystickBackend.h"
+
+struct FJoystickEvdevAxis
+{
+	FJoystickEvdevAxis()
+		: Code(0)
+		  , Minimum(-32768)
+		  , Maximum(32767)
+	{
+	}
+
+	FJoystickEvdevAxis(const uint16 InCode, const int32 InMinimum, const int32 InMaximum)
+		: Code(InCode)
+		  , Minimum(InMinimum)
+		  , Maximum(InMaximum)
+	{
+	}
+
+	/* ABS_* code */
+	uint16 Code;
+	int32 Minimum;
+	int32 Maximum;
+};
+
+/**
+ * What a device reports, normally probed with ioctls. Descriptors handed to AttachDescriptor (pipes, files)
+ * cannot be probed, so their description is given up front.
+ */
+struct FJoystickEvdevDeviceDescription
+{
+	FJoystickEvdevDeviceDescription()
+		: BusType(0)
+		  , Vendor(0)
+		  , Product(0)
+		  , Version(0)
+		  , HatCount(0)
+		  , BallCount(0)
+		  , IsGamepad(false)
+	{
+	}
+
+	FString Name;
+
+	uint16 BusType;
+	uint16 Vendor;
+	uint16 Product;
+	uint16 Version;
+
+	/* In the order they are reported as axes, hats excluded */
+	TArray<FJoystickEvdevAxis> Axes;
+
+	/* KEY_* and BTN_* codes in the order they are reported as buttons */
+	TArray<uint16> Buttons;
+
+	/* ABS_HAT0X/Y to ABS_HAT3X/Y pairs */
+	int HatCount;
+
+	/* REL_* pairs, ball N is made of codes 2N and 2N + 1 */
+	int BallCount;
+
+	bool IsGamepad;
+};
+
+/**
+ * Reads /dev/input/event* directly on Linux, skipping SDL's joystick thread, its event queue and the event watch.
+ * All devices share one epoll set and are drained with non-blocking reads into a preallocated batch buffer.
+ * Devices get the same GUID SDL would give them, so keys and device configurations carry over from the SDL backend.
+ * Haptics are not supported on devices read this way.
+ */
+class JOYSTICKPLUGIN_API FJoystickBackendEvdev final : public IJoystickBackend
+{
+public:
+	FJoystickBackendEvdev();
+	virtual ~FJoystickBackendEvdev() override;
+
+	/**
+	 * Attaches an already open descriptor producing input_event records, e.g. a pipe or a file holding a
+	 * recorded evdev stream. Takes ownership of the descriptor. Returns the device id it was given, or -1.
+	 * The device is detached once the stream ends.
+	 */
+	int AttachDescriptor(const int Fd, const FJoystickEvdevDeviceDescription& Description);
+
+	/* Builds the GUID SDL's Linux joystick driver gives a device with this description */
+	static FGuid CreateGuid(const FJoystickEvdevDeviceDescription& Description);
+
+	// Begin IJoystickBackend
+	virtual FName GetName() const override;
+	virtual bool Initialise(IJoystickBackendListener& InListener) override;
+	virtual void Shutdown() override;
+	virtual void EnumerateDevices() override;
+	virtual int GetDeviceCount() const override;
+	virtual bool IsGamepad(const int DeviceIndex) const override;
+	virtual bool OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device) override;
+	virtual void BindDevice(const FDeviceInfoSDL& Device) override;
+	virtual void CloseDevice(const FDeviceInfoSDL& Device) override;
+	virtual void Update(const bool PollInput) override;
+	virtual void PollInput() override;
+	virtual bool WaitForInput(const double Timeout) override;
+	// End IJoystickBackend
+
+private:
+	struct FEvdevDevice
+	{
+		int Fd = -1;
+		FString Path;
+		FJoystickEvdevDeviceDescription Description;
+		FGuid Guid;
+
+		int InstanceId = -1;
+		int DeviceId = -1;
+
+		// Descriptors that epoll refuses (regular files) are read on every poll instead
+		bool IsPolled = false;
+		bool IsProbed = false;
+		bool IsEndOfStream = false;
+
+		// Set by SYN_DROPPED, events are ignored until the next SYN_REPORT
+		bool IsDropping = false;
+
+		// Native code to reported index, -1 when unused
+		TArray<int16> AxisIndices;
+		TArray<int16> ButtonIndices;
+
+		// Last ABS_HATnX/Y values, the hat is reported as a whole whenever either changes
+		TArray<int8> HatValues;
+
+		// The start of an input_event cut off by the last read, pipes may return any number of bytes
+		TArray<uint8> PartialEvent;
+	};
+
+	bool ProbeDevice(const FString& Path, FEvdevDevice& Device) const;
+	int AddDevice(FEvdevDevice&& Device);
+	void DetachDevice(const int InstanceId);
+	void CloseDescriptor(FEvdevDevice& Device) const;
+
+	void ReadDevice(FEvdevDevice& Device);
+	void ProcessEvent(FEvdevDevice& Device, const uint16 Type, const uint16 Code, const int32 Value);
+	void Resynchronise(FEvdevDevice& Device);
+	void SendAxis(const FEvdevDevice& Device, const int Axis, const int32 Value) const;
+	void SendButton(const FEvdevDevice& Device, const int Button, const bool Pressed) const;
+	void SendHat(const FEvdevDevice& Device, const int Hat) const;
+
+	FEvdevDevice* FindDeviceByFd(const int Fd);
+	int FindDeviceIndexByInstanceId(const int InstanceId) const;
+	bool IsOpen(const FString& Path) const;
+
+	void ProcessHotplug();
+	void ProcessDeviceEvents();
+
+	IJoystickBackendListener* Listener;
+
+	// Every opened device, bound or not, indexed by device index. Guarded by DevicesLock since the input thread reads them.
+	TArray<FEvdevDevice> Devices;
+	mutable FCriticalSection DevicesLock;
+
+	int EpollFd;
+	int InotifyFd;
+	int NextInstanceId;
+
+	// input_event batch, allocated once
+	TArray<uint8> ReadBuffer;
+
+	// Kernel time of the event being processed moved onto the FPlatformTime clock, 0 unless latency tracking is enabled
+	double EventSourceTimestamp;
+
+	// End of stream seen on the input thread, handled on the game thread
+	TQueue<FJoystickDeviceEvent, EQueueMode::Mpsc> PendingDeviceEvents;
+
+	// Device id given to the last device bound, used by AttachDescriptor
+	int LastBoundDeviceId;
+};
+
+#endif
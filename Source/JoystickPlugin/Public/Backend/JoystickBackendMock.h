@@ -0,0 +1,70 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickPOVDirection.h"
+#include "HAL/CriticalSection.h"
+#include "Interfaces/JoystickBackend.h"
+
+/**
+ * In-memory test double. Devices are attached and driven directly from code, which makes it possible to profile
+ * the dispatch path or exercise bindings without SDL. Register it with UJoystickSubsystem::RegisterBackend.
+ * Devices must be added and removed on the game thread; inputs may be set from any single thread per device.
+ */
+class JOYSTICKPLUGIN_API FJoystickBackendMock final : public IJoystickBackend
+{
+public:
+	FJoystickBackendMock();
+
+	/* Attaches a device immediately and returns the device id the subsystem gave it, or -1 */
+	int AddDevice(const FString& DeviceName, const int AxisCount, const int ButtonCount, const int HatCount, const int BallCount);
+	void RemoveDevice(const int DeviceId);
+
+	void SetAxis(const int DeviceId, const int Axis, const float Value) const;
+	void SetButton(const int DeviceId, const int Button, const bool Pressed) const;
+	void SetHat(const int DeviceId, const int Hat, const EJoystickPOVDirection Direction) const;
+	void MoveBall(const int DeviceId, const int Ball, const FVector2D& Delta) const;
+
+	/* Haptic calls are accepted and counted so tests can check what was sent */
+	int GetHapticCallCount() const;
+
+	// Begin IJoystickBackend
+	virtual FName GetName() const override;
+	virtual bool Initialise(IJoystickBackendListener& InListener) override;
+	virtual void Shutdown() override;
+	virtual void EnumerateDevices() override;
+	virtual int GetDeviceCount() const override;
+	virtual bool IsGamepad(const int DeviceIndex) const override;
+	virtual bool OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device) override;
+	virtual void BindDevice(const FDeviceInfoSDL& Device) override;
+	virtual void CloseDevice(const FDeviceInfoSDL& Device) override;
+	virtual void Update(const bool PollInput) override;
+
+	virtual bool SetAutoCenter(const int DeviceId, const int Center) override;
+	virtual bool SetGain(const int DeviceId, const int Gain) override;
+	virtual int CreateEffect(const int DeviceId, SDL_HapticEffect& Effect) override;
+	virtual bool UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect) override;
+	virtual bool RunEffect(const int DeviceId, const int EffectId, const int Iterations) override;
+	virtual bool StopEffect(const int DeviceId, const int EffectId) override;
+	virtual void PlayRumble(const int DeviceId, const float LowFrequency, const float HighFrequency, const float Duration) override;
+	// End IJoystickBackend
+
+private:
+	void SendInputEvent(FJoystickInputEvent& InputEvent) const;
+
+	IJoystickBackendListener* Listener;
+
+	// The device being attached, valid only inside AddDevice
+	TArray<FDeviceInfoSDL> AttachingDevices;
+	TSet<int> DeviceIds;
+	int LastBoundDeviceId;
+
+	int NextInstanceId;
+
+	// Haptic calls can come from the haptic thread and inputs from any thread, they and DeviceIds changes hold this
+	mutable FCriticalSection HapticLock;
+	int NextEffectId;
+	int HapticCallCount;
+};
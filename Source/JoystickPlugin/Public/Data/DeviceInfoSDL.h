@@ -3,12 +3,7 @@
 
 #pragma once
 
-THIRD_PARTY_INCLUDES_START
-
-#include "SDL_haptic.h"
-#include "SDL_joystick.h"
-
-THIRD_PARTY_INCLUDES_END
+class IJoystickBackend;
 
 struct FDeviceInfoSDL
 {
@@ -19,8 +14,12 @@ struct FDeviceInfoSDL
 		  , IsGamepad(false)
 		  , HasRumble(false)
 		  , DeviceName("Unknown Device")
-		  , Haptic(nullptr)
-		  , Joystick(nullptr)
+		  , AxisCount(0)
+		  , ButtonCount(0)
+		  , HatCount(0)
+		  , BallCount(0)
+		  , IsReplayed(false)
+		  , Backend(nullptr)
 	{
 	}
 
@@ -35,6 +34,14 @@ struct FDeviceInfoSDL
 	FString DeviceName;
 	FGuid ProductId;
 
-	SDL_Haptic* Haptic;
-	SDL_Joystick* Joystick;
+	int AxisCount;
+	int ButtonCount;
+	int HatCount;
+	int BallCount;
+
+	/* Device fed from a recording rather than an SDL joystick */
+	bool IsReplayed;
+
+	/* The backend the device is open on, null once it has been closed */
+	IJoystickBackend* Backend;
 };
@@ -13,6 +13,8 @@ struct JOYSTICKPLUGIN_API FAxisData
 	FAxisData()
 		: Value(0.f)
 		  , PreviousValue(0.f)
+		  , MappedValue(0.f)
+		  , PreviousMappedValue(0.f)
 		  , RemappingEnabled(false)
 		  , InputOffset(0.f)
 		  , InvertInput(false)
@@ -22,6 +24,9 @@ struct JOYSTICKPLUGIN_API FAxisData
 		  , OutputRangeMax(1.f)
 		  , InvertOutput(false)
 		  , bGamepadStick(false)
+		  , DispatchThreshold(0.f)
+		  , PredictedValue(0.f)
+		  , PredictionError(0.f)
 	{
 	}
 
@@ -30,6 +35,8 @@ struct JOYSTICKPLUGIN_API FAxisData
 	          const float InOffset, const bool bInInvertInput, const bool bInInvertOutput, const bool bInGamepadStick)
 		: Value(InValue)
 		  , PreviousValue(0.f)
+		  , MappedValue(InValue)
+		  , PreviousMappedValue(0.f)
 		  , RemappingEnabled(false)
 		  , InputOffset(InOffset)
 		  , InvertInput(bInInvertInput)
@@ -39,29 +46,21 @@ struct JOYSTICKPLUGIN_API FAxisData
 		  , OutputRangeMax(InOutputRangeMax)
 		  , InvertOutput(bInInvertOutput)
 		  , bGamepadStick(bInGamepadStick)
+		  , DispatchThreshold(0.f)
+		  , PredictedValue(0.f)
+		  , PredictionError(0.f)
 	{
 	}
 
+	/* The value as dispatched without prediction, remapped and shaped by the deadzones and response curve */
 	float GetValue() const
 	{
-		if (RemappingEnabled)
-		{
-			return MapValue(Value);
-		}
-		return Value;
+		return MappedValue;
 	}
 
 	float GetPreviousValue() const
 	{
-		return MapValue(PreviousValue);
-	}
-
-	float MapValue(const float Input) const
-	{
-		const float NormalizedValue = (InvertInput ? (Input * -1.0f) : Input);
-		const float OffsetNormalizedValue = NormalizedValue + InputOffset;
-		const float MappedValue = FMath::GetMappedRangeValueClamped(FVector2D(InputRangeMin, InputRangeMax), FVector2D(OutputRangeMin, OutputRangeMax), OffsetNormalizedValue);
-		return InvertOutput ? (MappedValue * -1.0f) : MappedValue;
+		return PreviousMappedValue;
 	}
 
 	/* Whether the data represents a valid value */
@@ -78,6 +77,14 @@ struct JOYSTICKPLUGIN_API FAxisData
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
 	float PreviousValue;
 
+	/* Current value after remapping, deadzones and response curve, filled in by the device store */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float MappedValue;
+
+	/* Last value after remapping, deadzones and response curve */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float PreviousMappedValue;
+
 	/* Should remap ranges */
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
 	bool RemappingEnabled;
@@ -112,4 +119,16 @@ struct JOYSTICKPLUGIN_API FAxisData
 	/* Is this axis centered on 0 instead of 0.5 */
 	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
 	bool bGamepadStick;
+
+	/* Minimum change before the value is dispatched again */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float DispatchThreshold;
+
+	/* Remapped value extrapolated by the axis predictor, the remapped current value when prediction is off */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float PredictedValue;
+
+	/* Average distance between past predictions and the value the axis actually reached */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float PredictionError;
 };
@@ -0,0 +1,42 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "AxisFrameData.generated.h"
+
+/* Summary of every sample an axis reported since the last dispatch */
+USTRUCT(BlueprintType)
+struct JOYSTICKPLUGIN_API FAxisFrameData
+{
+	GENERATED_BODY()
+
+	FAxisFrameData()
+		: Min(0.f)
+		  , Max(0.f)
+		  , Mean(0.f)
+		  , Last(0.f)
+		  , SampleCount(0)
+	{
+	}
+
+	/* Lowest value reported this frame */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float Min;
+
+	/* Highest value reported this frame */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float Max;
+
+	/* Average of the values reported this frame */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float Mean;
+
+	/* Most recent value */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	float Last;
+
+	/* Number of samples received this frame, the other values hold the previous value when zero */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Data")
+	int SampleCount;
+};
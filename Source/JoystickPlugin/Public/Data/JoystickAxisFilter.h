@@ -0,0 +1,44 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/Settings/JoystickAxisFilterSettings.h"
+
+/* One stage of an axis filter chain and its state, applied to every raw sample as it arrives */
+struct JOYSTICKPLUGIN_API FJoystickAxisFilter
+{
+	static constexpr int MaxMedianTaps = 5;
+
+	FJoystickAxisFilter()
+	{
+		Reset();
+	}
+
+	explicit FJoystickAxisFilter(const FJoystickAxisFilterSettings& InSettings)
+		: Settings(InSettings)
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	/* Timestamp is in seconds, only the difference between samples is used */
+	float Apply(const float Sample, const double Timestamp);
+
+	FJoystickAxisFilterSettings Settings;
+
+	float Value;
+	float Derivative;
+	double LastTimestamp;
+	bool HasValue;
+
+	float History[MaxMedianTaps];
+	int HistoryCount;
+	int HistoryIndex;
+
+private:
+	float ApplyLowPass(const float Sample, const float DeltaTime);
+	float ApplyOneEuro(const float Sample, const float DeltaTime);
+	float ApplyMedian(const float Sample);
+};
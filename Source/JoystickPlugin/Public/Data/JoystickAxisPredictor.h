@@ -0,0 +1,43 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/Settings/JoystickAxisPredictionMode.h"
+
+/* Extrapolates an axis from its latest timestamped samples and tracks how far off the predictions were */
+struct JOYSTICKPLUGIN_API FJoystickAxisPredictor
+{
+	static constexpr int SampleCount = 3;
+
+	/* Samples older than this are treated as the axis having come to rest */
+	static constexpr double MaxSampleAge = 0.1;
+
+	FJoystickAxisPredictor()
+	{
+		Reset();
+	}
+
+	void Reset();
+
+	/* Value is the remapped sample, Timestamp in seconds on the FPlatformTime clock */
+	void AddSample(const float Value, const double Timestamp);
+
+	/* Predicts the value Horizon seconds after Now, at most Clamp away from CurrentValue when Clamp is above zero */
+	float Predict(const EJoystickAxisPredictionMode Mode, const float CurrentValue, const double Now, const float Horizon, const float Clamp);
+
+	/* Compares the oldest outstanding prediction with CurrentValue once its target time has passed */
+	void ResolveError(const float CurrentValue, const double Now);
+
+	/* Newest last */
+	double SampleTimes[SampleCount];
+	float SampleValues[SampleCount];
+	int NumSamples;
+
+	float PendingValue;
+	double PendingTime;
+	bool HasPending;
+
+	/* Exponential moving average of the absolute prediction error */
+	float MeanError;
+};
@@ -0,0 +1,259 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/JoystickAxisFilter.h"
+#include "Data/JoystickAxisPredictor.h"
+#include "Data/JoystickDeviceData.h"
+#include "Data/JoystickDispatchState.h"
+#include "Data/JoystickFrameLog.h"
+#include "Data/JoystickPOVDirection.h"
+#include "Data/Settings/JoystickAxisResponseCurve.h"
+
+/* Remapping configuration of an axis, folded into scale/bias form by JoystickAxisKernel::BuildRemap */
+struct FJoystickAxisConfig
+{
+	FJoystickAxisConfig()
+		: RemappingEnabled(false)
+		  , InputOffset(0.f)
+		  , InvertInput(false)
+		  , InputRangeMin(0.f)
+		  , InputRangeMax(1.f)
+		  , OutputRangeMin(0.f)
+		  , OutputRangeMax(1.f)
+		  , InvertOutput(false)
+		  , bGamepadStick(false)
+		  , DispatchThreshold(0.f)
+		  , Centered(true)
+		  , InnerDeadzone(0.f)
+		  , OuterDeadzone(0.f)
+		  , ResponseCurve(EJoystickAxisResponseCurve::Linear)
+		  , CurveExponent(2.f)
+		  , PairedAxisIndex(-1)
+		  , RadialDeadzone(false)
+		  , PredictionMode(EJoystickAxisPredictionMode::None)
+		  , PredictionHorizon(0.f)
+		  , PredictionClamp(0.f)
+	{
+	}
+
+	bool HasResponse() const
+	{
+		return InnerDeadzone > 0.f || OuterDeadzone > 0.f || ResponseCurve != EJoystickAxisResponseCurve::Linear || HasRadialDeadzone();
+	}
+
+	bool HasRadialDeadzone() const
+	{
+		return RadialDeadzone && PairedAxisIndex >= 0;
+	}
+
+	bool RemappingEnabled;
+	float InputOffset;
+	bool InvertInput;
+	float InputRangeMin;
+	float InputRangeMax;
+	float OutputRangeMin;
+	float OutputRangeMax;
+	bool InvertOutput;
+	bool bGamepadStick;
+	float DispatchThreshold;
+
+	bool Centered;
+	float InnerDeadzone;
+	float OuterDeadzone;
+	EJoystickAxisResponseCurve ResponseCurve;
+	float CurveExponent;
+
+	/* Custom curve as sorted points, a curve asset is sampled into these when the settings are applied */
+	TArray<FVector2D> CurvePoints;
+
+	/* Device local index of the Y axis when this is the X axis of a stick */
+	int PairedAxisIndex;
+	bool RadialDeadzone;
+
+	TArray<FJoystickAxisFilterSettings> Filters;
+
+	EJoystickAxisPredictionMode PredictionMode;
+	float PredictionHorizon;
+	float PredictionClamp;
+};
+
+/* Where a device's inputs live in the store arrays */
+struct FJoystickDeviceSlot
+{
+	FJoystickDeviceSlot()
+		: DeviceId(-1)
+		  , Player(0)
+		  , Connected(false)
+		  , AxisOffset(0)
+		  , AxisCount(0)
+		  , ButtonOffset(0)
+		  , ButtonCount(0)
+		  , ButtonWordOffset(0)
+		  , ReplayButtonEdges(false)
+		  , HatOffset(0)
+		  , HatCount(0)
+		  , BallOffset(0)
+		  , BallCount(0)
+	{
+	}
+
+	int DeviceId;
+	int Player;
+	bool Connected;
+
+	int AxisOffset;
+	int AxisCount;
+	int ButtonOffset;
+	int ButtonCount;
+
+	/* First 64 bit word of the button masks, a device's buttons always start on a word boundary */
+	int ButtonWordOffset;
+
+	/* Set when a button toggled more than once this frame, the edge log is replayed instead of diffing the masks */
+	bool ReplayButtonEdges;
+
+	int HatOffset;
+	int HatCount;
+	int BallOffset;
+	int BallCount;
+};
+
+/**
+ * Dense state of every device, indexed by a compact slot instead of the device id.
+ * Each kind of input is stored contiguously across all devices so the per-frame loops stay in a few cache lines,
+ * configuration and key names are kept in separate arrays. Hat and ball channel arrays hold X then Y for each entry.
+ */
+struct FJoystickDeviceStore
+{
+	/* Adds the device or resets it if it is already known, returns its slot */
+	int AddDevice(const int DeviceId, const int AxisCount, const int ButtonCount, const int HatCount, const int BallCount);
+	void RemoveDevice(const int DeviceId);
+
+	int FindSlot(const int DeviceId) const
+	{
+		return DeviceSlots.IsValidIndex(DeviceId) ? DeviceSlots[DeviceId] : INDEX_NONE;
+	}
+
+	FJoystickDeviceSlot* FindDevice(const int DeviceId)
+	{
+		const int Slot = FindSlot(DeviceId);
+		return Slot != INDEX_NONE ? &Slots[Slot] : nullptr;
+	}
+
+	const FJoystickDeviceSlot* FindDevice(const int DeviceId) const
+	{
+		const int Slot = FindSlot(DeviceId);
+		return Slot != INDEX_NONE ? &Slots[Slot] : nullptr;
+	}
+
+	static int GetButtonWordCount(const int ButtonCount)
+	{
+		return (ButtonCount + 63) / 64;
+	}
+
+	static uint64 GetButtonBit(const int Button)
+	{
+		return 1ULL << (Button & 63);
+	}
+
+	bool IsButtonPressed(const FJoystickDeviceSlot& Slot, const int Button) const
+	{
+		return (ButtonWords[Slot.ButtonWordOffset + (Button >> 6)] & GetButtonBit(Button)) != 0;
+	}
+
+	bool WasButtonPressed(const FJoystickDeviceSlot& Slot, const int Button) const
+	{
+		return (PreviousButtonWords[Slot.ButtonWordOffset + (Button >> 6)] & GetButtonBit(Button)) != 0;
+	}
+
+	/* Folds every axis configuration into the scale/bias parameters, response tables and filter chains, then remaps the current values */
+	void BuildAxisRemap();
+
+	/* Runs a raw sample through the axis' filter chain */
+	float FilterAxisValue(const int Index, const float Value, const double Timestamp);
+
+	/* Remaps every axis of every device into MappedAxisValues */
+	void RemapAxes();
+
+	/* Extrapolates the remapped values of the predicted axes into PredictedAxisValues, the other entries are left untouched */
+	void PredictAxes();
+
+	/* The value dispatched for an axis, its prediction when it has one */
+	float GetOutputAxisValue(const int Index) const
+	{
+		return AxisConfigs[Index].PredictionMode != EJoystickAxisPredictionMode::None ? PredictedAxisValues[Index] : MappedAxisValues[Index];
+	}
+
+	/* Remaps a single sample the same way RemapAxes does, used for the sub-frame samples */
+	float RemapAxisValue(const int Index, const float Value) const;
+
+	/* Builds the Blueprint facing copy of a device's state */
+	void BuildDeviceData(const FJoystickDeviceSlot& Slot, FJoystickDeviceData& DeviceData) const;
+
+	TArray<FJoystickDeviceSlot> Slots;
+
+	// Current and last dispatched values
+	TArray<float> AxisValues;
+	TArray<float> PreviousAxisValues;
+	TArray<float> MappedAxisValues;
+	TArray<float> PredictedAxisValues;
+	TArray<uint64> ButtonWords;
+	TArray<uint64> PreviousButtonWords;
+	TArray<EJoystickPOVDirection> HatDirections;
+	TArray<EJoystickPOVDirection> PreviousHatDirections;
+	TArray<FVector2D> BallDeltas;
+	TArray<FVector2D> PreviousBallDeltas;
+
+	// Per frame bookkeeping
+	TArray<FJoystickAxisFrameSamples> AxisSamples;
+	TArray<FJoystickAnalogDispatchState> AxisDispatch;
+	TArray<FJoystickAnalogDispatchState> HatDispatch;
+	TArray<FJoystickAnalogDispatchState> BallDispatch;
+
+	/* Button edges in the order they were reported, one list per slot */
+	TArray<TArray<FJoystickButtonEdge>> ButtonEdges;
+
+	// Axis remapping in scale/bias form, see JoystickAxisKernel
+	TArray<float> AxisInputScales;
+	TArray<float> AxisInputBiases;
+	TArray<float> AxisOutputScales;
+	TArray<float> AxisOutputBiases;
+
+	// Deadzones and response curves, baked by BuildAxisRemap
+	/* JoystickAxisKernel::ResponseTableSize entries for each axis with a response */
+	TArray<float> AxisResponseTables;
+
+	/* Offset into AxisResponseTables per axis, INDEX_NONE for a linear response */
+	TArray<int> AxisResponseTableOffsets;
+
+	/* The other axis of a radial pair per axis, INDEX_NONE when the axis is shaped on its own */
+	TArray<int> AxisRadialPartners;
+
+	/* Axes shaped on their own, and radial pairs as X then Y, rebuilt with the tables */
+	TArray<int> ResponseAxes;
+	TArray<FIntPoint> RadialAxisPairs;
+
+	// Filter chains, preallocated by BuildAxisRemap
+	TArray<FJoystickAxisFilter> AxisFilters;
+
+	/* Range of AxisFilters per axis, X is the offset and Y the count. Rebuilt with the chains, which keep the state of unchanged stages */
+	TArray<FIntPoint> AxisFilterRanges;
+
+	// Prediction, fed with every remapped sample
+	TArray<FJoystickAxisPredictor> AxisPredictors;
+	TArray<int> PredictedAxes;
+
+	// Configuration
+	TArray<FJoystickAxisConfig> AxisConfigs;
+	TArray<FName> AxisKeys;
+	TArray<FName> ButtonKeys;
+	TArray<FName> HatKeys;
+	TArray<FName> BallKeys;
+	TArray<FString> DeviceNames;
+
+private:
+	/* Device id to slot, device ids are allocated sequentially so this stays small */
+	TArray<int> DeviceSlots;
+};
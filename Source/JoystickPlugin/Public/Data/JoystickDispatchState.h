@@ -0,0 +1,37 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+/* Tracks what was last sent to the message handler for one analog channel */
+struct FJoystickAnalogDispatchState
+{
+	FJoystickAnalogDispatchState()
+		: LastDispatchedValue(0.f)
+		  , LastValue(0.f)
+		  , HasDispatched(false)
+	{
+	}
+
+	/* Returns true if Value should be dispatched, either because it moved further than Epsilon
+	 * or because it came to rest at a value that differs from the one last sent */
+	bool ShouldDispatch(const float Value, const float Epsilon)
+	{
+		const bool Moved = !HasDispatched || FMath::Abs(Value - LastDispatchedValue) > Epsilon;
+		const bool Settled = Value != LastDispatchedValue && Value == LastValue;
+		LastValue = Value;
+
+		if (!Moved && !Settled)
+		{
+			return false;
+		}
+
+		LastDispatchedValue = Value;
+		HasDispatched = true;
+		return true;
+	}
+
+	float LastDispatchedValue;
+	float LastValue;
+	bool HasDispatched;
+};
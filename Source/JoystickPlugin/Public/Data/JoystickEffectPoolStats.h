@@ -0,0 +1,52 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickEffectPoolStats.generated.h"
+
+/* How a device's hardware effect slots have been used by the haptic thread's slot pool */
+USTRUCT(BlueprintType)
+struct JOYSTICKPLUGIN_API FJoystickEffectPoolStats
+{
+	GENERATED_BODY()
+
+	FJoystickEffectPoolStats()
+		: Capacity(-1)
+		  , ActiveSlots(0)
+		  , FreeSlots(0)
+		  , Created(0)
+		  , Reused(0)
+		  , Evicted(0)
+		  , Failed(0)
+	{
+	}
+
+	/* Effects the device can hold at once, -1 when it does not say */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int Capacity;
+
+	/* Slots held by a live effect */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int ActiveSlots;
+
+	/* Stopped slots kept on the device for the next effect of the same type */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int FreeSlots;
+
+	/* Effects that needed a new slot on the device */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int64 Created;
+
+	/* Effects uploaded into a free slot instead of a new one */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int64 Reused;
+
+	/* Effects that lost their slot to one with a higher priority */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int64 Evicted;
+
+	/* Effects that found no slot */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Force Feedback")
+	int64 Failed;
+};
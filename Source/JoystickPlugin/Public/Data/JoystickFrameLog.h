@@ -0,0 +1,71 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/Input/AxisFrameData.h"
+
+struct FJoystickButtonEdge
+{
+	FJoystickButtonEdge()
+		: Button(0)
+		  , Pressed(false)
+	{
+	}
+
+	FJoystickButtonEdge(const int InButton, const bool InPressed)
+		: Button(InButton)
+		  , Pressed(InPressed)
+	{
+	}
+
+	int Button;
+	bool Pressed;
+};
+
+struct FJoystickAxisFrameSamples
+{
+	FJoystickAxisFrameSamples()
+		: Min(0.f)
+		  , Max(0.f)
+		  , Sum(0.f)
+		  , Last(0.f)
+		  , Count(0)
+	{
+	}
+
+	void Reset(const float HeldValue)
+	{
+		Min = HeldValue;
+		Max = HeldValue;
+		Sum = 0.f;
+		Last = HeldValue;
+		Count = 0;
+	}
+
+	void Add(const float Sample)
+	{
+		Min = Count == 0 ? Sample : FMath::Min(Min, Sample);
+		Max = Count == 0 ? Sample : FMath::Max(Max, Sample);
+		Sum += Sample;
+		Last = Sample;
+		Count++;
+	}
+
+	FAxisFrameData ToFrameData() const
+	{
+		FAxisFrameData FrameData;
+		FrameData.Min = Min;
+		FrameData.Max = Max;
+		FrameData.Mean = Count > 0 ? Sum / Count : Last;
+		FrameData.Last = Last;
+		FrameData.SampleCount = Count;
+		return FrameData;
+	}
+
+	float Min;
+	float Max;
+	float Sum;
+	float Last;
+	int Count;
+};
@@ -0,0 +1,82 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/JoystickPOVDirection.h"
+
+enum class EJoystickInputEventType : uint8
+{
+	Axis,
+	Button,
+	Hat,
+	Ball
+};
+
+/* A single input sample captured from SDL, queued per device until the game thread dispatches it */
+struct FJoystickInputEvent
+{
+	FJoystickInputEvent()
+		: Type(EJoystickInputEventType::Axis)
+		  , DeviceId(0)
+		  , Index(0)
+		  , ButtonPressed(false)
+		  , HatDirection(EJoystickPOVDirection::Direction_None)
+		  , Value(0.f)
+		  , BallDelta(FVector2D::ZeroVector)
+		  , SDLTimestamp(0)
+		  , Timestamp(0.0)
+		  , SourceTimestamp(0.0)
+		  , QueueTimestamp(0.0)
+	{
+	}
+
+	EJoystickInputEventType Type;
+
+	int DeviceId;
+	int Index;
+
+	bool ButtonPressed;
+	EJoystickPOVDirection HatDirection;
+	float Value;
+	FVector2D BallDelta;
+
+	/* SDL event timestamp (milliseconds since SDL initialisation) */
+	uint32 SDLTimestamp;
+
+	/* FPlatformTime::Seconds() when the event was captured */
+	double Timestamp;
+
+	/* When the device produced the event, on the same clock as Timestamp. Only filled by backends with a device timestamp (evdev), 0 when unknown. */
+	double SourceTimestamp;
+
+	/* When the event was queued for the game thread, only filled while latency tracking is enabled */
+	double QueueTimestamp;
+};
+
+enum class EJoystickDeviceEventType : uint8
+{
+	Added,
+	Removed
+};
+
+/* Device hot-plug notification deferred to the game thread */
+struct FJoystickDeviceEvent
+{
+	FJoystickDeviceEvent()
+		: Type(EJoystickDeviceEventType::Added)
+		  , Which(-1)
+	{
+	}
+
+	FJoystickDeviceEvent(const EJoystickDeviceEventType InType, const int InWhich)
+		: Type(InType)
+		  , Which(InWhich)
+	{
+	}
+
+	EJoystickDeviceEventType Type;
+
+	/* The backend's instance id of the device for both Added and Removed, device indices shift before the event is handled */
+	int Which;
+};
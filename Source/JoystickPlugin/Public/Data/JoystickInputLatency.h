@@ -0,0 +1,70 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickInputLatency.generated.h"
+
+/* Mirrors EJoystickInputEventType */
+UENUM(BlueprintType)
+enum class EJoystickLatencyInputType : uint8
+{
+	Axis,
+	Button,
+	Hat,
+	Ball
+};
+
+USTRUCT(BlueprintType)
+struct JOYSTICKPLUGIN_API FJoystickLatencyPercentiles
+{
+	GENERATED_BODY()
+
+	FJoystickLatencyPercentiles()
+		: SampleCount(0)
+		  , Mean(0.f)
+		  , P50(0.f)
+		  , P95(0.f)
+		  , P99(0.f)
+		  , Max(0.f)
+	{
+	}
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	int64 SampleCount;
+
+	/* Milliseconds */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	float Mean;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	float P50;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	float P95;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	float P99;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	float Max;
+};
+
+/* Where the time between a device event and its dispatch to the message handler went */
+USTRUCT(BlueprintType)
+struct JOYSTICKPLUGIN_API FJoystickInputLatency
+{
+	GENERATED_BODY()
+
+	/* From the kernel's event timestamp until it was queued for the game thread. Not measured on backends without a
+	 * device timestamp (SDL), SampleCount stays 0 and Total starts at the queue instead. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	FJoystickLatencyPercentiles EventToQueue;
+
+	/* From the queue until the frame it was drained in dispatched the device */
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	FJoystickLatencyPercentiles QueueToDispatch;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadonly, Category = "Joystick|Latency")
+	FJoystickLatencyPercentiles Total;
+};
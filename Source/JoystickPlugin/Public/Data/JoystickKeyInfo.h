@@ -0,0 +1,36 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "Data/JoystickInputEvent.h"
+
+/* Identifies the input behind a registered joystick key */
+struct FJoystickKeyInfo
+{
+	FJoystickKeyInfo()
+		: DeviceId(-1)
+		  , Index(0)
+		  , Type(EJoystickInputEventType::Axis)
+		  , Component(0)
+	{
+	}
+
+	FJoystickKeyInfo(const int InDeviceId, const EJoystickInputEventType InType, const int InIndex, const int InComponent)
+		: DeviceId(static_cast<int16>(InDeviceId))
+		  , Index(static_cast<uint16>(InIndex))
+		  , Type(InType)
+		  , Component(static_cast<uint8>(InComponent))
+	{
+	}
+
+	int16 DeviceId;
+
+	/* Index of the axis, button, hat or ball on the device */
+	uint16 Index;
+
+	EJoystickInputEventType Type;
+
+	/* 0 for X, 1 for Y on hats and balls */
+	uint8 Component;
+};
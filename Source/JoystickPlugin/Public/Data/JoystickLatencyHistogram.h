@@ -0,0 +1,70 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Data/JoystickInputEvent.h"
+
+#include <atomic>
+
+struct FJoystickLatencyPercentiles;
+
+namespace JoystickLatency
+{
+	/* Checked on every input event, everything else is skipped while it is off */
+	extern JOYSTICKPLUGIN_API std::atomic<bool> TrackingEnabled;
+
+	FORCEINLINE bool IsTrackingEnabled()
+	{
+		return TrackingEnabled.load(std::memory_order_relaxed);
+	}
+}
+
+/**
+ * Log-linear (HDR style) histogram of microsecond latencies, about 3% precision from 1us to 19 hours in 4 KB.
+ * Buckets are only allocated once the first value is recorded.
+ */
+struct JOYSTICKPLUGIN_API FJoystickLatencyHistogram
+{
+	FJoystickLatencyHistogram()
+		: TotalCount(0)
+		  , TotalMicroseconds(0)
+		  , MaxMicroseconds(0)
+	{
+	}
+
+	void Record(const double Seconds);
+	void Reset();
+
+	uint64 GetValueAtPercentile(const double Percentile) const;
+	void GetPercentiles(FJoystickLatencyPercentiles& Percentiles) const;
+
+	static int GetBucketIndex(const uint64 Microseconds);
+	static uint64 GetBucketUpperBound(const int BucketIndex);
+
+	TArray<uint32> Counts;
+	uint64 TotalCount;
+	uint64 TotalMicroseconds;
+	uint64 MaxMicroseconds;
+};
+
+struct FJoystickLatencySample
+{
+	EJoystickInputEventType Type;
+	double SourceTimestamp;
+	double QueueTimestamp;
+};
+
+/* Latency of one device, histograms are indexed by EJoystickInputEventType */
+struct FJoystickDeviceLatency
+{
+	static constexpr int InputTypeCount = 4;
+
+	/* Drained this frame, recorded once the device has been dispatched */
+	TArray<FJoystickLatencySample> PendingSamples;
+
+	FJoystickLatencyHistogram EventToQueue[InputTypeCount];
+	FJoystickLatencyHistogram QueueToDispatch[InputTypeCount];
+	FJoystickLatencyHistogram Total[InputTypeCount];
+};
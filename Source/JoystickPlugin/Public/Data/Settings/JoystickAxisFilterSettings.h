@@ -0,0 +1,54 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickAxisFilterSettings.generated.h"
+
+UENUM(BlueprintType)
+enum class EJoystickAxisFilterType : uint8
+{
+	LowPass,
+	OneEuro,
+	Median
+};
+
+USTRUCT()
+struct JOYSTICKPLUGIN_API FJoystickAxisFilterSettings
+{
+	GENERATED_BODY()
+
+	FJoystickAxisFilterSettings()
+		: FilterType(EJoystickAxisFilterType::LowPass)
+		  , CutoffFrequency(10.f)
+		  , MinCutoff(1.f)
+		  , Beta(0.007f)
+		  , DerivativeCutoff(1.f)
+		  , MedianTaps(3)
+	{
+	}
+
+	/** The filter to apply, filters run on every sample in the order they are listed. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter")
+	EJoystickAxisFilterType FilterType;
+
+	/** The frequency in Hz above which changes are smoothed out. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter", meta=(EditCondition="FilterType == EJoystickAxisFilterType::LowPass", EditConditionHides, UIMin="0.5", UIMax="60", ClampMin="0.01"))
+	float CutoffFrequency;
+
+	/** The cutoff in Hz while the axis is still, lower removes more jitter. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter", meta=(EditCondition="FilterType == EJoystickAxisFilterType::OneEuro", EditConditionHides, UIMin="0.1", UIMax="10", ClampMin="0.01"))
+	float MinCutoff;
+
+	/** How quickly the cutoff rises with speed, higher reduces lag on fast movements. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter", meta=(EditCondition="FilterType == EJoystickAxisFilterType::OneEuro", EditConditionHides, UIMin="0", UIMax="1", ClampMin="0"))
+	float Beta;
+
+	/** The cutoff in Hz used to smooth the speed estimate. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter", meta=(EditCondition="FilterType == EJoystickAxisFilterType::OneEuro", EditConditionHides, UIMin="0.1", UIMax="10", ClampMin="0.01"))
+	float DerivativeCutoff;
+
+	/** The number of samples the median is taken over, 3 or 5. An even count has no middle sample and is rounded up. */
+	UPROPERTY(EditAnywhere, Category="Axis Filter", meta=(EditCondition="FilterType == EJoystickAxisFilterType::Median", EditConditionHides, ClampMin="3", ClampMax="5", Delta="2"))
+	int MedianTaps;
+};
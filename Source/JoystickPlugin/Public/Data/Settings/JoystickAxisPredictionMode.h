@@ -0,0 +1,14 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickAxisPredictionMode.generated.h"
+
+UENUM(BlueprintType)
+enum class EJoystickAxisPredictionMode : uint8
+{
+	None,
+	Linear,
+	ConstantAcceleration
+};
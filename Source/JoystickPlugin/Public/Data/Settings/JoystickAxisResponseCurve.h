@@ -0,0 +1,15 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "JoystickAxisResponseCurve.generated.h"
+
+UENUM(BlueprintType)
+enum class EJoystickAxisResponseCurve : uint8
+{
+	Linear,
+	Exponential,
+	SCurve,
+	Custom
+};
@@ -3,6 +3,11 @@
 
 #pragma once
 
+#include "Curves/CurveFloat.h"
+#include "JoystickAxisFilterSettings.h"
+#include "JoystickAxisPredictionMode.h"
+#include "JoystickAxisResponseCurve.h"
+
 #include "JoystickInputDeviceAxisProperties.generated.h"
 
 USTRUCT()
@@ -20,6 +25,17 @@ struct JOYSTICKPLUGIN_API FJoystickInputDeviceAxisProperties
 		  , OutputRangeMin(0.f)
 		  , OutputRangeMax(1.f)
 		  , InvertOutput(false)
+		  , DispatchThreshold(0.f)
+		  , Centered(true)
+		  , InnerDeadzone(0.f)
+		  , OuterDeadzone(0.f)
+		  , ResponseCurve(EJoystickAxisResponseCurve::Linear)
+		  , CurveExponent(2.f)
+		  , PairedAxisIndex(-1)
+		  , RadialDeadzone(false)
+		  , PredictionMode(EJoystickAxisPredictionMode::None)
+		  , PredictionHorizon(0.033f)
+		  , PredictionClamp(0.25f)
 	{
 	}
 
@@ -58,4 +74,60 @@ struct JOYSTICKPLUGIN_API FJoystickInputDeviceAxisProperties
 	/** Whether the value of the axis as supplied from the driver should be inverted. */
 	UPROPERTY(EditAnywhere, Category="Axis Properties", meta=(EditCondition="RemappingEnabled"))
 	bool InvertOutput;
+
+	/** The minimum change in the axis value before it is dispatched again, when only dispatching changed analog values. */
+	UPROPERTY(EditAnywhere, Category="Axis Properties", meta=(UIMin="0", UIMax="0.1", ClampMin="0"))
+	float DispatchThreshold;
+
+	/** Whether the axis rests in the middle of its range like a stick, deadzones and curves are then measured from the centre instead of the minimum like a pedal. */
+	UPROPERTY(EditAnywhere, Category="Axis Response")
+	bool Centered;
+
+	/** The fraction of the range around the rest position that reads as zero. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(UIMin="0", UIMax="0.5", ClampMin="0", ClampMax="1"))
+	float InnerDeadzone;
+
+	/** The fraction at the end of the range that reads as fully deflected (saturation). */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(UIMin="0", UIMax="0.5", ClampMin="0", ClampMax="1"))
+	float OuterDeadzone;
+
+	/** The response applied after the deadzones, baked into a lookup table when the settings change. */
+	UPROPERTY(EditAnywhere, Category="Axis Response")
+	EJoystickAxisResponseCurve ResponseCurve;
+
+	/** The exponent of the exponential and S curves, 1 is linear. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(EditCondition="ResponseCurve == EJoystickAxisResponseCurve::Exponential || ResponseCurve == EJoystickAxisResponseCurve::SCurve", UIMin="0.1", UIMax="5", ClampMin="0.01"))
+	float CurveExponent;
+
+	/** A curve mapping the deflection (0-1) to the output (0-1), used instead of the points when set. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(EditCondition="ResponseCurve == EJoystickAxisResponseCurve::Custom"))
+	TSoftObjectPtr<UCurveFloat> CurveAsset;
+
+	/** Points mapping the deflection (0-1) to the output (0-1), linearly interpolated. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(EditCondition="ResponseCurve == EJoystickAxisResponseCurve::Custom"))
+	TArray<FVector2D> CurvePoints;
+
+	/** The index of the axis that forms a stick with this one, as the Y axis when this is the X axis. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(UIMin="-1", ClampMin="-1"))
+	int PairedAxisIndex;
+
+	/** Apply the deadzones and curve to the length of the paired X/Y vector instead of each axis separately, using this axis' response. */
+	UPROPERTY(EditAnywhere, Category="Axis Response", meta=(EditCondition="PairedAxisIndex >= 0"))
+	bool RadialDeadzone;
+
+	/** Filters applied in order to every raw sample from the device, before remapping. */
+	UPROPERTY(EditAnywhere, Category="Axis Filters", meta=(TitleProperty="FilterType"))
+	TArray<FJoystickAxisFilterSettings> Filters;
+
+	/** Extrapolate the axis ahead of the latest samples to compensate for latency, the predicted value is dispatched instead of the current one. */
+	UPROPERTY(EditAnywhere, Category="Axis Prediction")
+	EJoystickAxisPredictionMode PredictionMode;
+
+	/** How far ahead to predict in seconds. */
+	UPROPERTY(EditAnywhere, Category="Axis Prediction", meta=(EditCondition="PredictionMode != EJoystickAxisPredictionMode::None", UIMin="0", UIMax="0.1", ClampMin="0"))
+	float PredictionHorizon;
+
+	/** The furthest the prediction may move from the current value, 0 for no limit. */
+	UPROPERTY(EditAnywhere, Category="Axis Prediction", meta=(EditCondition="PredictionMode != EJoystickAxisPredictionMode::None", UIMin="0", UIMax="1", ClampMin="0"))
+	float PredictionClamp;
 };
@@ -36,7 +36,7 @@ public:
 	virtual bool IsTickable() const override { return IsInitialised; }
 	virtual bool IsTickableInEditor() const override { return false; }
 	virtual bool IsTickableWhenPaused() const override { return false; }
-	virtual TStatId GetStatId() const override { return TStatId(); }
+	virtual TStatId GetStatId() const override;
 	// End FTickableGameObject Interface.
 
 	UFUNCTION(BlueprintCallable, Category = "Force Feedback|Functions")
@@ -78,6 +78,12 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Force Feedback|Functions")
 	void SetDeviceId(const int NewDeviceId);
 
+	/* Called by the haptic thread when the device rejected the effect after InitialiseEffect had returned */
+	void HandleEffectCreationFailed(const int FailedEffectId);
+
+	/* Called by the haptic thread when an effect with a higher Priority took this effect's slot on the device */
+	void HandleEffectEvicted(const int EvictedEffectId);
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Feedback", meta = (ExposeOnSpawn = true))
 	int DeviceId;
 
@@ -99,6 +105,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Feedback", meta = (ExposeOnSpawn = true))
 	bool InfiniteIterations;
 
+	/* When the device is out of effect slots, initialising this effect takes the slot of an effect with a lower
+	 * priority. Read on initialisation. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Force Feedback", meta = (ExposeOnSpawn = true))
+	int Priority;
+
 	UPROPERTY(BlueprintAssignable, meta = (DisplayName = "OnInitialisedEffect"), Category = "Force Feedback|Delegates")
 	FOnInitialisedEffect OnInitialisedEffectDelegate;
 
@@ -119,4 +130,13 @@ protected:
 
 	virtual void CreateEffect();
 	virtual void UpdateEffectData();
+
+private:
+	bool IsEffectUploaded() const;
+	void RecordUploadedEffect();
+
+	// The effect as the device last received it, UpdateEffect skips uploads that would not change it
+	SDL_HapticEffect UploadedEffect;
+	TArray<Uint16> UploadedCustomData;
+	bool HasUploadedEffect;
 };
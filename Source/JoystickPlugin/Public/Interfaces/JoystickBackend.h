@@ -0,0 +1,98 @@
+// JoystickPlugin is licensed under the MIT License.
+// Copyright Jayden Maalouf. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDeviceInfoSDL;
+struct FJoystickInputEvent;
+class IJoystickBackend;
+union SDL_HapticEffect;
+
+/**
+ * Receives devices and input from a backend, implemented by UJoystickSubsystem.
+ * Device changes are only reported on the game thread; input events may arrive on any thread,
+ * but all events for one device come from one thread at a time.
+ */
+class IJoystickBackendListener
+{
+public:
+	virtual ~IJoystickBackendListener() = default;
+
+	/* DeviceIndex is only valid for the duration of the call, the listener opens the device through the backend */
+	virtual void OnDeviceAttached(IJoystickBackend& Backend, const int DeviceIndex) = 0;
+	virtual void OnDeviceDetached(IJoystickBackend& Backend, const int DeviceId) = 0;
+
+	virtual void OnInputEvent(const IJoystickBackend& Backend, const FJoystickInputEvent& InputEvent) = 0;
+};
+
+/**
+ * A source of joystick devices. The subsystem owns device ids and lifetime, a backend only opens devices,
+ * translates its native events into FJoystickInputEvent and drives haptics.
+ * Haptic effects are described with SDL_HapticEffect, which is plain data shared with the force feedback effects.
+ */
+class IJoystickBackend
+{
+public:
+	virtual ~IJoystickBackend() = default;
+
+	virtual FName GetName() const = 0;
+
+	virtual bool Initialise(IJoystickBackendListener& Listener) = 0;
+	virtual void Shutdown() = 0;
+
+	/* Reports every device already attached and starts listening for changes */
+	virtual void EnumerateDevices() = 0;
+
+	virtual int GetDeviceCount() const = 0;
+	virtual bool IsGamepad(const int DeviceIndex) const = 0;
+
+	/* Fills everything but the device id, which the listener assigns before binding */
+	virtual bool OpenDevice(const int DeviceIndex, FDeviceInfoSDL& Device) = 0;
+	virtual void BindDevice(const FDeviceInfoSDL& Device) = 0;
+	virtual void CloseDevice(const FDeviceInfoSDL& Device) = 0;
+
+	/* Game thread tick, PollInput is false when an input thread calls PollInput instead */
+	virtual void Update(const bool PollInput) = 0;
+	virtual void PollInput()
+	{
+	}
+
+	/* Blocks until input may be pending or Timeout seconds pass. Returns false when the backend cannot wait, the caller sleeps instead. */
+	virtual bool WaitForInput(const double Timeout) { return false; }
+
+	/* Replayed input is not recorded again */
+	virtual bool IsReplay() const { return false; }
+
+	virtual bool SetAutoCenter(const int DeviceId, const int Center) { return false; }
+	virtual bool SetGain(const int DeviceId, const int Gain) { return false; }
+	virtual void PauseHaptics(const int DeviceId)
+	{
+	}
+	virtual void UnpauseHaptics(const int DeviceId)
+	{
+	}
+	virtual void StopAllEffects(const int DeviceId)
+	{
+	}
+	virtual int GetNumEffects(const int DeviceId) const { return -1; }
+	virtual int GetNumEffectsPlaying(const int DeviceId) const { return -1; }
+	virtual int GetEffectStatus(const int DeviceId, const int EffectId) const { return -1; }
+
+	virtual int CreateEffect(const int DeviceId, SDL_HapticEffect& Effect) { return -1; }
+	virtual bool UpdateEffect(const int DeviceId, const int EffectId, SDL_HapticEffect& Effect) { return false; }
+	virtual bool RunEffect(const int DeviceId, const int EffectId, const int Iterations) { return false; }
+	virtual bool StopEffect(const int DeviceId, const int EffectId) { return false; }
+	virtual void DestroyEffect(const int DeviceId, const int EffectId)
+	{
+	}
+
+	/* Duration in seconds, -1 rumbles until stopped */
+	virtual void PlayRumble(const int DeviceId, const float LowFrequency, const float HighFrequency, const float Duration)
+	{
+	}
+	virtual void StopRumble(const int DeviceId)
+	{
+	}
+};
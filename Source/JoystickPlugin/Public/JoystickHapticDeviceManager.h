@@ -3,12 +3,14 @@
 
 #pragma once
 
+#include "Data/JoystickEffectPoolStats.h"
 #include "ForceFeedback/Effects/ForceFeedbackEffectBase.h"
 
 #include "JoystickHapticDeviceManager.generated.h"
 
-struct FDeviceInfoSDL;
-using SDL_Haptic = _SDL_Haptic;
+class FJoystickForceFeedbackLoop;
+class FJoystickHapticThread;
+class IJoystickBackend;
 union SDL_HapticEffect;
 
 UCLASS(BlueprintType)
@@ -50,13 +52,54 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
 	void StopRumble(const int DeviceId);
 
-	int CreateEffect(const int DeviceId, SDL_HapticEffect& Effect) const;
+	/* Effect updates not sent because the effect had not changed since it was last uploaded */
+	UFUNCTION(BlueprintPure, Category = "Joystick|Force Feedback|Functions")
+	int64 GetSkippedEffectUpdateCount() const;
+
+	/* Effect updates replaced by a newer one before the device's update rate let them through */
+	UFUNCTION(BlueprintPure, Category = "Joystick|Force Feedback|Functions")
+	int64 GetCoalescedEffectUpdateCount() const;
+
+	void RecordSkippedEffectUpdate() const;
+
+	/* How the device's effect slots have been created, reused and evicted. Needs the haptic thread, returns false
+	 * until the device has had an effect. */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	bool GetEffectPoolStats(const int DeviceId, FJoystickEffectPoolStats& Stats) const;
+
+	/* Streams a force into a constant force effect at ForceFeedbackLoopRate, driven by SetForceTarget or a callback.
+	 * With the haptic thread the effect is created there, a failed creation is logged and ends the stream. */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	bool StartForceStream(const int DeviceId) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	void StopForceStream(const int DeviceId) const;
+
+	/* Thread safe, Force is -1 to 1 along the device's X axis */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	void SetForceTarget(const int DeviceId, const float Force) const;
+
+	/* The largest change in force per second, 0 for no limit */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	void SetForceSlewRate(const int DeviceId, const float SlewRate) const;
+
+	/* Interpolate between targets, smoothing out the frame rate for one frame of latency. On by default. */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Force Feedback|Functions")
+	void SetForceInterpolation(const int DeviceId, const bool Interpolate) const;
+
+	/* Drives the stream from a callback on the loop thread instead of targets, pass nullptr to go back to targets */
+	void SetForceCallback(const int DeviceId, TFunction<float(double Time)>&& Callback) const;
+
+	/* With the haptic thread these calls are queued and return straight away; the id returned by CreateEffect is a
+	 * handle, and a failed creation or an eviction by an effect with a higher Priority is reported to Owner later */
+	int CreateEffect(const int DeviceId, SDL_HapticEffect& Effect, UForceFeedbackEffectBase* Owner = nullptr, const int Priority = 0) const;
 	bool UpdateEffect(int DeviceId, const int EffectId, SDL_HapticEffect& Effect) const;
 	bool RunEffect(const int DeviceId, const int EffectId, const int Iterations) const;
 	bool StopEffect(const int DeviceId, const int EffectId) const;
 	void DestroyEffect(const int DeviceId, const int EffectId) const;
 
 private:
-	SDL_Haptic* GetHapticDevice(const int DeviceId) const;
-	FDeviceInfoSDL* GetDeviceInfo(const int DeviceId) const;
+	IJoystickBackend* GetDeviceBackend(const int DeviceId) const;
+	FJoystickHapticThread* GetHapticThread() const;
+	FJoystickForceFeedbackLoop* GetForceFeedbackLoop(const bool CreateIfNeeded = false) const;
 };
@@ -6,12 +6,25 @@
 #include "IInputDevice.h"
 #include "InputCoreTypes.h"
 #include "Containers/Array.h"
+#include "Containers/CircularQueue.h"
 #include "Data/JoystickDeviceData.h"
+#include "Data/JoystickDeviceStore.h"
 #include "Data/JoystickInfo.h"
+#include "Data/JoystickInputEvent.h"
+#include "Data/JoystickInputLatency.h"
+#include "Data/JoystickLatencyHistogram.h"
+#include "Data/JoystickKeyInfo.h"
+#include "HAL/CriticalSection.h"
 #include "GenericPlatform/IInputInterface.h"
 #include "GenericPlatform/GenericApplicationMessageHandler.h"
 
+#include <atomic>
+
 struct FDeviceInfoSDL;
+struct FJoystickCachedKey;
+class FJoystickDeviceCache;
+
+using FJoystickInputEventQueue = TCircularQueue<FJoystickInputEvent>;
 
 class FJoystickInputDevice final : public IInputDevice
 {
@@ -29,38 +42,115 @@ public:
 	void JoystickPluggedIn(const FDeviceInfoSDL& Device);
 	void JoystickUnplugged(int DeviceId);
 	void JoystickButton(int DeviceId, int Button, bool Pressed);
-	void JoystickAxis(int DeviceId, int Axis, float Value);
+	void JoystickAxis(int DeviceId, int Axis, float Value, double Timestamp);
 	void JoystickHat(int DeviceId, int Hat, EJoystickPOVDirection Value);
 	void JoystickBall(int DeviceId, int Ball, FVector2D Value);
 
-	FJoystickDeviceData* GetDeviceData(int DeviceId);
+	// Thread safe, called from whichever thread pumps SDL
+	void QueueInputEvent(const FJoystickInputEvent& Event);
+
+	bool GetDeviceData(int DeviceId, FJoystickDeviceData& DeviceData) const;
+	bool GetButtonMask(int DeviceId, TArray<uint64>& ButtonMask) const;
+	bool GetAxisFrameData(int DeviceId, int Axis, FAxisFrameData& AxisFrameData) const;
 	FJoystickInfo* GetDeviceInfo(int DeviceId);
 	FJoystickInfo* GetKeyDeviceInfo(const FKey& Key);
 	int GetDeviceCount() const;
 	void GetDeviceIds(TArray<int>& DeviceIds) const;
+	const FJoystickKeyInfo* GetKeyInfo(const FKey& Key) const;
 	int GetDeviceIndexByKey(const FKey& Key) const;
 	int GetDeviceIdByKey(const FKey& Key) const;
+	uint64 GetSuppressedAnalogDispatchCount() const;
+
+	bool GetInputLatency(int DeviceId, EJoystickInputEventType Type, FJoystickInputLatency& Latency) const;
+	void ResetInputLatency();
 
 	void SetPlayerOwnership(int DeviceId, int PlayerId);
 
 	void ResetAxisProperties();
 	void UpdateAxisProperties();
 
+	/* Queues the keys of every cached device, they are registered with the next batch */
+	void RegisterCachedKeys(const FJoystickDeviceCache& DeviceCache);
+
 private:
 	void InitialiseInputDevice(const FDeviceInfoSDL& Device);
-	void InitialiseAxis(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName);
-	void InitialiseButtons(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName);
-	void InitialiseHats(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName);
-	void InitialiseBalls(const int DeviceId, const FJoystickDeviceData& JoystickState, const FString& BaseKeyName, const FString& BaseDisplayName);
+	void InitialiseAxis(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName);
+	void InitialiseButtons(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName);
+	void InitialiseHats(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName);
+	void InitialiseBalls(const int DeviceId, const FString& BaseKeyName, const FString& BaseDisplayName);
+	void InitialiseEventQueue(const int DeviceId);
 
-	TMap<int, FJoystickDeviceData> JoystickDeviceData;
+	// Key names are built in KeyNameBuffer and DisplayNameBuffer before being queued
+	void QueueKey(const FJoystickKeyInfo& KeyInfo, const uint32 KeyFlags);
+	void QueueCachedKey(const FJoystickCachedKey& CachedKey, const int DeviceId);
+	void AssignKey(const FJoystickKeyInfo& KeyInfo, const FName& KeyName);
+	void RegisterPendingKeys();
+
+	void BeginFrame();
+	void DrainInputEvents();
+	void ApplyInputEvent(const FJoystickInputEvent& Event);
+	void RecordDispatchLatency(const int DeviceId);
+#if STATS
+	void PublishEventRates();
+#endif
+
+	bool ShouldDispatchAnalog(FJoystickAnalogDispatchState& State, const float Value, const float Epsilon);
+
+	FJoystickDeviceStore DeviceStore;
 	TMap<int, FJoystickInfo> JoystickDeviceInfo;
 
-	TMap<int, TArray<FKey>> DeviceButtonKeys;
-	TMap<int, TArray<FKey>> DeviceAxisKeys;
-	TMap<int, TArray<FKey>> DeviceHatKeys[2];
-	TMap<int, TArray<FKey>> DeviceBallKeys[2];
-	TMap<int, TArray<FKey>> DeviceKeys;
+	bool OnlyDispatchChangedAnalogValues;
+	uint64 SuppressedAnalogDispatches;
+
+	// Reverse lookup from a registered key to the input it belongs to
+	TMap<FName, FJoystickKeyInfo> KeyInfos;
+
+	struct FJoystickPendingKey
+	{
+		FJoystickPendingKey(const FKeyDetails& InDetails, const FJoystickKeyInfo& InKeyInfo, const uint32 InKeyFlags)
+			: Details(InDetails)
+			  , KeyInfo(InKeyInfo)
+			  , KeyFlags(InKeyFlags)
+		{
+		}
+
+		FKeyDetails Details;
+		FJoystickKeyInfo KeyInfo;
+		uint32 KeyFlags;
+	};
+
+	// Keys of newly connected devices, registered as one batch before the next dispatch. Until then the
+	// device's key slots stay None and its inputs are not dispatched.
+	TArray<FJoystickPendingKey> PendingKeys;
+	int PendingKeyIndex = 0;
+
+	// Set when the batch added a key the engine did not know, only then are the input settings rebuilt
+	bool PendingKeysAdded = false;
+
+	FString KeyNameBuffer;
+	FString DisplayNameBuffer;
+
+	// Owns every queue, written on the game thread only. Queues are never removed, so a published pointer stays valid.
+	TMap<int, TSharedPtr<FJoystickInputEventQueue>> DeviceEventQueues;
+
+	// Each queue is published here by device id once it exists, so producers enqueue without a lock. A device's
+	// events all come from its backend's thread, which keeps every queue single producer.
+	static constexpr int MaxPublishedEventQueues = 64;
+	std::atomic<FJoystickInputEventQueue*> PublishedEventQueues[MaxPublishedEventQueues];
+
+	// Guards the map for producers of device ids beyond the published range
+	FCriticalSection DeviceEventQueuesLock;
+	std::atomic<uint64> DroppedInputEvents;
+
+	// Only touched while latency tracking is enabled
+	TMap<int, FJoystickDeviceLatency> DeviceLatencies;
+
+#if STATS
+	// Events drained per device since EventRateWindowStart, published once a second as per device stats
+	TMap<int, int> DeviceEventCounts;
+	TMap<int, FName> DeviceEventRateStats;
+	double EventRateWindowStart = 0.0;
+#endif
 
 	const TArray<FString> AxisNames = {TEXT("X"), TEXT("Y")};
 
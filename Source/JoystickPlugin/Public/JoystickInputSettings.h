@@ -11,6 +11,8 @@
 
 #include "JoystickInputSettings.generated.h"
 
+struct FJoystickKeyInfo;
+
 UCLASS(config=Input, DefaultConfig)
 class JOYSTICKPLUGIN_API UJoystickInputSettings final : public UObject
 {
@@ -18,6 +20,7 @@ class JOYSTICKPLUGIN_API UJoystickInputSettings final : public UObject
 
 public:
 	UJoystickInputSettings();
+	virtual void PostInitProperties() override;
 #if WITH_EDITOR
 	virtual void PostEditChangeChainProperty(FPropertyChangedChainEvent& PropertyChangedEvent) override;
 #endif
@@ -43,6 +46,62 @@ public:
 	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings", meta=(ToolTip="Enable/disable debug logging from the plugin."))
 	bool EnableLogs;
 
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Only send analog values to the input system when they change by more than the axis dispatch threshold. A final value is always sent when an axis comes to rest."))
+	bool OnlyDispatchChangedAnalogValues;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Poll devices on a dedicated input thread instead of once per frame, so samples between frames are not lost.", ConfigRestartRequired=true))
+	bool UseInputThread;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="How many times per second the input thread polls the devices.", EditCondition="UseInputThread", UIMin="60", UIMax="2000", ClampMin="1", ConfigRestartRequired=true))
+	int InputThreadPollRate;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Open and probe devices on a worker thread. Devices show up a few frames later, but a slow device no longer stalls the frame it is plugged in on.", ConfigRestartRequired=true))
+	bool OpenDevicesAsynchronously;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Linux only. Read devices straight from /dev/input/event* instead of through SDL, for the shortest input path. Haptics and virtual devices are not available in this mode.", ConfigRestartRequired=true))
+	bool UseEvdevBackend;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="The number of input events buffered per device between frames. Events beyond this are dropped.", UIMin="64", ClampMin="16", ConfigRestartRequired=true))
+	int InputEventQueueSize;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Milliseconds per frame spent registering keys for newly connected devices. 0 registers each batch in one frame.", UIMin="0", ClampMin="0", Units="ms"))
+	float KeyRegistrationBudget;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Remember devices between runs in Saved/Joystick/DeviceCache.bin. Known devices keep their device id and have their keys registered at startup, before they finish opening.", ConfigRestartRequired=true))
+	bool UseDeviceCache;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Send force feedback commands to the devices from a dedicated thread. Effect calls return immediately and their status is refreshed in the background.", ConfigRestartRequired=true))
+	bool UseHapticThread;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="The most effect updates sent to a device per second. Updates in between are merged, the latest one is sent. 0 sends every update.", EditCondition="UseHapticThread", UIMin="0", UIMax="1000", ClampMin="0", ConfigRestartRequired=true))
+	int MaxEffectUpdateRate;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="Mix constant, periodic and ramp effects in software and send the sum to the device as a single constant force, so they no longer use up the device's effect slots. Condition and custom effects still play on the device.", EditCondition="UseHapticThread", ConfigRestartRequired=true))
+	bool UseForceFeedbackMixer;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="How many times per second mixed effects are summed. The sum is sent to the device at most MaxEffectUpdateRate times per second.", EditCondition="UseHapticThread && UseForceFeedbackMixer", UIMin="60", UIMax="1000", ClampMin="1", ConfigRestartRequired=true))
+	int ForceFeedbackMixerRate;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="How many stopped effect slots each device keeps after their effects are destroyed. A new effect of the same type is uploaded into one of them instead of being created on the device. 0 destroys effects straight away.", EditCondition="UseHapticThread", UIMin="0", UIMax="16", ClampMin="0", ConfigRestartRequired=true))
+	int MaxFreeEffectSlots;
+
+	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings",
+		meta=(ToolTip="How many times per second force streams started with StartForceStream are updated.", UIMin="60", UIMax="1000", ClampMin="1", ConfigRestartRequired=true))
+	int ForceFeedbackLoopRate;
+
 	UPROPERTY(config, EditAnywhere, Category="Joystick Input Settings")
 	TArray<FJoystickInputDeviceConfiguration> DeviceConfigurations;
 
@@ -50,5 +109,5 @@ public:
 	bool SetIgnoreGameControllers(const bool NewIgnoreGameControllers);
 
 private:
-	int GetDeviceIndexByKey(const FKey& Key) const;
+	const FJoystickKeyInfo* GetKeyInfo(const FKey& Key) const;
 };
@@ -4,21 +4,34 @@
 #pragma once
 
 #include "Data/DeviceInfoSDL.h"
+#include "Data/JoystickInputEvent.h"
+#include "Data/JoystickInputLatency.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Interfaces/JoystickBackend.h"
 #include "Subsystems/EngineSubsystem.h"
 
 #include "JoystickSubsystem.generated.h"
 
 struct FJoystickInfo;
 struct FJoystickDeviceData;
+struct FAxisFrameData;
 class FJoystickInputDevice;
-union SDL_Event;
+class FJoystickInputThread;
+class FJoystickHapticThread;
+class FJoystickForceFeedbackLoop;
+class FJoystickInputRecorder;
+class FJoystickBackendReplay;
+class FJoystickBackendSDL;
+class FJoystickVirtualDevices;
+class FJoystickDeviceCache;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnJoystickSubsystemReady);
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnJoystickEvent, int, DeviceId);
 
 UCLASS(BlueprintType)
-class JOYSTICKPLUGIN_API UJoystickSubsystem : public UEngineSubsystem
+class JOYSTICKPLUGIN_API UJoystickSubsystem : public UEngineSubsystem, public IJoystickBackendListener
 {
 	GENERATED_BODY()
 
@@ -42,6 +55,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Joystick|Functions")
 	bool GetJoystickData(const int DeviceId, FJoystickDeviceData& JoystickDeviceData) const;
 
+	/* Pressed buttons as bits, button N is bit N % 64 of element N / 64 */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Functions")
+	bool GetButtonMask(const int DeviceId, TArray<int64>& ButtonMask) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Functions")
+	bool GetAxisFrameData(const int DeviceId, const int Axis, FAxisFrameData& AxisFrameData) const;
+
 	UFUNCTION(BlueprintCallable, Category = "Joystick|Functions")
 	bool GetJoystickInfo(const int DeviceId, FJoystickInfo& JoystickInfo) const;
 
@@ -54,6 +74,51 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Joystick|Functions")
 	void GetDeviceIds(TArray<int>& DeviceIds) const;
 
+	/* Number of analog dispatches skipped because the value did not change enough */
+	UFUNCTION(BlueprintPure, Category = "Joystick|Functions")
+	int64 GetSuppressedAnalogDispatchCount() const;
+
+	/* Timestamps input events and keeps per device latency histograms, costs a flag check per event while disabled */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Latency")
+	void SetLatencyTrackingEnabled(const bool Enabled);
+
+	UFUNCTION(BlueprintPure, Category = "Joystick|Latency")
+	bool IsLatencyTrackingEnabled() const;
+
+	/* Latency of one input type of a device, in milliseconds, since tracking was enabled or last reset */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Latency")
+	bool GetInputLatency(const int DeviceId, const EJoystickLatencyInputType InputType, FJoystickInputLatency& Latency) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Latency")
+	void ResetInputLatency();
+
+	/* Records raw input from every device to Path, or to Saved/Joystick when Path is empty */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Recording")
+	bool StartRecording(const FString& Path);
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Recording")
+	void StopRecording();
+
+	UFUNCTION(BlueprintPure, Category = "Joystick|Recording")
+	bool IsRecording() const;
+
+	/* Replays a recording through replayed devices, at the recorded timing or as fast as possible */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Recording")
+	bool StartReplay(const FString& Path, const bool AsFastAsPossible);
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Recording")
+	void StopReplay();
+
+	UFUNCTION(BlueprintPure, Category = "Joystick|Recording")
+	bool IsReplaying() const;
+
+	/* Attaches SDL virtual joysticks driven from a script, or from a generator when ScriptPath is empty. Returns false if any of them failed to attach */
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Virtual Devices")
+	bool CreateVirtualDevices(const int Count, const int AxisCount, const int ButtonCount, const int HatCount, const FString& ScriptPath);
+
+	UFUNCTION(BlueprintCallable, Category = "Joystick|Virtual Devices")
+	void DestroyVirtualDevices();
+
 	UPROPERTY(BlueprintAssignable, Category = "Joystick|Delegates")
 	FOnJoystickEvent JoystickPluggedInDelegate;
 
@@ -61,34 +126,66 @@ public:
 	FOnJoystickEvent JoystickUnpluggedDelegate;
 
 	void InitialiseInputDevice(const TSharedPtr<FJoystickInputDevice> NewInputDevice);
-	void Update() const;
-
-	FString GetDeviceIndexGuidString(int DeviceIndex) const;
-	void GetDeviceIndexGuid(const int DeviceIndex, FGuid& Guid) const;
+	void Update();
 
 	FDeviceInfoSDL* GetDeviceInfo(const int DeviceId);
 	FJoystickDeviceData CreateInitialDeviceState(const int DeviceId);
 
+	/* The backend a connected device is open on, used for haptics */
+	IJoystickBackend* GetDeviceBackend(const int DeviceId) const;
+
 	FJoystickInputDevice* GetInputDevice() const;
 
+	/* Devices seen on previous runs, null when UseDeviceCache is off */
+	FJoystickDeviceCache* GetDeviceCache() const;
+
+	/* Runs haptic calls off the game thread, null when UseHapticThread is off */
+	FJoystickHapticThread* GetHapticThread() const;
+
+	/* Streams game driven forces, started the first time it is asked for */
+	FJoystickForceFeedbackLoop* GetForceFeedbackLoop(const bool CreateIfNeeded = false);
+
+	/* Adds a source of devices next to SDL, e.g. FJoystickBackendMock. Game thread only. */
+	void RegisterBackend(const TSharedRef<IJoystickBackend>& Backend);
+	void UnregisterBackend(const TSharedRef<IJoystickBackend>& Backend);
+
+	// Begin IJoystickBackendListener
+	virtual void OnDeviceAttached(IJoystickBackend& Backend, const int DeviceIndex) override;
+	virtual void OnDeviceDetached(IJoystickBackend& Backend, const int DeviceId) override;
+	virtual void OnInputEvent(const IJoystickBackend& Backend, const FJoystickInputEvent& InputEvent) override;
+	// End IJoystickBackendListener
+
 	UPROPERTY(BlueprintAssignable, Category = "Joystick Subsystem|Delegates")
 	FOnJoystickSubsystemReady JoystickSubsystemReady;
 
 private:
-	static int HandleSDLEvent(void* UserData, SDL_Event* Event);
-
-	bool AddDevice(const int DeviceIndex);
-	void AddHapticDevice(FDeviceInfoSDL& Device) const;
+	bool AddDevice(IJoystickBackend& Backend, const int DeviceIndex);
 	bool RemoveDevice(const int DeviceId);
 
 	void JoystickPluggedIn(const FDeviceInfoSDL& Device) const;
 	void JoystickUnplugged(const int DeviceId) const;
 
 	TMap<int, FDeviceInfoSDL> Devices;
-	TMap<int, int> DeviceMapping;
+
+	TArray<TSharedRef<IJoystickBackend>> Backends;
+	TSharedPtr<FJoystickBackendSDL> SDLBackend;
+
+	// The backend physical devices come from, polled by the input thread when it is enabled
+	TSharedPtr<IJoystickBackend> InputBackend;
 
 	TSharedPtr<FJoystickInputDevice> InputDevicePtr;
+	TSharedPtr<FJoystickInputThread> InputThread;
+	TSharedPtr<FJoystickHapticThread> HapticThread;
+	TSharedPtr<FJoystickForceFeedbackLoop> ForceFeedbackLoop;
+
+	// The recorder is swapped on the game thread and written to from the input thread
+	TSharedPtr<FJoystickInputRecorder> Recorder;
+	mutable FCriticalSection RecorderLock;
+	FThreadSafeBool RecordingInput;
+
+	TSharedPtr<FJoystickBackendReplay> ReplayBackend;
+	TSharedPtr<FJoystickVirtualDevices> VirtualDevices;
+	TSharedPtr<FJoystickDeviceCache> DeviceCache;
 
-	bool OwnsSDL;
 	bool IsInitialised;
 };